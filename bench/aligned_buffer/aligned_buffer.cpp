@@ -1,5 +1,6 @@
 #include <benchmark/benchmark.h>
 #include "fst/aligned_buffer.h"
+#include "fst/soa_vector.h"
 #include "fst/print.h"
 #include <array>
 #include <vector>
@@ -72,3 +73,36 @@ static void fst_bench_heap_aligned_buffer_loop(benchmark::State& state) {
   }
 }
 BENCHMARK(fst_bench_heap_aligned_buffer_loop);
+
+static void fst_bench_struct_vector_field_loop(benchmark::State& state) {
+  struct particle {
+    float x, y, z;
+    float vx, vy, vz;
+  };
+
+  std::vector<particle> particles(4096, particle{ 0, 0, 0, 1, 2, 3 });
+  for (auto _ : state) {
+    for (particle& p : particles) {
+      p.x += p.vx;
+    }
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(fst_bench_struct_vector_field_loop);
+
+static void fst_bench_soa_vector_field_loop(benchmark::State& state) {
+  fst::soa_vector<float, float, float, float, float, float> particles;
+  for (std::size_t i = 0; i < 4096; i++) {
+    particles.push_back(0, 0, 0, 1, 2, 3);
+  }
+
+  for (auto _ : state) {
+    float* x = particles.data<0>();
+    const float* vx = particles.data<3>();
+    for (std::size_t i = 0; i < particles.size(); i++) {
+      x[i] += vx[i];
+    }
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(fst_bench_soa_vector_field_loop);
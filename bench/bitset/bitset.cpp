@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+#include "fst/bitset.h"
+#include <random>
+#include <vector>
+
+namespace {
+constexpr std::size_t bench_bitset_size = 1 << 20;
+
+std::vector<std::size_t> make_ids() {
+  std::mt19937 gen(1);
+  std::vector<std::size_t> ids;
+  for (int i = 0; i < 20000; i++) {
+    ids.push_back(gen() % bench_bitset_size);
+  }
+  return ids;
+}
+} // namespace
+
+static void fst_bench_vector_bool_iterate(benchmark::State& state) {
+  std::vector<bool> bits(bench_bitset_size);
+  for (std::size_t i : make_ids()) {
+    bits[i] = true;
+  }
+
+  for (auto _ : state) {
+    std::size_t sum = 0;
+    for (std::size_t i = 0; i < bits.size(); i++) {
+      if (bits[i]) {
+        sum += i;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(fst_bench_vector_bool_iterate);
+
+static void fst_bench_bitset_iterate(benchmark::State& state) {
+  fst::bitset bits(bench_bitset_size);
+  for (std::size_t i : make_ids()) {
+    bits.set(i);
+  }
+
+  for (auto _ : state) {
+    std::size_t sum = 0;
+    bits.for_each([&](std::size_t i) { sum += i; });
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(fst_bench_bitset_iterate);
+
+static void fst_bench_bitset_and_count(benchmark::State& state) {
+  fst::bitset a(bench_bitset_size);
+  fst::bitset b(bench_bitset_size);
+  std::vector<std::size_t> ids = make_ids();
+  for (std::size_t i = 0; i < ids.size(); i++) {
+    (i & 1 ? a : b).set(ids[i]);
+  }
+
+  for (auto _ : state) {
+    fst::bitset c = a;
+    c &= b;
+    benchmark::DoNotOptimize(c.count());
+  }
+}
+BENCHMARK(fst_bench_bitset_and_count);
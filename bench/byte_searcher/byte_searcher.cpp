@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+#include "fst/byte_searcher.h"
+#include <algorithm>
+#include <string>
+
+namespace {
+std::string make_riff_like_data() {
+  std::string data(4 * 1024 * 1024, 'a');
+  for (std::size_t i = 0; i < data.size(); i++) {
+    data[i] = (char)('a' + (i * 7) % 23);
+  }
+  data.replace(data.size() - 64, 4, "data");
+  return data;
+}
+} // namespace
+
+static void fst_bench_std_search(benchmark::State& state) {
+  std::string data = make_riff_like_data();
+  const char needle[] = "data";
+
+  for (auto _ : state) {
+    auto it = std::search(data.begin(), data.end(), needle, needle + 4);
+    benchmark::DoNotOptimize(it);
+  }
+}
+BENCHMARK(fst_bench_std_search);
+
+static void fst_bench_byte_searcher_short(benchmark::State& state) {
+  std::string data = make_riff_like_data();
+  fst::byte_searcher searcher("data");
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(searcher.find(data.data(), data.size()));
+  }
+}
+BENCHMARK(fst_bench_byte_searcher_short);
+
+static void fst_bench_byte_searcher_long(benchmark::State& state) {
+  std::string data = make_riff_like_data();
+  std::string needle = data.substr(data.size() - 64, 48);
+  fst::byte_searcher searcher(needle);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(searcher.find(data.data(), data.size()));
+  }
+}
+BENCHMARK(fst_bench_byte_searcher_long);
@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+#include "fst/flat_map.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+std::vector<std::string> make_symbols() {
+  std::vector<std::string> symbols;
+  for (int i = 0; i < 10000; i++) {
+    symbols.push_back("symbol_" + std::to_string(i * 7919));
+  }
+  return symbols;
+}
+} // namespace
+
+static void fst_bench_std_unordered_map_find(benchmark::State& state) {
+  std::vector<std::string> symbols = make_symbols();
+  std::unordered_map<std::string, int> map;
+  for (std::size_t i = 0; i < symbols.size(); i++) {
+    map[symbols[i]] = (int)i;
+  }
+
+  for (auto _ : state) {
+    int sum = 0;
+    for (const std::string& s : symbols) {
+      sum += map.find(s)->second;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(fst_bench_std_unordered_map_find);
+
+static void fst_bench_flat_map_find(benchmark::State& state) {
+  std::vector<std::string> symbols = make_symbols();
+  fst::flat_map<fst::small_string<23>, int> map;
+  for (std::size_t i = 0; i < symbols.size(); i++) {
+    map[fst::small_string<23>(symbols[i])] = (int)i;
+  }
+
+  for (auto _ : state) {
+    int sum = 0;
+    for (const std::string& s : symbols) {
+      sum += map.find(std::string_view(s))->second;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(fst_bench_flat_map_find);
@@ -0,0 +1,35 @@
+#include <benchmark/benchmark.h>
+#include "fst/spin_lock.h"
+#include <mutex>
+
+namespace {
+// Short critical section, the kind of work event_manager does under its lock.
+template <typename _Mutex>
+struct bench_lock_data {
+  _Mutex mutex;
+  std::size_t counter = 0;
+};
+
+template <typename _Mutex>
+void bench_lock(benchmark::State& state) {
+  static bench_lock_data<_Mutex> data;
+
+  for (auto _ : state) {
+    std::lock_guard<_Mutex> lock(data.mutex);
+    data.counter++;
+    benchmark::DoNotOptimize(data.counter);
+  }
+}
+} // namespace
+
+static void fst_bench_std_mutex_lock(benchmark::State& state) { bench_lock<std::mutex>(state); }
+BENCHMARK(fst_bench_std_mutex_lock)->ThreadRange(1, 8)->UseRealTime();
+
+static void fst_bench_spin_lock_lock(benchmark::State& state) { bench_lock<fst::spin_lock_mutex>(state); }
+BENCHMARK(fst_bench_spin_lock_lock)->ThreadRange(1, 8)->UseRealTime();
+
+static void fst_bench_ticket_spin_lock_lock(benchmark::State& state) { bench_lock<fst::ticket_spin_lock>(state); }
+BENCHMARK(fst_bench_ticket_spin_lock_lock)->ThreadRange(1, 8)->UseRealTime();
+
+static void fst_bench_rw_spin_lock_lock(benchmark::State& state) { bench_lock<fst::rw_spin_lock>(state); }
+BENCHMARK(fst_bench_rw_spin_lock_lock)->ThreadRange(1, 8)->UseRealTime();
@@ -43,6 +43,8 @@
 #include <iterator>
 #include <algorithm>
 #include <new>
+#include <limits>
+#include <type_traits>
 
 namespace fst {
 namespace detail {
@@ -172,4 +174,186 @@ using stack_aligned_buffer = aligned_buffer<_Tp, _Size, _Alignement, false>;
 
 template <typename _Tp, std::size_t _Size, std::size_t _Alignement>
 using heap_aligned_buffer = aligned_buffer<_Tp, _Size, _Alignement, true>;
+
+/// Allocation helpers shared by aligned_allocator and dynamic_aligned_buffer.
+namespace aligned_memory {
+  static constexpr std::size_t cache_line_size = 64;
+  static constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+  /// Allocations of at least one huge page are rounded up to a multiple of it
+  /// and aligned on it, so the kernel can back them with transparent huge pages.
+  inline constexpr std::size_t allocation_alignment(std::size_t size, std::size_t alignment) noexcept {
+    return size >= huge_page_size ? std::max(alignment, huge_page_size) : alignment;
+  }
+
+  inline constexpr std::size_t allocation_size(std::size_t size, std::size_t alignment) noexcept {
+    const std::size_t align = allocation_alignment(size, alignment);
+    return (size + align - 1) & ~(align - 1);
+  }
+
+  inline void* allocate(std::size_t size, std::size_t alignment) {
+    return ::operator new(
+        allocation_size(size, alignment), std::align_val_t(allocation_alignment(size, alignment)));
+  }
+
+  inline void deallocate(void* ptr, std::size_t size, std::size_t alignment) noexcept {
+    ::operator delete(ptr, std::align_val_t(allocation_alignment(size, alignment)));
+  }
+} // namespace aligned_memory.
+
+/// Standard allocator returning storage aligned on _Alignment bytes.
+///
+/// @code
+///   std::vector<float, fst::aligned_allocator<float>> samples(frame_count);
+/// @endcode
+template <typename _Tp, std::size_t _Alignment = aligned_memory::cache_line_size>
+class aligned_allocator {
+public:
+  using value_type = _Tp;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using propagate_on_container_move_assignment = std::true_type;
+  using is_always_equal = std::true_type;
+
+  static constexpr std::size_t alignment = _Alignment;
+  static_assert(math::is_power_of_two(alignment), "aligned_allocator alignment is not a power of 2.");
+  static_assert(alignment >= alignof(value_type), "aligned_allocator alignment is less than value_type alignment");
+
+  template <typename _Up>
+  struct rebind {
+    using other = aligned_allocator<_Up, _Alignment>;
+  };
+
+  aligned_allocator() noexcept = default;
+
+  template <typename _Up>
+  inline aligned_allocator(const aligned_allocator<_Up, _Alignment>&) noexcept {}
+
+  [[nodiscard]] inline value_type* allocate(size_type count) {
+    if (count > std::numeric_limits<size_type>::max() / sizeof(value_type)) {
+      throw std::bad_array_new_length();
+    }
+
+    return static_cast<value_type*>(aligned_memory::allocate(count * sizeof(value_type), alignment));
+  }
+
+  inline void deallocate(value_type* ptr, size_type count) noexcept {
+    aligned_memory::deallocate(ptr, count * sizeof(value_type), alignment);
+  }
+
+  template <typename _Up>
+  inline bool operator==(const aligned_allocator<_Up, _Alignment>&) const noexcept {
+    return true;
+  }
+
+  template <typename _Up>
+  inline bool operator!=(const aligned_allocator<_Up, _Alignment>&) const noexcept {
+    return false;
+  }
+};
+
+/// Heap buffer aligned on _Alignment bytes with a size given at runtime.
+///
+/// Elements are value initialized. Unlike std::vector it never reallocates
+/// behind the caller's back, reset() is the only way to change its size.
+template <typename _Tp, std::size_t _Alignment = aligned_memory::cache_line_size>
+class dynamic_aligned_buffer {
+public:
+  using value_type = _Tp;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+  using size_type = std::size_t;
+
+  static constexpr std::size_t alignment = _Alignment;
+  static_assert(math::is_power_of_two(alignment), "dynamic_aligned_buffer alignment is not a power of 2.");
+  static_assert(alignment >= alignof(value_type), "dynamic_aligned_buffer alignment is less than value_type alignment");
+
+  dynamic_aligned_buffer() noexcept = default;
+
+  inline explicit dynamic_aligned_buffer(size_type size) { reset(size); }
+
+  inline dynamic_aligned_buffer(const dynamic_aligned_buffer& b) {
+    _data = allocator_type().allocate(b._size);
+    std::uninitialized_copy(b.begin(), b.end(), _data);
+    _size = b._size;
+  }
+
+  inline dynamic_aligned_buffer(dynamic_aligned_buffer&& b) noexcept
+      : _data(b._data)
+      , _size(b._size) {
+    b._data = nullptr;
+    b._size = 0;
+  }
+
+  inline ~dynamic_aligned_buffer() { release(); }
+
+  inline dynamic_aligned_buffer& operator=(const dynamic_aligned_buffer& b) {
+    if (this != &b) {
+      dynamic_aligned_buffer tmp(b);
+      std::swap(_data, tmp._data);
+      std::swap(_size, tmp._size);
+    }
+    return *this;
+  }
+
+  inline dynamic_aligned_buffer& operator=(dynamic_aligned_buffer&& b) noexcept {
+    if (this != &b) {
+      release();
+      _data = b._data;
+      _size = b._size;
+      b._data = nullptr;
+      b._size = 0;
+    }
+    return *this;
+  }
+
+  /// Replaces the content by size value initialized elements.
+  inline void reset(size_type size) {
+    release();
+    if (size) {
+      _data = allocator_type().allocate(size);
+      std::uninitialized_value_construct(_data, _data + size);
+      _size = size;
+    }
+  }
+
+  [[nodiscard]] inline size_type size() const noexcept { return _size; }
+  [[nodiscard]] inline bool empty() const noexcept { return _size == 0; }
+
+  inline reference operator[](size_type __index) noexcept {
+    fst_assert(__index < _size, "dynamic_aligned_buffer::operator[] Index out of bounds");
+    return _data[__index];
+  }
+
+  inline const_reference operator[](size_type __index) const noexcept {
+    fst_assert(__index < _size, "dynamic_aligned_buffer::operator[] Index out of bounds");
+    return _data[__index];
+  }
+
+  inline pointer data() noexcept { return _data; }
+  inline const_pointer data() const noexcept { return _data; }
+
+  inline iterator begin() noexcept { return _data; }
+  inline const_iterator begin() const noexcept { return _data; }
+  inline iterator end() noexcept { return _data + _size; }
+  inline const_iterator end() const noexcept { return _data + _size; }
+
+private:
+  using allocator_type = aligned_allocator<value_type, alignment>;
+  pointer _data = nullptr;
+  size_type _size = 0;
+
+  inline void release() noexcept {
+    if (_data) {
+      std::destroy(_data, _data + _size);
+      allocator_type().deallocate(_data, _size);
+      _data = nullptr;
+      _size = 0;
+    }
+  }
+};
 } // namespace fst.
@@ -0,0 +1,681 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+#pragma once
+#include "fst/common.h"
+#include "fst/assert.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+// clang-format off
+#if __FST_AVX2__
+  #include <immintrin.h>
+#endif
+
+#if __FST_MSVC__
+  #include <intrin.h>
+#endif
+// clang-format on
+
+namespace fst {
+namespace bit {
+  inline std::size_t popcount(std::uint64_t value) noexcept {
+#if __FST_MSVC__ && defined(_M_X64)
+    return (std::size_t)__popcnt64(value);
+#elif __FST_MSVC__
+    value = value - ((value >> 1) & 0x5555555555555555ull);
+    value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (std::size_t)((value * 0x0101010101010101ull) >> 56);
+#else
+    return (std::size_t)__builtin_popcountll(value);
+#endif
+  }
+
+  /// Index of the lowest set bit, value must not be zero.
+  inline std::size_t countr_zero(std::uint64_t value) noexcept {
+    fst_assert(value, "bit::countr_zero of zero is undefined");
+#if __FST_MSVC__ && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (std::size_t)index;
+#elif __FST_MSVC__
+    unsigned long index;
+    if (_BitScanForward(&index, (unsigned long)value)) {
+      return (std::size_t)index;
+    }
+    _BitScanForward(&index, (unsigned long)(value >> 32));
+    return (std::size_t)index + 32;
+#else
+    return (std::size_t)__builtin_ctzll(value);
+#endif
+  }
+
+  /// Index of the k-th (from 0) set bit of value, value must have more than k bits set.
+  inline std::size_t select(std::uint64_t value, std::size_t k) noexcept {
+    for (std::size_t i = 0; i < k; i++) {
+      value &= value - 1;
+    }
+    return countr_zero(value);
+  }
+
+  enum class operation { bit_or, bit_and, bit_xor, bit_and_not };
+
+  template <operation _Op>
+  inline std::uint64_t apply(std::uint64_t a, std::uint64_t b) noexcept {
+    if constexpr (_Op == operation::bit_or) {
+      return a | b;
+    }
+    else if constexpr (_Op == operation::bit_and) {
+      return a & b;
+    }
+    else if constexpr (_Op == operation::bit_xor) {
+      return a ^ b;
+    }
+    else {
+      return a & ~b;
+    }
+  }
+
+#if __FST_AVX2__
+  template <operation _Op>
+  inline __m256i apply(__m256i a, __m256i b) noexcept {
+    if constexpr (_Op == operation::bit_or) {
+      return _mm256_or_si256(a, b);
+    }
+    else if constexpr (_Op == operation::bit_and) {
+      return _mm256_and_si256(a, b);
+    }
+    else if constexpr (_Op == operation::bit_xor) {
+      return _mm256_xor_si256(a, b);
+    }
+    else {
+      return _mm256_andnot_si256(b, a);
+    }
+  }
+#endif
+
+  /// dst[i] = dst[i] op src[i], 4 words at a time with AVX2.
+  template <operation _Op>
+  inline void apply(std::uint64_t* dst, const std::uint64_t* src, std::size_t count) noexcept {
+    std::size_t i = 0;
+#if __FST_AVX2__
+    for (; i + 4 <= count; i += 4) {
+      const __m256i a = _mm256_loadu_si256((const __m256i*)(dst + i));
+      const __m256i b = _mm256_loadu_si256((const __m256i*)(src + i));
+      _mm256_storeu_si256((__m256i*)(dst + i), apply<_Op>(a, b));
+    }
+#endif
+    for (; i < count; i++) {
+      dst[i] = apply<_Op>(dst[i], src[i]);
+    }
+  }
+
+  inline std::size_t popcount(const std::uint64_t* words, std::size_t count) noexcept {
+    // Independent accumulators keep several popcnt in flight.
+    std::size_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      c0 += popcount(words[i]);
+      c1 += popcount(words[i + 1]);
+      c2 += popcount(words[i + 2]);
+      c3 += popcount(words[i + 3]);
+    }
+
+    for (; i < count; i++) {
+      c0 += popcount(words[i]);
+    }
+    return c0 + c1 + c2 + c3;
+  }
+
+  /// Calls fct(index) for each set bit of the words, from the lowest index.
+  template <typename _Fct>
+  inline void for_each_set_bit(const std::uint64_t* words, std::size_t word_count, _Fct&& fct) {
+    for (std::size_t i = 0; i < word_count; i++) {
+      for (std::uint64_t w = words[i]; w; w &= w - 1) {
+        fct(i * 64 + countr_zero(w));
+      }
+    }
+  }
+} // namespace bit.
+
+/// Packed bitset with a compile time size.
+template <std::size_t _Size>
+class fixed_bitset {
+public:
+  using word_type = std::uint64_t;
+  using size_type = std::size_t;
+  static constexpr size_type bits_per_word = 64;
+  static constexpr size_type maximum_size = _Size;
+  static constexpr size_type word_count = (_Size + bits_per_word - 1) / bits_per_word;
+
+  static_assert(_Size > 0, "fixed_bitset size must be greater than 0");
+
+  inline constexpr fixed_bitset() noexcept
+      : _words{} {}
+
+  [[nodiscard]] inline constexpr size_type size() const noexcept { return maximum_size; }
+
+  inline constexpr bool test(size_type index) const noexcept {
+    fst_assert(index < maximum_size, "fixed_bitset::test Out of bound index.");
+    return (_words[index / bits_per_word] >> (index % bits_per_word)) & 1;
+  }
+
+  inline constexpr bool operator[](size_type index) const noexcept { return test(index); }
+
+  inline constexpr void set(size_type index) noexcept {
+    fst_assert(index < maximum_size, "fixed_bitset::set Out of bound index.");
+    _words[index / bits_per_word] |= word_type(1) << (index % bits_per_word);
+  }
+
+  inline constexpr void set(size_type index, bool value) noexcept {
+    if (value) {
+      set(index);
+    }
+    else {
+      reset(index);
+    }
+  }
+
+  inline constexpr void reset(size_type index) noexcept {
+    fst_assert(index < maximum_size, "fixed_bitset::reset Out of bound index.");
+    _words[index / bits_per_word] &= ~(word_type(1) << (index % bits_per_word));
+  }
+
+  inline constexpr void flip(size_type index) noexcept {
+    fst_assert(index < maximum_size, "fixed_bitset::flip Out of bound index.");
+    _words[index / bits_per_word] ^= word_type(1) << (index % bits_per_word);
+  }
+
+  /// Sets all the bits.
+  inline constexpr void set() noexcept {
+    for (word_type& w : _words) {
+      w = ~word_type(0);
+    }
+    clear_unused_bits();
+  }
+
+  /// Clears all the bits.
+  inline constexpr void reset() noexcept {
+    for (word_type& w : _words) {
+      w = 0;
+    }
+  }
+
+  inline size_type count() const noexcept {
+    size_type c = 0;
+    for (word_type w : _words) {
+      c += bit::popcount(w);
+    }
+    return c;
+  }
+
+  inline constexpr bool any() const noexcept {
+    for (word_type w : _words) {
+      if (w) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  inline constexpr bool none() const noexcept { return !any(); }
+
+  /// Index of the first set bit at or after index, size() if there is none.
+  inline size_type find_next(size_type index) const noexcept {
+    if (index >= maximum_size) {
+      return maximum_size;
+    }
+
+    size_type w_index = index / bits_per_word;
+    word_type w = _words[w_index] & (~word_type(0) << (index % bits_per_word));
+
+    while (!w) {
+      if (++w_index == word_count) {
+        return maximum_size;
+      }
+      w = _words[w_index];
+    }
+
+    return w_index * bits_per_word + bit::countr_zero(w);
+  }
+
+  inline size_type find_first() const noexcept { return find_next(0); }
+
+  template <typename _Fct>
+  inline void for_each(_Fct&& fct) const {
+    bit::for_each_set_bit(_words.data(), word_count, std::forward<_Fct>(fct));
+  }
+
+  //
+  // Set algebra.
+  //
+  inline constexpr fixed_bitset& operator|=(const fixed_bitset& b) noexcept {
+    for (size_type i = 0; i < word_count; i++) {
+      _words[i] |= b._words[i];
+    }
+    return *this;
+  }
+
+  inline constexpr fixed_bitset& operator&=(const fixed_bitset& b) noexcept {
+    for (size_type i = 0; i < word_count; i++) {
+      _words[i] &= b._words[i];
+    }
+    return *this;
+  }
+
+  inline constexpr fixed_bitset& operator^=(const fixed_bitset& b) noexcept {
+    for (size_type i = 0; i < word_count; i++) {
+      _words[i] ^= b._words[i];
+    }
+    return *this;
+  }
+
+  /// Difference, keeps the bits that are not set in b.
+  inline constexpr fixed_bitset& operator-=(const fixed_bitset& b) noexcept {
+    for (size_type i = 0; i < word_count; i++) {
+      _words[i] &= ~b._words[i];
+    }
+    return *this;
+  }
+
+  inline constexpr fixed_bitset operator~() const noexcept {
+    fixed_bitset r;
+    for (size_type i = 0; i < word_count; i++) {
+      r._words[i] = ~_words[i];
+    }
+    r.clear_unused_bits();
+    return r;
+  }
+
+  friend inline constexpr fixed_bitset operator|(fixed_bitset a, const fixed_bitset& b) noexcept { return a |= b; }
+  friend inline constexpr fixed_bitset operator&(fixed_bitset a, const fixed_bitset& b) noexcept { return a &= b; }
+  friend inline constexpr fixed_bitset operator^(fixed_bitset a, const fixed_bitset& b) noexcept { return a ^= b; }
+  friend inline constexpr fixed_bitset operator-(fixed_bitset a, const fixed_bitset& b) noexcept { return a -= b; }
+
+  inline constexpr bool operator==(const fixed_bitset& b) const noexcept {
+    for (size_type i = 0; i < word_count; i++) {
+      if (_words[i] != b._words[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  inline constexpr bool operator!=(const fixed_bitset& b) const noexcept { return !operator==(b); }
+
+  /// Number of bits set in both.
+  inline size_type intersection_count(const fixed_bitset& b) const noexcept {
+    size_type c = 0;
+    for (size_type i = 0; i < word_count; i++) {
+      c += bit::popcount(_words[i] & b._words[i]);
+    }
+    return c;
+  }
+
+  inline constexpr bool intersects(const fixed_bitset& b) const noexcept {
+    for (size_type i = 0; i < word_count; i++) {
+      if (_words[i] & b._words[i]) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  inline constexpr bool is_subset_of(const fixed_bitset& b) const noexcept {
+    for (size_type i = 0; i < word_count; i++) {
+      if (_words[i] & ~b._words[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  inline constexpr word_type* data() noexcept { return _words.data(); }
+  inline constexpr const word_type* data() const noexcept { return _words.data(); }
+
+private:
+  std::array<word_type, word_count> _words;
+
+  inline constexpr void clear_unused_bits() noexcept {
+    if constexpr (maximum_size % bits_per_word) {
+      _words[word_count - 1] &= (word_type(1) << (maximum_size % bits_per_word)) - 1;
+    }
+  }
+};
+
+/// Packed bitset with a runtime size.
+///
+/// Bulk operations process 4 words at a time with AVX2 when enabled, set bits are
+/// iterated with tzcnt. rank() and select() scan the words, see bitset_rank_index
+/// for constant time queries on a bitset that no longer changes.
+template <typename _Allocator = std::allocator<std::uint64_t>>
+class basic_bitset {
+public:
+  using word_type = std::uint64_t;
+  using size_type = std::size_t;
+  using allocator_type = _Allocator;
+  static constexpr size_type bits_per_word = 64;
+  static constexpr size_type npos = (size_type)-1;
+
+  basic_bitset() noexcept = default;
+
+  inline explicit basic_bitset(const allocator_type& alloc) noexcept
+      : _words(alloc) {}
+
+  inline explicit basic_bitset(size_type size, bool value = false, const allocator_type& alloc = allocator_type())
+      : _words(words_for(size), value ? ~word_type(0) : 0, alloc)
+      , _size(size) {
+    clear_unused_bits();
+  }
+
+  inline allocator_type get_allocator() const noexcept { return _words.get_allocator(); }
+
+  [[nodiscard]] inline size_type size() const noexcept { return _size; }
+  [[nodiscard]] inline bool empty() const noexcept { return _size == 0; }
+  [[nodiscard]] inline size_type word_count() const noexcept { return _words.size(); }
+
+  /// New bits are set to value.
+  inline void resize(size_type size, bool value = false) {
+    if (value && size > _size && _size % bits_per_word) {
+      _words.back() |= ~word_type(0) << (_size % bits_per_word);
+    }
+
+    _words.resize(words_for(size), value ? ~word_type(0) : 0);
+    _size = size;
+    clear_unused_bits();
+  }
+
+  inline bool test(size_type index) const noexcept {
+    fst_assert(index < _size, "bitset::test Out of bound index.");
+    return (_words[index / bits_per_word] >> (index % bits_per_word)) & 1;
+  }
+
+  inline bool operator[](size_type index) const noexcept { return test(index); }
+
+  inline void set(size_type index) noexcept {
+    fst_assert(index < _size, "bitset::set Out of bound index.");
+    _words[index / bits_per_word] |= word_type(1) << (index % bits_per_word);
+  }
+
+  inline void set(size_type index, bool value) noexcept {
+    if (value) {
+      set(index);
+    }
+    else {
+      reset(index);
+    }
+  }
+
+  inline void reset(size_type index) noexcept {
+    fst_assert(index < _size, "bitset::reset Out of bound index.");
+    _words[index / bits_per_word] &= ~(word_type(1) << (index % bits_per_word));
+  }
+
+  inline void flip(size_type index) noexcept {
+    fst_assert(index < _size, "bitset::flip Out of bound index.");
+    _words[index / bits_per_word] ^= word_type(1) << (index % bits_per_word);
+  }
+
+  /// Sets all the bits.
+  inline void set() noexcept {
+    std::fill(_words.begin(), _words.end(), ~word_type(0));
+    clear_unused_bits();
+  }
+
+  /// Clears all the bits.
+  inline void reset() noexcept { std::fill(_words.begin(), _words.end(), word_type(0)); }
+
+  inline size_type count() const noexcept { return bit::popcount(_words.data(), _words.size()); }
+
+  inline bool any() const noexcept {
+    return std::any_of(_words.begin(), _words.end(), [](word_type w) { return w != 0; });
+  }
+
+  inline bool none() const noexcept { return !any(); }
+
+  /// Index of the first set bit at or after index, size() if there is none.
+  inline size_type find_next(size_type index) const noexcept {
+    if (index >= _size) {
+      return _size;
+    }
+
+    size_type w_index = index / bits_per_word;
+    word_type w = _words[w_index] & (~word_type(0) << (index % bits_per_word));
+
+    while (!w) {
+      if (++w_index == _words.size()) {
+        return _size;
+      }
+      w = _words[w_index];
+    }
+
+    return w_index * bits_per_word + bit::countr_zero(w);
+  }
+
+  inline size_type find_first() const noexcept { return find_next(0); }
+
+  template <typename _Fct>
+  inline void for_each(_Fct&& fct) const {
+    bit::for_each_set_bit(_words.data(), _words.size(), std::forward<_Fct>(fct));
+  }
+
+  /// Number of set bits in [0, index).
+  inline size_type rank(size_type index) const noexcept {
+    fst_assert(index <= _size, "bitset::rank Out of bound index.");
+    const size_type w_index = index / bits_per_word;
+    size_type r = bit::popcount(_words.data(), w_index);
+    if (index % bits_per_word) {
+      r += bit::popcount(_words[w_index] & ((word_type(1) << (index % bits_per_word)) - 1));
+    }
+    return r;
+  }
+
+  /// Index of the k-th (from 0) set bit, npos if count() <= k.
+  inline size_type select(size_type k) const noexcept {
+    for (size_type i = 0; i < _words.size(); i++) {
+      const size_type c = bit::popcount(_words[i]);
+      if (k < c) {
+        return i * bits_per_word + bit::select(_words[i], k);
+      }
+      k -= c;
+    }
+    return npos;
+  }
+
+  //
+  // Set algebra, both bitsets must have the same size.
+  //
+  inline basic_bitset& operator|=(const basic_bitset& b) noexcept { return apply<bit::operation::bit_or>(b); }
+  inline basic_bitset& operator&=(const basic_bitset& b) noexcept { return apply<bit::operation::bit_and>(b); }
+  inline basic_bitset& operator^=(const basic_bitset& b) noexcept { return apply<bit::operation::bit_xor>(b); }
+
+  /// Difference, keeps the bits that are not set in b.
+  inline basic_bitset& operator-=(const basic_bitset& b) noexcept { return apply<bit::operation::bit_and_not>(b); }
+
+  inline basic_bitset operator~() const {
+    basic_bitset r(*this);
+    for (word_type& w : r._words) {
+      w = ~w;
+    }
+    r.clear_unused_bits();
+    return r;
+  }
+
+  friend inline basic_bitset operator|(basic_bitset a, const basic_bitset& b) noexcept { return a |= b; }
+  friend inline basic_bitset operator&(basic_bitset a, const basic_bitset& b) noexcept { return a &= b; }
+  friend inline basic_bitset operator^(basic_bitset a, const basic_bitset& b) noexcept { return a ^= b; }
+  friend inline basic_bitset operator-(basic_bitset a, const basic_bitset& b) noexcept { return a -= b; }
+
+  inline bool operator==(const basic_bitset& b) const noexcept { return _size == b._size && _words == b._words; }
+  inline bool operator!=(const basic_bitset& b) const noexcept { return !operator==(b); }
+
+  /// Number of bits set in both, sizes can differ.
+  inline size_type intersection_count(const basic_bitset& b) const noexcept {
+    const size_type count = std::min(_words.size(), b._words.size());
+    size_type c = 0;
+    for (size_type i = 0; i < count; i++) {
+      c += bit::popcount(_words[i] & b._words[i]);
+    }
+    return c;
+  }
+
+  inline bool intersects(const basic_bitset& b) const noexcept {
+    const size_type count = std::min(_words.size(), b._words.size());
+    for (size_type i = 0; i < count; i++) {
+      if (_words[i] & b._words[i]) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  inline bool is_subset_of(const basic_bitset& b) const noexcept {
+    for (size_type i = 0; i < _words.size(); i++) {
+      const word_type other = i < b._words.size() ? b._words[i] : 0;
+      if (_words[i] & ~other) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  inline word_type* data() noexcept { return _words.data(); }
+  inline const word_type* data() const noexcept { return _words.data(); }
+
+private:
+  std::vector<word_type, allocator_type> _words;
+  size_type _size = 0;
+
+  static inline size_type words_for(size_type size) noexcept { return (size + bits_per_word - 1) / bits_per_word; }
+
+  inline void clear_unused_bits() noexcept {
+    if (_size % bits_per_word) {
+      _words.back() &= (word_type(1) << (_size % bits_per_word)) - 1;
+    }
+  }
+
+  template <bit::operation _Op>
+  inline basic_bitset& apply(const basic_bitset& b) noexcept {
+    fst_assert(_size == b._size, "bitset operation on different sizes.");
+    bit::apply<_Op>(_words.data(), b._words.data(), std::min(_words.size(), b._words.size()));
+    return *this;
+  }
+};
+
+using bitset = basic_bitset<>;
+using pmr_bitset = basic_bitset<std::pmr::polymorphic_allocator<std::uint64_t>>;
+
+/// Cumulative popcounts of a bitset for constant time rank and logarithmic select.
+/// It must be rebuilt when the bitset changes.
+class bitset_rank_index {
+public:
+  using size_type = std::size_t;
+  static constexpr size_type npos = bitset::npos;
+
+  // One count for every 8 words (512 bits, a cache line).
+  static constexpr size_type words_per_block = 8;
+
+  bitset_rank_index() noexcept = default;
+
+  template <typename _Allocator>
+  inline explicit bitset_rank_index(const basic_bitset<_Allocator>& b) {
+    build(b);
+  }
+
+  template <typename _Allocator>
+  inline void build(const basic_bitset<_Allocator>& b) {
+    _words = b.data();
+    _size = b.size();
+    const size_type block_count = (b.word_count() + words_per_block - 1) / words_per_block;
+    _blocks.resize(block_count + 1);
+
+    size_type total = 0;
+    for (size_type i = 0; i < block_count; i++) {
+      _blocks[i] = total;
+      const size_type first = i * words_per_block;
+      total += bit::popcount(b.data() + first, std::min(words_per_block, b.word_count() - first));
+    }
+    _blocks[block_count] = total;
+  }
+
+  /// Number of set bits.
+  inline size_type count() const noexcept { return _blocks.empty() ? 0 : _blocks.back(); }
+
+  /// Number of set bits in [0, index).
+  inline size_type rank(size_type index) const noexcept {
+    fst_assert(index <= _size, "bitset_rank_index::rank Out of bound index.");
+    const size_type w_index = index / bitset::bits_per_word;
+    const size_type block = w_index / words_per_block;
+    const bitset::word_type* words = _words;
+
+    size_type r = _blocks[block] + bit::popcount(words + block * words_per_block, w_index - block * words_per_block);
+    if (index % bitset::bits_per_word) {
+      r += bit::popcount(words[w_index] & ((bitset::word_type(1) << (index % bitset::bits_per_word)) - 1));
+    }
+    return r;
+  }
+
+  /// Index of the k-th (from 0) set bit, npos if count() <= k.
+  inline size_type select(size_type k) const noexcept {
+    if (k >= count()) {
+      return npos;
+    }
+
+    // Last block starting with k or fewer bits before it.
+    const size_type block = (size_type)(std::upper_bound(_blocks.begin(), _blocks.end(), k) - _blocks.begin()) - 1;
+    k -= _blocks[block];
+
+    const bitset::word_type* words = _words;
+    for (size_type i = block * words_per_block;; i++) {
+      const size_type c = bit::popcount(words[i]);
+      if (k < c) {
+        return i * bitset::bits_per_word + bit::select(words[i], k);
+      }
+      k -= c;
+    }
+  }
+
+private:
+  const bitset::word_type* _words = nullptr;
+  size_type _size = 0;
+  std::vector<size_type> _blocks;
+};
+} // namespace fst.
@@ -0,0 +1,365 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+#pragma once
+#include "fst/assert.h"
+#include "fst/byte_view.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace fst {
+namespace byte_reader_detail {
+  template <typename T>
+  inline T byte_swap(T value) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value, "Type cannot be serialized.");
+
+    if constexpr (sizeof(T) == 1) {
+      return value;
+    }
+#if __FST_CLANG__ || __FST_GCC__
+    else if constexpr (sizeof(T) == 2) {
+      std::uint16_t v;
+      std::memcpy(&v, &value, sizeof(T));
+      v = __builtin_bswap16(v);
+      std::memcpy(&value, &v, sizeof(T));
+      return value;
+    }
+    else if constexpr (sizeof(T) == 4) {
+      std::uint32_t v;
+      std::memcpy(&v, &value, sizeof(T));
+      v = __builtin_bswap32(v);
+      std::memcpy(&value, &v, sizeof(T));
+      return value;
+    }
+    else if constexpr (sizeof(T) == 8) {
+      std::uint64_t v;
+      std::memcpy(&v, &value, sizeof(T));
+      v = __builtin_bswap64(v);
+      std::memcpy(&value, &v, sizeof(T));
+      return value;
+    }
+#endif
+    else {
+      std::uint8_t* data = reinterpret_cast<std::uint8_t*>(&value);
+      for (std::size_t i = 0, j = sizeof(T) - 1; i < j; i++, j--) {
+        std::uint8_t tmp = data[i];
+        data[i] = data[j];
+        data[j] = tmp;
+      }
+      return value;
+    }
+  }
+} // namespace byte_reader_detail.
+
+/// Forward only cursor reading typed fields out of a byte_view.
+///
+/// All loads go through std::memcpy so they are safe on any alignment.
+/// A failed read puts the reader in an error state (like std::istream): every
+/// following checked read returns a default value until clear_error() is called.
+///
+/// For hot paths, call require(n) once and then use the read_unchecked functions
+/// for the next n bytes.
+///
+/// @code
+///   fst::byte_reader reader(view);
+///   if (reader.require(8)) {
+///     std::uint32_t id = reader.read_unchecked<std::uint32_t>();
+///     std::uint32_t size = reader.read_unchecked<std::uint32_t>();
+///   }
+/// @endcode
+class byte_reader {
+public:
+  using value_type = std::uint8_t;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using const_pointer = const value_type*;
+  using convert_options = byte_view::convert_options;
+
+  // Longest LEB128 encoding of a 64 bit value.
+  static constexpr size_type maximum_varint_size = 10;
+
+  byte_reader() noexcept = default;
+  byte_reader(const byte_reader&) noexcept = default;
+  byte_reader(byte_reader&&) noexcept = default;
+
+  inline byte_reader(byte_view view) noexcept
+      : _view(view) {}
+
+  inline byte_reader(const void* data, size_type size) noexcept
+      : _view((const value_type*)data, size) {}
+
+  byte_reader& operator=(const byte_reader&) noexcept = default;
+  byte_reader& operator=(byte_reader&&) noexcept = default;
+
+  //
+  // MARK: State.
+  //
+  [[nodiscard]] inline bool is_valid() const noexcept { return !_has_error; }
+  [[nodiscard]] inline bool has_error() const noexcept { return _has_error; }
+  inline explicit operator bool() const noexcept { return !_has_error; }
+  inline void clear_error() noexcept { _has_error = false; }
+
+  [[nodiscard]] inline size_type position() const noexcept { return _position; }
+  [[nodiscard]] inline size_type size() const noexcept { return _view.size(); }
+  [[nodiscard]] inline size_type remaining() const noexcept { return _view.size() - _position; }
+  [[nodiscard]] inline bool empty() const noexcept { return remaining() == 0; }
+
+  [[nodiscard]] inline byte_view view() const noexcept { return _view; }
+  [[nodiscard]] inline byte_view remaining_view() const noexcept {
+    return byte_view(_view.data() + _position, remaining());
+  }
+
+  [[nodiscard]] inline const_pointer data() const noexcept { return _view.data() + _position; }
+
+  //
+  // MARK: Bounds.
+  //
+  [[nodiscard]] inline bool can_read(size_type count) const noexcept { return !_has_error && count <= remaining(); }
+
+  // Bounds check for a batch of read_unchecked calls totalling count bytes.
+  // Sets the error state and returns false when there isn't enough data left.
+  inline bool require(size_type count) noexcept {
+    if (can_read(count)) {
+      return true;
+    }
+
+    _has_error = true;
+    return false;
+  }
+
+  inline bool seek(size_type position) noexcept {
+    if (_has_error || position > size()) {
+      _has_error = true;
+      return false;
+    }
+
+    _position = position;
+    return true;
+  }
+
+  inline bool skip(size_type count) noexcept {
+    if (!require(count)) {
+      return false;
+    }
+
+    _position += count;
+    return true;
+  }
+
+  // Skips up to the next multiple of alignment from the start of the view.
+  inline bool align(size_type alignment) noexcept {
+    fst_assert(alignment != 0, "byte_reader::align alignment must be greater than 0.");
+    size_type rem = _position % alignment;
+    return rem ? skip(alignment - rem) : !_has_error;
+  }
+
+  //
+  // MARK: Typed reads.
+  //
+  template <typename T, bool _IsLittleEndian = true>
+  inline T read_unchecked() noexcept {
+    static_assert(std::is_trivially_copyable<T>::value, "Type cannot be serialized.");
+    fst_assert(sizeof(T) <= remaining(), "byte_reader::read_unchecked Out of bounds read.");
+
+    T value;
+    std::memcpy(&value, _view.data() + _position, sizeof(T));
+    _position += sizeof(T);
+
+    if constexpr (_IsLittleEndian) {
+      return value;
+    }
+    else {
+      return byte_reader_detail::byte_swap(value);
+    }
+  }
+
+  template <typename T, bool _IsLittleEndian = true>
+  inline bool read(T& value) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value, "Type cannot be serialized.");
+
+    if (!require(sizeof(T))) {
+      return false;
+    }
+
+    value = read_unchecked<T, _IsLittleEndian>();
+    return true;
+  }
+
+  // Returns T{} on failure.
+  template <typename T, bool _IsLittleEndian = true>
+  inline T read() noexcept {
+    T value{};
+    read<T, _IsLittleEndian>(value);
+    return value;
+  }
+
+  // Reads without moving the cursor, returns T{} when there isn't enough data left.
+  template <typename T, bool _IsLittleEndian = true>
+  inline T peek() const noexcept {
+    static_assert(std::is_trivially_copyable<T>::value, "Type cannot be serialized.");
+
+    if (!can_read(sizeof(T))) {
+      return T{};
+    }
+
+    byte_reader r = *this;
+    return r.read_unchecked<T, _IsLittleEndian>();
+  }
+
+  template <typename T, bool _IsLittleEndian = true>
+  inline bool read(T* buffer, size_type count) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value, "Type cannot be serialized.");
+
+    // Divides instead of multiplying so that a huge count can't wrap past the check.
+    if (_has_error || count > remaining() / sizeof(T)) {
+      _has_error = true;
+      return false;
+    }
+
+    if constexpr (_IsLittleEndian) {
+      std::memcpy(buffer, _view.data() + _position, count * sizeof(T));
+      _position += count * sizeof(T);
+    }
+    else {
+      for (size_type i = 0; i < count; i++) {
+        buffer[i] = read_unchecked<T, _IsLittleEndian>();
+      }
+    }
+
+    return true;
+  }
+
+  // Reads one pcm sample and converts it to a floating point value in [-1, 1].
+  template <typename T, convert_options c_opts>
+  inline T read() noexcept {
+    static_assert(std::is_floating_point<T>::value, "Type must be a floating point.");
+    constexpr size_type sample_size = c_opts == convert_options::pcm_8_bit ? 1
+        : c_opts == convert_options::pcm_16_bit                             ? 2
+        : c_opts == convert_options::pcm_24_bit                             ? 3
+                                                                            : 4;
+
+    if (!require(sample_size)) {
+      return T(0);
+    }
+
+    T value = _view.as<T, c_opts>(_position);
+    _position += sample_size;
+    return value;
+  }
+
+  //
+  // MARK: Variable length reads.
+  //
+
+  // Unsigned LEB128.
+  inline bool read_varint(std::uint64_t& value) noexcept {
+    if (_has_error) {
+      return false;
+    }
+
+    std::uint64_t result = 0;
+    const size_type max_count = remaining() < maximum_varint_size ? remaining() : maximum_varint_size;
+    const_pointer data = _view.data() + _position;
+
+    for (size_type i = 0; i < max_count; i++) {
+      const std::uint64_t byte = data[i];
+      result |= (byte & 0x7F) << (7 * i);
+
+      if (!(byte & 0x80)) {
+        // The 10th byte can only hold the last bit of a 64 bit value.
+        if (i == maximum_varint_size - 1 && byte > 1) {
+          break;
+        }
+
+        _position += i + 1;
+        value = result;
+        return true;
+      }
+    }
+
+    _has_error = true;
+    return false;
+  }
+
+  inline std::uint64_t read_varint() noexcept {
+    std::uint64_t value = 0;
+    read_varint(value);
+    return value;
+  }
+
+  // Zigzag encoded LEB128.
+  inline std::int64_t read_signed_varint() noexcept {
+    std::uint64_t value = read_varint();
+    return (std::int64_t)(value >> 1) ^ -(std::int64_t)(value & 1);
+  }
+
+  // Returns an empty view on failure.
+  inline byte_view read_bytes(size_type count) noexcept {
+    if (!require(count)) {
+      return byte_view();
+    }
+
+    byte_view view(_view.data() + _position, count);
+    _position += count;
+    return view;
+  }
+
+  inline std::string_view read_string(size_type count) noexcept {
+    byte_view view = read_bytes(count);
+    return std::string_view((const char*)view.data(), view.size());
+  }
+
+  // String preceded by its byte size stored as a _LengthType.
+  template <typename _LengthType = std::uint32_t, bool _IsLittleEndian = true>
+  inline std::string_view read_prefixed_string() noexcept {
+    static_assert(std::is_integral<_LengthType>::value, "Integral type required.");
+    const _LengthType length = read<_LengthType, _IsLittleEndian>();
+    return _has_error ? std::string_view() : read_string((size_type)length);
+  }
+
+  // String preceded by its byte size stored as a LEB128 varint.
+  inline std::string_view read_varint_prefixed_string() noexcept {
+    const std::uint64_t length = read_varint();
+    return _has_error ? std::string_view() : read_string((size_type)length);
+  }
+
+private:
+  byte_view _view;
+  size_type _position = 0;
+  bool _has_error = false;
+};
+} // namespace fst.
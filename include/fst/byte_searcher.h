@@ -0,0 +1,285 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+#pragma once
+#include "fst/common.h"
+#include "fst/assert.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// clang-format off
+#if __FST_AVX2__
+  #include <immintrin.h>
+#elif __FST_SSE2__
+  #include <emmintrin.h>
+#endif
+
+#if __FST_MSVC__
+  #include <intrin.h>
+#endif
+// clang-format on
+
+namespace fst {
+namespace byte_search_detail {
+  using size_type = std::size_t;
+  using const_pointer = const std::uint8_t*;
+
+  inline int first_bit_index(std::uint32_t mask) noexcept {
+#if __FST_MSVC__
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+  }
+
+  inline const_pointer scalar_find(const_pointer data, size_type size, const_pointer needle, size_type k) noexcept {
+    const_pointer last = data + size - k;
+
+    for (const_pointer it = data; it <= last;) {
+      it = (const_pointer)std::memchr(it, needle[0], (size_type)(last - it) + 1);
+      if (!it) {
+        return nullptr;
+      }
+
+      if (std::memcmp(it + 1, needle + 1, k - 1) == 0) {
+        return it;
+      }
+
+      ++it;
+    }
+
+    return nullptr;
+  }
+
+  // Compares the first and last needle bytes against a whole register of
+  // candidate positions and only runs memcmp on positions where both match.
+  // http://0x80.pl/articles/simd-strfind.html
+#if __FST_AVX2__
+  inline const_pointer simd_find(const_pointer data, size_type size, const_pointer needle, size_type k) noexcept {
+    const __m256i first = _mm256_set1_epi8((char)needle[0]);
+    const __m256i last = _mm256_set1_epi8((char)needle[k - 1]);
+
+    size_type i = 0;
+    for (; i + k - 1 + 32 <= size; i += 32) {
+      const __m256i block_first = _mm256_loadu_si256((const __m256i*)(data + i));
+      const __m256i block_last = _mm256_loadu_si256((const __m256i*)(data + i + k - 1));
+      const __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last));
+
+      for (std::uint32_t mask = (std::uint32_t)_mm256_movemask_epi8(eq); mask; mask &= mask - 1) {
+        const size_type index = i + (size_type)first_bit_index(mask);
+        if (std::memcmp(data + index + 1, needle + 1, k - 2) == 0) {
+          return data + index;
+        }
+      }
+    }
+
+    return i + k <= size ? scalar_find(data + i, size - i, needle, k) : nullptr;
+  }
+
+#elif __FST_SSE2__
+  inline const_pointer simd_find(const_pointer data, size_type size, const_pointer needle, size_type k) noexcept {
+    const __m128i first = _mm_set1_epi8((char)needle[0]);
+    const __m128i last = _mm_set1_epi8((char)needle[k - 1]);
+
+    size_type i = 0;
+    for (; i + k - 1 + 16 <= size; i += 16) {
+      const __m128i block_first = _mm_loadu_si128((const __m128i*)(data + i));
+      const __m128i block_last = _mm_loadu_si128((const __m128i*)(data + i + k - 1));
+      const __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last));
+
+      for (std::uint32_t mask = (std::uint32_t)_mm_movemask_epi8(eq); mask; mask &= mask - 1) {
+        const size_type index = i + (size_type)first_bit_index(mask);
+        if (std::memcmp(data + index + 1, needle + 1, k - 2) == 0) {
+          return data + index;
+        }
+      }
+    }
+
+    return i + k <= size ? scalar_find(data + i, size - i, needle, k) : nullptr;
+  }
+
+#else
+  inline const_pointer simd_find(const_pointer data, size_type size, const_pointer needle, size_type k) noexcept {
+    return scalar_find(data, size, needle, k);
+  }
+#endif
+
+  using skip_table_type = std::array<size_type, 256>;
+
+  inline void fill_skip_table(skip_table_type& skip_table, const_pointer needle, size_type k) noexcept {
+    skip_table.fill(k);
+    for (size_type i = 0; i < k - 1; i++) {
+      skip_table[needle[i]] = k - 1 - i;
+    }
+  }
+
+  // Boyer-Moore-Horspool.
+  inline const_pointer horspool_find(const_pointer data, size_type size, const_pointer needle, size_type k,
+      const skip_table_type& skip_table) noexcept {
+    const std::uint8_t last = needle[k - 1];
+
+    for (size_type i = 0; i + k <= size;) {
+      const std::uint8_t c = data[i + k - 1];
+      if (c == last && std::memcmp(data + i, needle, k - 1) == 0) {
+        return data + i;
+      }
+
+      i += skip_table[c];
+    }
+
+    return nullptr;
+  }
+} // namespace byte_search_detail.
+
+/// Reusable substring searcher over raw bytes.
+///
+/// Needles up to short_needle_size bytes are located with a first/last byte
+/// SIMD filter (AVX2 or SSE2 depending on the compile flags), longer needles
+/// use Boyer-Moore-Horspool with a skip table computed once at construction.
+/// The needle is copied so the searcher can outlive it.
+class byte_searcher {
+public:
+  using value_type = std::uint8_t;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using const_pointer = const value_type*;
+
+  static constexpr size_type short_needle_size = 32;
+
+  byte_searcher() noexcept = default;
+
+  inline byte_searcher(const void* needle, size_type size)
+      : _needle((const_pointer)needle, (const_pointer)needle + size) {
+    if (!is_short_needle()) {
+      byte_search_detail::fill_skip_table(_skip_table, _needle.data(), size);
+    }
+  }
+
+  inline byte_searcher(std::string_view needle)
+      : byte_searcher(needle.data(), needle.size()) {}
+
+  [[nodiscard]] inline size_type size() const noexcept { return _needle.size(); }
+  [[nodiscard]] inline bool empty() const noexcept { return _needle.empty(); }
+  [[nodiscard]] inline const_pointer data() const noexcept { return _needle.data(); }
+  [[nodiscard]] inline bool is_short_needle() const noexcept { return _needle.size() <= short_needle_size; }
+
+  /// Returns the index of the first match at or after offset, or -1.
+  /// An empty needle matches at offset.
+  inline difference_type find(const void* data, size_type size, size_type offset = 0) const noexcept {
+    const size_type k = _needle.size();
+    if (offset > size || size - offset < k) {
+      return -1;
+    }
+
+    if (k == 0) {
+      return (difference_type)offset;
+    }
+
+    const_pointer begin = (const_pointer)data;
+    const_pointer it = find_impl(begin + offset, size - offset);
+    return it ? (difference_type)(it - begin) : -1;
+  }
+
+  /// Returns the index of every (possibly overlapping) match at or after offset.
+  /// An empty needle never matches.
+  inline std::vector<size_type> find_all(const void* data, size_type size, size_type offset = 0) const {
+    std::vector<size_type> indexes;
+    if (_needle.empty()) {
+      return indexes;
+    }
+
+    for (difference_type index = find(data, size, offset); index != -1; index = find(data, size, (size_type)index + 1)) {
+      indexes.push_back((size_type)index);
+    }
+
+    return indexes;
+  }
+
+private:
+  std::vector<value_type> _needle;
+  byte_search_detail::skip_table_type _skip_table = {};
+
+  inline const_pointer find_impl(const_pointer data, size_type size) const noexcept {
+    const size_type k = _needle.size();
+
+    if (k == 1) {
+      return (const_pointer)std::memchr(data, _needle[0], size);
+    }
+
+    if (is_short_needle()) {
+      return byte_search_detail::simd_find(data, size, _needle.data(), k);
+    }
+
+    return byte_search_detail::horspool_find(data, size, _needle.data(), k, _skip_table);
+  }
+};
+
+/// One shot search, prefer keeping a byte_searcher around when the needle is reused.
+/// Long needles build their skip table on the stack, so this never allocates.
+inline std::ptrdiff_t find_bytes(const void* data, std::size_t size, const void* needle, std::size_t needle_size,
+    std::size_t offset = 0) noexcept {
+  if (offset > size || size - offset < needle_size) {
+    return -1;
+  }
+
+  if (needle_size == 0) {
+    return (std::ptrdiff_t)offset;
+  }
+
+  using const_pointer = byte_search_detail::const_pointer;
+  const_pointer begin = (const_pointer)data;
+  const_pointer n = (const_pointer)needle;
+  const_pointer it;
+
+  if (needle_size == 1) {
+    it = (const_pointer)std::memchr(begin + offset, *n, size - offset);
+  }
+  else if (needle_size <= byte_searcher::short_needle_size) {
+    it = byte_search_detail::simd_find(begin + offset, size - offset, n, needle_size);
+  }
+  else {
+    byte_search_detail::skip_table_type skip_table;
+    byte_search_detail::fill_skip_table(skip_table, n, needle_size);
+    it = byte_search_detail::horspool_find(begin + offset, size - offset, n, needle_size, skip_table);
+  }
+
+  return it ? (std::ptrdiff_t)(it - begin) : -1;
+}
+} // namespace fst.
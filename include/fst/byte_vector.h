@@ -35,6 +35,9 @@
 #include "fst/assert.h"
 #include "fst/traits.h"
 #include "fst/mapped_file.h"
+#include "fst/aligned_buffer.h"
+#include "fst/byte_searcher.h"
+#include "fst/small_vector.h"
 
 /// IF DEBUG
 #include "fst/print.h"
@@ -45,8 +48,12 @@
 #include <string_view>
 #include <new>
 #include <cstring>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
 #include <filesystem>
 #include <fstream>
+#include <memory_resource>
 
 namespace fst {
 namespace byte_vector_detail {
@@ -68,6 +75,18 @@ namespace byte_vector_detail {
 
     static_assert(is_random_access_iterator<iterator>::value, "buffer_type needs to have random access iterator.");
 
+  private:
+    template <class _Alloc>
+    using enable_if_buffer_allocator = std::enable_if_t<std::is_constructible<buffer_type, const _Alloc&>::value
+        && !std::is_integral<_Alloc>::value && !std::is_convertible<const _Alloc&, std::string_view>::value
+        && !std::is_base_of<byte_vector, _Alloc>::value>;
+
+    // Keeps as(0) from being ambiguous when iterator is a raw pointer.
+    template <class _It>
+    using enable_if_iterator
+        = std::enable_if_t<std::is_same<_It, iterator>::value || std::is_same<_It, const_iterator>::value>;
+
+  public:
     enum class convert_options {
       pcm_8_bit,
       pcm_16_bit,
@@ -95,6 +114,12 @@ namespace byte_vector_detail {
     inline byte_vector(std::string_view data)
         : _buffer((const_pointer)data.data(), (const_pointer)data.data() + data.size()) {}
 
+    // Forwards an allocator (or anything the buffer_type accepts as one, e.g. a
+    // std::pmr::memory_resource* for pmr_byte_vector) to the underlying buffer.
+    template <class _Alloc, class = enable_if_buffer_allocator<_Alloc>>
+    inline explicit byte_vector(const _Alloc& alloc)
+        : _buffer(alloc) {}
+
     byte_vector& operator=(const byte_vector&) = default;
     byte_vector& operator=(byte_vector&&) = default;
 
@@ -191,7 +216,7 @@ namespace byte_vector_detail {
     template <template <typename> typename _InputBufferType, bool _IsLittleEndian = true>
     inline void push_back(const byte_vector<_InputBufferType>& bvec) {
       static_assert(_IsLittleEndian, "byte_vector::push_back is not supported for big endian.");
-      insert<_IsLittleEndian>(end(), bvec.begin(), bvec.end());
+      insert(end(), bvec.begin(), bvec.end());
     }
 
     template <typename T, bool _IsLittleEndian = true>
@@ -299,23 +324,38 @@ namespace byte_vector_detail {
     //
     template <class T>
     inline difference_type find(const T* data, size_type size) const noexcept {
-      typename buffer_type::const_iterator it = std::search(_buffer.cbegin(), _buffer.cend(), data, data + size);
-      if (it == _buffer.cend()) {
-        return -1;
-      }
-
-      return std::distance(_buffer.cbegin(), it);
+      return find(0, data, size);
     }
 
     template <class T>
     inline difference_type find(size_type offset, const T* data, size_type size) const noexcept {
-      typename buffer_type::const_iterator it
-          = std::search(_buffer.cbegin() + offset, _buffer.cend(), data, data + size);
-      if (it == _buffer.cend()) {
-        return -1;
+      if constexpr (sizeof(T) == 1) {
+        return fst::find_bytes(_buffer.data(), _buffer.size(), data, size, offset);
       }
+      else {
+        typename buffer_type::const_iterator it
+            = std::search(_buffer.cbegin() + offset, _buffer.cend(), data, data + size);
+        if (it == _buffer.cend()) {
+          return -1;
+        }
+
+        return std::distance(_buffer.cbegin(), it);
+      }
+    }
+
+    inline difference_type find(const byte_searcher& searcher, size_type offset = 0) const noexcept {
+      return searcher.find(_buffer.data(), _buffer.size(), offset);
+    }
+
+    // Returns the index of every (possibly overlapping) occurrence.
+    template <class T>
+    inline std::vector<size_type> find_all(const T* data, size_type size) const {
+      static_assert(sizeof(T) == 1, "byte_vector::find_all requires a byte sized type.");
+      return byte_searcher(data, size).find_all(_buffer.data(), _buffer.size());
+    }
 
-      return std::distance(_buffer.cbegin(), it);
+    inline std::vector<size_type> find_all(const byte_searcher& searcher, size_type offset = 0) const {
+      return searcher.find_all(_buffer.data(), _buffer.size(), offset);
     }
 
     //
@@ -365,10 +405,10 @@ namespace byte_vector_detail {
       }
     }
 
-    template <typename T, bool _IsLittleEndian = true>
-    inline T as(iterator pos) const noexcept {
+    template <typename T, bool _IsLittleEndian = true, class _It, class = enable_if_iterator<_It>>
+    inline T as(_It pos) const noexcept {
       static_assert(std::is_trivially_copyable<T>::value, "Type cannot be serialized.");
-      difference_type index = std::distance(pos, _buffer.begin());
+      difference_type index = std::distance(_buffer.cbegin(), const_iterator(pos));
       fst_assert(index >= 0, "Wrong iterator position.");
       return as<T, _IsLittleEndian>((size_type)index);
     }
@@ -381,10 +421,10 @@ namespace byte_vector_detail {
     }
 
     // Get array element at array_index from array starting at pos.
-    template <typename T, bool _IsLittleEndian = true>
-    inline T as(iterator pos, size_type array_index) const noexcept {
+    template <typename T, bool _IsLittleEndian = true, class _It, class = enable_if_iterator<_It>>
+    inline T as(_It pos, size_type array_index) const noexcept {
       static_assert(std::is_trivially_copyable<T>::value, "Type cannot be serialized.");
-      difference_type index = std::distance(pos, _buffer.begin());
+      difference_type index = std::distance(_buffer.cbegin(), const_iterator(pos));
       fst_assert(index >= 0, "Wrong iterator position.");
       return as<T, _IsLittleEndian>((size_type)index, array_index);
     }
@@ -513,7 +553,37 @@ namespace byte_vector_detail {
 
   template <typename T>
   using vector = std::vector<T>;
+
+  template <typename T>
+  using aligned_vector = std::vector<T, fst::aligned_allocator<T>>;
+
+  // Allocates from the std::pmr::memory_resource given at construction (e.g. a
+  // std::pmr::monotonic_buffer_resource), falls back to the default resource.
+  template <typename T>
+  using pmr_vector = std::pmr::vector<T>;
+
+  template <std::size_t _InlineSize>
+  struct small_buffer {
+    template <typename T>
+    using type = fst::small_vector<T, _InlineSize>;
+  };
 } // namespace byte_vector_detail.
 
 using byte_vector = byte_vector_detail::byte_vector<byte_vector_detail::vector>;
+
+/// byte_vector that keeps its first _InlineSize bytes on the stack.
+template <std::size_t _InlineSize = 256>
+using small_byte_vector = byte_vector_detail::byte_vector<byte_vector_detail::small_buffer<_InlineSize>::template type>;
+
+/// byte_vector whose data is aligned on a cache line (64 bytes).
+using aligned_byte_vector = byte_vector_detail::byte_vector<byte_vector_detail::aligned_vector>;
+
+/// byte_vector allocating from a caller supplied std::pmr::memory_resource.
+///
+/// @code
+///   std::array<std::uint8_t, 4096> storage;
+///   std::pmr::monotonic_buffer_resource arena(storage.data(), storage.size());
+///   fst::pmr_byte_vector bv(&arena);
+/// @endcode
+using pmr_byte_vector = byte_vector_detail::byte_vector<byte_vector_detail::pmr_vector>;
 } // namespace fst.
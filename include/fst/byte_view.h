@@ -34,10 +34,13 @@
 #pragma once
 #include "fst/assert.h"
 #include "fst/span.h"
+#include "fst/byte_searcher.h"
 #include <cstddef>
+#include <cstring>
 #include <new>
 #include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 namespace fst {
 class byte_view : public fst::span<const std::uint8_t> {
@@ -116,22 +119,37 @@ public:
   //
   template <class T>
   inline difference_type find(const T* data, size_type size) const noexcept {
-    iterator it = std::search(begin(), end(), data, data + size);
-    if (it == end()) {
-      return -1;
-    }
-
-    return std::distance(begin(), it);
+    return find(0, data, size);
   }
 
   template <class T>
   inline difference_type find(size_type offset, const T* data, size_type size) const noexcept {
-    iterator it = std::search(begin() + offset, end(), data, data + size);
-    if (it == end()) {
-      return -1;
+    if constexpr (sizeof(T) == 1) {
+      return fst::find_bytes(this->data(), this->size(), data, size, offset);
+    }
+    else {
+      iterator it = std::search(begin() + offset, end(), data, data + size);
+      if (it == end()) {
+        return -1;
+      }
+
+      return std::distance(begin(), it);
     }
+  }
+
+  inline difference_type find(const byte_searcher& searcher, size_type offset = 0) const noexcept {
+    return searcher.find(data(), size(), offset);
+  }
+
+  // Returns the index of every (possibly overlapping) occurrence.
+  template <class T>
+  inline std::vector<size_type> find_all(const T* data, size_type size) const {
+    static_assert(sizeof(T) == 1, "byte_view::find_all requires a byte sized type.");
+    return byte_searcher(data, size).find_all(this->data(), this->size());
+  }
 
-    return std::distance(begin(), it);
+  inline std::vector<size_type> find_all(const byte_searcher& searcher, size_type offset = 0) const {
+    return searcher.find_all(data(), size(), offset);
   }
 
   //
@@ -214,9 +214,9 @@ namespace fst::config {
   // Linux.
   #elif defined(__linux__) || defined(__linux) || defined(linux)
     #define __FST_ANDROID__ 0
-    #define __FST_BSD__     1
+    #define __FST_BSD__     0
     #define __FST_IOS__     0
-    #define __FST_LINUX__   0
+    #define __FST_LINUX__   1
     #define __FST_MACOS__   0
     #define __FST_SOLARIS__ 0
     #define __FST_WINDOWS__ 0
@@ -322,6 +322,37 @@ namespace fst::config {
     inline constexpr bool has_exceptions = true;
   #endif // __FST_NO_EXCEPTIONS__
 
+  //
+  // SIMD instruction sets enabled at compile time.
+  //
+  #undef __FST_SSE2__
+  #undef __FST_SSSE3__
+  #undef __FST_AVX2__
+
+  #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define __FST_SSE2__ 1
+    inline constexpr bool has_sse2 = true;
+  #else
+    #define __FST_SSE2__ 0
+    inline constexpr bool has_sse2 = false;
+  #endif
+
+  #if defined(__SSSE3__) || defined(__AVX__)
+    #define __FST_SSSE3__ 1
+    inline constexpr bool has_ssse3 = true;
+  #else
+    #define __FST_SSSE3__ 0
+    inline constexpr bool has_ssse3 = false;
+  #endif
+
+  #if defined(__AVX2__)
+    #define __FST_AVX2__ 1
+    inline constexpr bool has_avx2 = true;
+  #else
+    #define __FST_AVX2__ 0
+    inline constexpr bool has_avx2 = false;
+  #endif
+
 } // namespace fst::config.
 
 #if __FST_MSVC__
@@ -33,26 +33,64 @@
 
 #pragma once
 #include "fst/spin_lock.h"
-#include "fst/fixed_unordered_set.h"
-#include "fst/fixed_vector.h"
+#include "fst/flat_map.h"
+#include "fst/inplace_function.h"
+#include "fst/mpsc_queue.h"
 #include "fst/pointer.h"
+#include "fst/thread_pool.h"
+#include "fst/timer_wheel.h"
 #include "fst/traits.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
-#include <thread>
 #include <functional>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
 
 namespace fst {
+/// Runs callbacks on a dedicated thread at given deadlines.
+///
+/// Events are kept in a timer_wheel, the thread sleeps until the next deadline
+/// and is woken up when an earlier event is added. The tick based functions
+/// express their delays in multiples of get_delta_time().
+///
+/// Adding an event doesn't take a lock: it's pushed on an mpsc_queue that the
+/// event thread drains into the wheel. The thread is only woken up when it's
+/// parked and the new deadline comes before the one it's sleeping until, while
+/// it's awake it drains the queue again before parking. Ids are handed out
+/// right away, an event still in the queue is connected and can be removed.
+/// Callbacks are inplace_function and the queue recycles its nodes, so posting
+/// doesn't allocate while fewer than reserved_pending_events wait to be drained.
+///
+/// The due callbacks are collected under the lock and called after releasing it,
+/// on the event thread or on a thread_pool when init() is given a worker count.
+/// Callbacks can therefore add and remove events. A callback removed while it's
+/// about to be dispatched is skipped, and remove_event() waits for the calls that
+/// already started, so the callback isn't running anymore once it returns. A
+/// callback removing its own event doesn't wait for itself.
 class event_manager {
 public:
-  static constexpr std::size_t maximum_events_count = 64;
+  using clock = std::chrono::steady_clock;
+  using time_point = clock::time_point;
+  using duration = clock::duration;
+
+  /// Callbacks are stored without allocation, larger captures don't compile.
+  static constexpr std::size_t callback_capacity = 64;
+  using callback_type = fst::inplace_function<void(), callback_capacity>;
+
+  /// Events that can wait in the queue without allocating.
+  static constexpr std::size_t reserved_pending_events = 64;
+
   using idle_ms_type = std::chrono::milliseconds::rep;
   static constexpr idle_ms_type default_idle_ms = 5;
   static constexpr idle_ms_type minimum_idle_ms = 1;
   static constexpr idle_ms_type maximum_idle_ms = 500;
-  enum class event_id : std::size_t {};
-  static constexpr event_id invalid_id = (event_id)std::numeric_limits<std::size_t>::max();
+
+  enum class event_id : std::uint64_t {};
+  static constexpr event_id invalid_id = (event_id)std::numeric_limits<std::uint64_t>::max();
 
   class disconnector {
   public:
@@ -112,172 +150,371 @@ public:
     event_id _id = invalid_id;
   };
 
-  inline event_manager() = default;
+  inline event_manager()
+      : _pending_events(reserved_pending_events) {
+    _pending_events.reserve(reserved_pending_events);
+  }
+
   inline ~event_manager() { stop(); }
 
-  inline void init(idle_ms_type delta_time_ms = default_idle_ms) {
+  /// With a worker_count greater than 0 the callbacks are called on a thread_pool,
+  /// recurrent callbacks slower than their period can then overlap.
+  inline void init(idle_ms_type delta_time_ms = default_idle_ms, std::size_t worker_count = 0) {
     stop();
     _delta_time_ms = std::chrono::milliseconds(std::clamp(delta_time_ms, minimum_idle_ms, maximum_idle_ms));
-    _stopper.start();
-    _idle_thread = std::thread(&event_manager::idle_thread, std::ref(*this));
+    if (worker_count) {
+      _owned_workers = std::make_unique<fst::thread_pool>(worker_count);
+      _workers = _owned_workers.get();
+    }
+
+    start();
+  }
+
+  /// Calls the callbacks on a thread_pool shared with other work, it must outlive the event_manager.
+  /// Callbacks still queued on it when stopping can run afterward.
+  inline void init(idle_ms_type delta_time_ms, fst::thread_pool& workers) {
+    stop();
+    _delta_time_ms = std::chrono::milliseconds(std::clamp(delta_time_ms, minimum_idle_ms, maximum_idle_ms));
+    _workers = &workers;
+    start();
   }
 
   inline idle_ms_type get_delta_time() const { return _delta_time_ms.count(); }
 
-  inline event_id add_event(const std::function<void()>& fct) { return (event_id)_event_stack.add(fct, 0, 0, false); }
+  //
+  // Tick based events.
+  //
+
+  /// Called once, as soon as possible.
+  inline event_id add_event(const callback_type& fct) { return add_event(fct, 0, 0, false); }
 
-  inline event_id add_recurrent_event(const std::function<void()>& fct, std::size_t tick_count = 0) {
-    return (event_id)_event_stack.add(fct, tick_count, tick_count, true);
+  /// Called right away and then every tick_count ticks.
+  inline event_id add_recurrent_event(const callback_type& fct, std::size_t tick_count = 0) {
+    return add_event(fct, tick_count, tick_count, true);
   }
 
-  inline event_id add_recurrent_event(
-      const std::function<void()>& fct, std::size_t tick_count, std::size_t init_tick_count) {
-    return (event_id)_event_stack.add(fct, tick_count, init_tick_count, true);
+  /// Called after (tick_count - init_tick_count) ticks and then every tick_count ticks.
+  inline event_id add_recurrent_event(const callback_type& fct, std::size_t tick_count, std::size_t init_tick_count) {
+    return add_event(fct, tick_count, init_tick_count, true);
   }
 
   inline event_id add_event(
-      const std::function<void()>& fct, std::size_t tick_count, std::size_t init_tick_count, bool is_recurrent) {
-    return (event_id)_event_stack.add(fct, tick_count, init_tick_count, is_recurrent);
+      const callback_type& fct, std::size_t tick_count, std::size_t init_tick_count, bool is_recurrent) {
+    // The first tick runs right away.
+    const std::size_t first_ticks = init_tick_count < tick_count ? tick_count - init_tick_count - 1 : 0;
+    const duration period = is_recurrent ? duration(_delta_time_ms * (idle_ms_type)std::max<std::size_t>(tick_count, 1))
+                                         : duration::zero();
+    return add_event(fct, _delta_time_ms * (idle_ms_type)first_ticks, period);
   }
 
-  inline bool remove_event(event_id __id) { return _event_stack.remove((std::size_t)__id); }
-
-  inline bool is_connected(event_id __id) const { return _event_stack.is_connected((std::size_t)__id); }
+  //
+  // Time based events.
+  //
+
+  /// Called once after delay, or every period after delay when period is not zero.
+  inline event_id add_event(const callback_type& fct, duration delay, duration period = duration::zero()) {
+    const time_point deadline = clock::now() + delay;
+    const std::uint64_t id = _next_id.fetch_add(1, std::memory_order_relaxed);
+    _pending_events.emplace(pending_event{ deadline, fct, period, id });
+    wake_up(deadline);
+    return (event_id)id;
+  }
 
-private:
-  class event_stack {
-  public:
-    struct event_data {
-      std::function<void()> callback;
-      std::size_t id = 0;
-      std::size_t count;
-      std::size_t counter;
-      bool is_recurrent;
-    };
-
-    //    using vector_type = std::vector<event_data>;
-    using vector_type = fst::stack_fixed_vector<event_data, maximum_events_count>;
-
-    inline std::size_t add(
-        const std::function<void()>& fct, std::size_t tick_count, std::size_t init_tick_count, bool is_recurrent) {
-      fst::scoped_spin_lock lock(_lock);
-      _id_counter++;
-      std::size_t id = _id_counter;
-      _data.push_back({ fct, id, init_tick_count, tick_count, is_recurrent });
-      return id;
-    }
+  inline event_id add_recurrent_event(const callback_type& fct, duration period) {
+    return add_event(fct, period, period);
+  }
 
-    inline bool remove(std::size_t id) {
-      fst::scoped_spin_lock lock(_lock);
-      for (std::size_t i = 0; i < _data.size(); i++) {
-        if (_data[i].id == id) {
-          _data.erase(i);
-          //          _data.erase(_data.begin() + i);
-          return true;
+  /// Once this returns the callback isn't running and won't be called again,
+  /// unless it's called from that same callback.
+  inline bool remove_event(event_id __id) {
+    std::shared_ptr<event_callback> evt;
+    {
+      fst::scoped_unique_spin_lock lock(_lock);
+      auto it = _timers.find((std::uint64_t)__id);
+      if (it != _timers.end()) {
+        const timer_id tid = it->second;
+        _timers.erase(it);
+        evt = _wheel.find(tid)->callback;
+        _wheel.cancel(tid);
+      }
+      else if (is_pending((std::uint64_t)__id)) {
+        // Dropped when the event thread drains it.
+        _removed_pending_ids.push_back((std::uint64_t)__id);
+        return true;
+      }
+      else {
+        // A one shot event that fired but may not have returned yet.
+        auto d_it = std::find_if(_dispatching.begin(), _dispatching.end(),
+            [&](const std::shared_ptr<event_callback>& e) { return e->id == (std::uint64_t)__id; });
+        if (d_it == _dispatching.end()) {
+          return false;
         }
+
+        evt = *d_it;
+        _dispatching.erase(d_it);
       }
 
-      return false;
+      evt->is_removed.store(true, std::memory_order_seq_cst);
     }
 
-    inline bool is_connected(std::size_t __id) const {
-      fst::scoped_spin_lock lock(_lock);
-      for (const event_data& evt_data : _data) {
-        if (evt_data.id == __id) {
-          return true;
-        }
-      }
-
-      return false;
+    if (evt.get() != _current_callback) {
+      evt->wait_until_idle();
     }
 
-    inline void execute() {
-      _lock.lock();
-      for (auto& f : _data) {
-        if (++f.count >= f.counter) {
-          f.callback();
-          f.count = 0;
+    return true;
+  }
 
-          if (!f.is_recurrent) {
-            _ids_to_remove.push_back(f.id);
-          }
+  inline bool is_connected(event_id __id) const {
+    fst::scoped_shared_spin_lock lock(_lock);
+    return _timers.contains((std::uint64_t)__id) || is_pending((std::uint64_t)__id);
+  }
+
+private:
+  // Shared with the dispatch list so the callback outlives a remove_event().
+  struct event_callback {
+    static constexpr std::uint32_t waiting_flag = 0x80000000u;
+
+    inline event_callback(callback_type&& fct, std::uint64_t __id, bool __is_one_shot)
+        : callback(std::move(fct))
+        , id(__id)
+        , is_one_shot(__is_one_shot) {}
+
+    /// Calls the callback unless it was removed, a removed callback is still waited
+    /// for when the running count was incremented before remove_event() saw it.
+    inline void run() {
+      running.fetch_add(1, std::memory_order_seq_cst);
+      if (!is_removed.load(std::memory_order_seq_cst)) {
+        const event_callback* previous = _current_callback;
+        _current_callback = this;
+        callback();
+        _current_callback = previous;
+
+        if (is_one_shot) {
+          // Releases the captures, the event is still reachable until the next execute().
+          callback = nullptr;
+          is_done.store(true, std::memory_order_release);
         }
       }
-      _lock.unlock();
-
-      _lock.lock();
-      if (_ids_to_remove.size()) {
-        std::size_t r_index = 0;
-        for (auto it = _data.begin(); it != _data.end() && r_index < _ids_to_remove.size();) {
-          if (it->id == _ids_to_remove[r_index]) {
-            _data.erase(it);
-            r_index++;
-          }
-          else {
-            ++it;
-          }
-        }
 
-        _ids_to_remove.clear();
+      if (running.fetch_sub(1, std::memory_order_release) == (waiting_flag | 1)) {
+        spin_lock_detail::wake_all(running);
       }
-      _lock.unlock();
     }
 
-    inline void clear() {
-      fst::scoped_spin_lock lock(_lock);
-      _data.clear();
+    inline void wait_until_idle() noexcept {
+      std::uint32_t state = running.fetch_or(waiting_flag, std::memory_order_seq_cst) | waiting_flag;
+      while (state != waiting_flag) {
+        spin_lock_detail::wait(running, state);
+        state = running.load(std::memory_order_acquire);
+      }
     }
 
-  private:
-    vector_type _data;
-    fst::unordered_array<std::size_t, maximum_events_count> _ids_to_remove;
-    mutable fst::spin_lock_mutex _lock;
-    std::size_t _id_counter = 0;
+    callback_type callback;
+    const std::uint64_t id;
+    const bool is_one_shot;
+    std::atomic<bool> is_removed = false;
+    std::atomic<bool> is_done = false;
+    // Calls in progress, with waiting_flag set once remove_event() waits on it.
+    std::atomic<std::uint32_t> running = 0;
   };
 
-  class thread_stopper {
-  public:
-    inline thread_stopper() noexcept { _stopper.test_and_set(); }
-    inline ~thread_stopper() { stop(); }
-
-    thread_stopper(const thread_stopper&) = delete;
-    thread_stopper(thread_stopper&&) = delete;
-    thread_stopper& operator=(const thread_stopper&) = delete;
-    thread_stopper& operator=(thread_stopper&&) = delete;
-
-    inline explicit operator bool() {
-      // Atomically changes the state of a std::atomic_flag to set(true)
-      // and returns the value it held before.
-      return _stopper.test_and_set();
-    }
-
-    inline void start() { _stopper.test_and_set(); }
-    inline void stop() { _stopper.clear(); }
+  struct event_data {
+    std::shared_ptr<event_callback> callback;
+    duration period;
+    std::uint64_t id;
+  };
 
-  private:
-    std::atomic_flag _stopper = ATOMIC_FLAG_INIT;
+  // The shared event_callback is only made by the event thread so that posting doesn't allocate.
+  struct pending_event {
+    time_point deadline;
+    callback_type callback;
+    duration period;
+    std::uint64_t id;
   };
 
+  static constexpr duration maximum_sleep_time = std::chrono::hours(1);
+
+  using wheel_type = fst::timer_wheel<event_data>;
+  using timer_id = typename wheel_type::timer_id;
+
   inline void stop() {
-    _stopper.stop();
+    _is_running.store(false, std::memory_order_relaxed);
+    notify();
 
     if (_idle_thread.joinable()) {
       _idle_thread.join();
     }
+
+    // Runs the callbacks already given to the workers.
+    _owned_workers.reset();
+    _workers = nullptr;
+  }
+
+  inline void start() {
+    _is_running.store(true, std::memory_order_relaxed);
+    _idle_thread = std::thread(&event_manager::idle_thread, std::ref(*this));
+  }
+
+  /// Wakes the idle thread if it's parked and deadline comes before the time it's sleeping until.
+  inline void wake_up(time_point deadline) {
+    // Pairs with the fence in idle_thread(): either the event thread sees the
+    // event that was just pushed or we see the deadline it goes to sleep until.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (deadline.time_since_epoch().count() < _sleep_until.load(std::memory_order_relaxed)) {
+      notify();
+    }
+  }
+
+  inline void notify() {
+    _wake_sequence.fetch_add(1, std::memory_order_release);
+    spin_lock_detail::wake_one(_wake_sequence);
+  }
+
+  /// Sleeps until deadline unless notify() was called since sequence was read.
+  inline void sleep(std::uint32_t sequence, time_point deadline) {
+    // Some implementations overflow when waiting until time_point::max().
+    const time_point wait_deadline = deadline == time_point::max() ? clock::now() + maximum_sleep_time : deadline;
+
+    // The waits can return early, spuriously or after a millisecond where there's no native wait.
+    for (time_point now = clock::now();
+         now < wait_deadline && _wake_sequence.load(std::memory_order_acquire) == sequence; now = clock::now()) {
+      spin_lock_detail::wait_for(_wake_sequence, sequence, wait_deadline - now);
+    }
+  }
+
+  /// An id that was handed out but hasn't been drained from the queue yet.
+  inline bool is_pending(std::uint64_t id) const {
+    return id < _next_id.load(std::memory_order_relaxed) && id >= _drained_id_end
+        && std::find(_drained_ids.begin(), _drained_ids.end(), id) == _drained_ids.end()
+        && std::find(_removed_pending_ids.begin(), _removed_pending_ids.end(), id) == _removed_pending_ids.end();
+  }
+
+  /// Moves the queued events to the wheel, called with the lock held.
+  inline void drain_pending_events() {
+    pending_event evt;
+    while (_pending_events.try_pop(evt)) {
+      const std::uint64_t id = evt.id;
+
+      // Producers race for the queue, ids don't come out in order.
+      if (id == _drained_id_end) {
+        _drained_id_end++;
+        for (auto it = std::find(_drained_ids.begin(), _drained_ids.end(), _drained_id_end); it != _drained_ids.end();
+             it = std::find(_drained_ids.begin(), _drained_ids.end(), _drained_id_end)) {
+          _drained_ids.erase(it);
+          _drained_id_end++;
+        }
+      }
+      else {
+        _drained_ids.push_back(id);
+      }
+
+      auto removed_it = std::find(_removed_pending_ids.begin(), _removed_pending_ids.end(), id);
+      if (removed_it != _removed_pending_ids.end()) {
+        _removed_pending_ids.erase(removed_it);
+        continue;
+      }
+
+      const bool is_one_shot = evt.period == duration::zero();
+      _timers.insert({ id,
+          _wheel.insert(evt.deadline,
+              event_data{ std::make_shared<event_callback>(std::move(evt.callback), id, is_one_shot), evt.period,
+                  id }) });
+    }
+  }
+
+  inline time_point execute() {
+    time_point next_deadline;
+    {
+      fst::scoped_unique_spin_lock lock(_lock);
+      drain_pending_events();
+
+      _dispatching.erase(std::remove_if(_dispatching.begin(), _dispatching.end(),
+                             [](const std::shared_ptr<event_callback>& evt) {
+                               return evt->is_done.load(std::memory_order_acquire);
+                             }),
+          _dispatching.end());
+
+      const time_point now = clock::now();
+      _wheel.advance(now, [&](timer_id id, event_data& evt) {
+        _due_callbacks.push_back(evt.callback);
+
+        if (evt.period != duration::zero()) {
+          // Keeps the period without drifting unless the callback is late by more than a period.
+          _wheel.reschedule(id, std::max(_wheel.deadline(id) + evt.period, now));
+        }
+        else {
+          // Kept until it returns so that remove_event() can wait for it.
+          _timers.erase(evt.id);
+          _dispatching.push_back(evt.callback);
+        }
+      });
+
+      next_deadline = _wheel.next_deadline();
+    }
+
+    for (std::shared_ptr<event_callback>& evt : _due_callbacks) {
+      if (_workers) {
+        _workers->push([evt = std::move(evt)]() { evt->run(); });
+      }
+      else {
+        evt->run();
+      }
+    }
+
+    _due_callbacks.clear();
+    return next_deadline;
   }
 
   static int idle_thread(event_manager& em) {
-    while (em._stopper) {
-      em._event_stack.execute();
-      std::this_thread::sleep_for(em._delta_time_ms);
+    while (em._is_running.load(std::memory_order_relaxed)) {
+      // Awake, producers don't notify().
+      em._sleep_until.store(awake, std::memory_order_relaxed);
+
+      const time_point next_deadline = em.execute();
+      em._sleep_until.store(next_deadline.time_since_epoch().count(), std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      const std::uint32_t sequence = em._wake_sequence.load(std::memory_order_acquire);
+
+      // An event pushed while we were awake, or stop(), is seen here. Otherwise its
+      // producer sees the deadline published above and notifies if it's earlier.
+      if (!em._pending_events.empty() || !em._is_running.load(std::memory_order_relaxed)) {
+        continue;
+      }
+
+      em.sleep(sequence, next_deadline);
     }
 
     return 0;
   }
 
-  event_stack _event_stack;
-  thread_stopper _stopper;
+  wheel_type _wheel;
+  fst::flat_map<std::uint64_t, timer_id> _timers;
+  // Queries only take a shared lock, a waiting writer still gets in before new readers.
+  mutable fst::rw_spin_lock _lock;
+  std::vector<std::shared_ptr<event_callback>> _due_callbacks;
+  // One shot events that fired, until their callback returns, guarded by _lock.
+  std::vector<std::shared_ptr<event_callback>> _dispatching;
+  std::unique_ptr<fst::thread_pool> _owned_workers;
+  fst::thread_pool* _workers = nullptr;
+
+  // Events added since the last drain.
+  fst::mpsc_queue<pending_event> _pending_events;
+  std::atomic<std::uint64_t> _next_id = 0;
+  // Ids below _drained_id_end and the ones in _drained_ids have left the queue, guarded by _lock.
+  std::uint64_t _drained_id_end = 0;
+  std::vector<std::uint64_t> _drained_ids;
+  std::vector<std::uint64_t> _removed_pending_ids;
+
+  // Lower than any deadline, so that wake_up() doesn't notify while the thread is awake.
+  static constexpr duration::rep awake = std::numeric_limits<duration::rep>::min();
+  std::atomic<duration::rep> _sleep_until = awake;
+  std::atomic<std::uint32_t> _wake_sequence = 0;
+  std::atomic<bool> _is_running = false;
+
   std::thread _idle_thread;
-  std::chrono::milliseconds _delta_time_ms;
+  std::chrono::milliseconds _delta_time_ms = std::chrono::milliseconds(default_idle_ms);
+
+  // The callback running on this thread, so remove_event() doesn't wait for itself.
+  static inline thread_local const event_callback* _current_callback = nullptr;
 };
 } // namespace fst.
@@ -33,14 +33,30 @@
 
 #pragma once
 #include "fst/assert.h"
+#include "fst/bitset.h"
 #include "fst/spin_lock.h"
 #include "fst/unordered_array.h"
 #include "fst/enum_array.h"
 #include <array>
 #include <atomic>
+#include <cstdint>
 #include <initializer_list>
+#include <type_traits>
 
 namespace fst {
+namespace unordered_set_detail {
+  /// Smallest unsigned type that can hold an index in [0, _Size).
+  template <std::size_t _Size>
+  using index_type = std::conditional_t<(_Size <= 256), std::uint8_t,
+      std::conditional_t<(_Size <= 65536), std::uint16_t,
+          std::conditional_t<(_Size <= 4294967296ull), std::uint32_t, std::size_t>>>;
+} // namespace unordered_set_detail.
+
+/// Sparse set of integers in [0, maximum_size).
+///
+/// The values are kept in a dense unordered array and a bitset tracks membership.
+/// The sparse index array holds the position of each value in the dense array so erase() is O(1).
+/// clear() only touches the bits of the contained values.
 template <typename _T, std::size_t _Size>
 class fixed_unordered_set {
 public:
@@ -54,61 +70,146 @@ public:
   static constexpr size_type maximum_size = _Size;
 
   using array_type = unordered_array<value_type, maximum_size>;
+  using bitset_type = fixed_bitset<maximum_size>;
 
   static_assert(std::is_integral<value_type>::value, "Integral type required.");
 
-  fixed_unordered_set() { _is_in_array.fill(false); }
+  fixed_unordered_set() noexcept = default;
+
+  inline fixed_unordered_set(std::initializer_list<value_type> values) noexcept {
+    for (value_type v : values) {
+      insert(v);
+    }
+  }
 
   inline void insert(value_type value) {
-    fst_assert(value < maximum_size, "fixed_unordered_set::insert Out of bound value.");
-    if (_is_in_array[value]) {
+    fst_assert((size_type)value < maximum_size, "fixed_unordered_set::insert Out of bound value.");
+    if (_bits.test((size_type)value)) {
       return;
     }
 
+    _index[(size_type)value] = (index_type)_array.size();
     _array.push_back(value);
-    _is_in_array[value] = true;
+    _bits.set((size_type)value);
   }
 
   inline void erase(value_type value) {
-    fst_assert(value < maximum_size, "fixed_unordered_set::erase Out of bound value.");
-    if (!_is_in_array[value]) {
+    fst_assert((size_type)value < maximum_size, "fixed_unordered_set::erase Out of bound value.");
+    if (!_bits.test((size_type)value)) {
       return;
     }
 
-    _is_in_array[value] = false;
-    _array.erase_first_if([value](value_type v) { return v == value; });
+    _bits.reset((size_type)value);
+
+    // The last value takes the place of the erased one.
+    const size_type index = _index[(size_type)value];
+    _array.erase(index);
+    if (index < _array.size()) {
+      _index[(size_type)_array[index]] = (index_type)index;
+    }
+  }
+
+  /// Erases all the values satisfying pred while compacting the dense array in a single pass.
+  template <class _Predicate>
+  inline void erase_if(_Predicate pred) {
+    size_type count = 0;
+    for (size_type i = 0; i < _array.size(); i++) {
+      const value_type v = _array[i];
+      if (pred(v)) {
+        _bits.reset((size_type)v);
+      }
+      else {
+        _index[(size_type)v] = (index_type)count;
+        _array[count++] = v;
+      }
+    }
+
+    while (_array.size() > count) {
+      _array.pop_back();
+    }
   }
 
   inline bool contains(value_type value) const noexcept {
-    fst_assert(value < maximum_size, "fixed_unordered_set::contains Out of bound value.");
-    return _is_in_array[value];
+    fst_assert((size_type)value < maximum_size, "fixed_unordered_set::contains Out of bound value.");
+    return _bits.test((size_type)value);
   }
 
   inline void clear() noexcept {
-    _is_in_array.fill(false);
+    if (_array.size() > bitset_type::word_count) {
+      _bits.reset();
+    }
+    else {
+      for (value_type v : _array) {
+        _bits.reset((size_type)v);
+      }
+    }
+
     _array.clear();
   }
 
+  //
+  // Set algebra.
+  //
+
+  /// Union.
+  inline void insert(const fixed_unordered_set& s) {
+    for (value_type v : s) {
+      insert(v);
+    }
+  }
+
+  /// Keeps the values that are also in s.
+  inline void intersect(const fixed_unordered_set& s) {
+    erase_if([&s](value_type v) { return !s.contains(v); });
+  }
+
+  /// Removes the values of s.
+  inline void subtract(const fixed_unordered_set& s) {
+    if (s.size() < size()) {
+      for (value_type v : s) {
+        erase(v);
+      }
+    }
+    else {
+      erase_if([&s](value_type v) { return s.contains(v); });
+    }
+  }
+
+  /// Number of values in both sets, computed with popcount on the bitsets.
+  inline size_type intersection_size(const fixed_unordered_set& s) const noexcept {
+    return _bits.intersection_count(s._bits);
+  }
+
+  inline bool intersects(const fixed_unordered_set& s) const noexcept { return _bits.intersects(s._bits); }
+  inline bool is_subset_of(const fixed_unordered_set& s) const noexcept { return _bits.is_subset_of(s._bits); }
+
+  inline bool operator==(const fixed_unordered_set& s) const noexcept { return size() == s.size() && _bits == s._bits; }
+  inline bool operator!=(const fixed_unordered_set& s) const noexcept { return !operator==(s); }
+
   inline array_type get_and_clear() {
     array_type content = _array;
     clear();
     return content;
   }
 
-  inline const array_type& content() const {
-    return _array;
-  }
+  inline const array_type& content() const { return _array; }
+  inline const bitset_type& bits() const noexcept { return _bits; }
 
   inline const_reference operator[](size_type index) const { return _array[index]; }
 
-  inline const_iterator begin() const noexcept { return _array.begin(); }
-  inline const_iterator end() const noexcept { return _array.end(); }
+  inline const_iterator begin() const noexcept { return _array.data(); }
+  inline const_iterator end() const noexcept { return _array.data() + _array.size(); }
   inline size_type size() const noexcept { return _array.size(); }
   inline bool empty() const noexcept { return _array.empty(); }
 
 private:
+  using index_type = unordered_set_detail::index_type<maximum_size>;
+
   array_type _array;
-  std::array<bool, maximum_size> _is_in_array;
+  bitset_type _bits;
+
+  // Only the entries of the contained values are meaningful.
+  std::array<index_type, maximum_size> _index;
 };
 
 template <class _T, class Enum, std::size_t _Size = std::size_t(Enum::count)>
@@ -124,67 +225,38 @@ public:
   using difference_type = std::ptrdiff_t;
   static constexpr size_type maximum_size = _Size;
 
-  using array_type = unordered_array<value_type, maximum_size>;
+  using set_type = fixed_unordered_set<value_type, maximum_size>;
+  using array_type = typename set_type::array_type;
 
   static_assert(std::is_integral<value_type>::value, "Integral type required.");
 
-  enum_unordered_set() { _is_in_array.fill(false); }
-
-  inline void insert(value_type value) {
-    fst_assert(value < maximum_size, "fixed_unordered_set::insert Out of bound value.");
-    if (_is_in_array[value]) {
-      return;
-    }
-
-    _array.push_back(value);
-    _is_in_array[value] = true;
-  }
+  enum_unordered_set() noexcept = default;
 
+  inline void insert(value_type value) { _set.insert(value); }
   inline void insert(enum_type e) { insert((std::size_t)e); }
 
-  inline void erase(value_type value) {
-    fst_assert(value < maximum_size, "fixed_unordered_set::erase Out of bound value.");
-    if (!_is_in_array[value]) {
-      return;
-    }
-
-    _is_in_array[value] = false;
-    _array.erase_first_if([value](value_type v) { return v == value; });
-  }
-
+  inline void erase(value_type value) { _set.erase(value); }
   inline void erase(enum_type e) { erase((std::size_t)e); }
 
-  inline bool contains(value_type value) const noexcept {
-    fst_assert(value < maximum_size, "fixed_unordered_set::contains Out of bound value.");
-    return _is_in_array[value];
-  }
-
+  inline bool contains(value_type value) const noexcept { return _set.contains(value); }
   inline bool contains(enum_type e) const noexcept { return contains((std::size_t)e); }
 
-  inline void clear() noexcept {
-    _is_in_array.fill(false);
-    _array.clear();
-  }
+  inline void clear() noexcept { _set.clear(); }
 
-  inline array_type get_and_clear() {
-    array_type content = _array;
-    clear();
-    return content;
-  }
+  inline array_type get_and_clear() { return _set.get_and_clear(); }
 
-  inline const array_type& content() const { return _array; }
+  inline const array_type& content() const { return _set.content(); }
 
-  inline const_reference operator[](enum_type e) noexcept { return _array[(std::size_t)e]; }
-  inline const_reference operator[](size_type index) const { return _array[index]; }
+  inline const_reference operator[](enum_type e) noexcept { return _set[(std::size_t)e]; }
+  inline const_reference operator[](size_type index) const { return _set[index]; }
 
-  inline const_iterator begin() const noexcept { return _array.begin(); }
-  inline const_iterator end() const noexcept { return _array.end(); }
-  inline size_type size() const noexcept { return _array.size(); }
-  inline bool empty() const noexcept { return _array.empty(); }
+  inline const_iterator begin() const noexcept { return _set.begin(); }
+  inline const_iterator end() const noexcept { return _set.end(); }
+  inline size_type size() const noexcept { return _set.size(); }
+  inline bool empty() const noexcept { return _set.empty(); }
 
 private:
-  array_type _array;
-  std::array<bool, maximum_size> _is_in_array;
+  set_type _set;
 };
 
 template <typename _T, std::size_t _Size>
@@ -198,77 +270,55 @@ public:
   using difference_type = std::ptrdiff_t;
   static constexpr size_type maximum_size = _Size;
 
-  using array_type = unordered_array<value_type, maximum_size>;
+  using set_type = fixed_unordered_set<value_type, maximum_size>;
+  using array_type = typename set_type::array_type;
 
   static_assert(std::is_integral<value_type>::value, "Integral type required.");
 
-  inline lock_free_fixed_unordered_set() { _is_in_array.fill(false); }
+  lock_free_fixed_unordered_set() noexcept = default;
 
   inline void insert(value_type value) {
-    fst_assert(value < maximum_size, "lock_free_fixed_unordered_set::insert Out of bound value.");
-
     scoped_spin_lock lock(_mutex);
-    if (_is_in_array[value]) {
-      return;
-    }
-
-    _array.push_back(value);
-    _is_in_array[value] = true;
+    _set.insert(value);
   }
 
   inline void erase(value_type value) {
-    fst_assert(value < maximum_size, "lock_free_fixed_unordered_set::erase Out of bound value.");
-
     scoped_spin_lock lock(_mutex);
-    if (!_is_in_array[value]) {
-      return;
-    }
-
-    _is_in_array[value] = false;
-    _array.erase_first_if([value](value_type v) { return v == value; });
+    _set.erase(value);
   }
 
   inline bool contains(value_type value) const {
-    fst_assert(value < maximum_size, "lock_free_fixed_unordered_set::contains Out of bound value.");
-
     scoped_spin_lock lock(_mutex);
-    return _is_in_array[value];
+    return _set.contains(value);
   }
 
   inline void clear() noexcept {
     scoped_spin_lock lock(_mutex);
-    _is_in_array.fill(false);
-    _array.clear();
+    _set.clear();
   }
 
   inline array_type get_content_and_clear() noexcept {
     scoped_spin_lock lock(_mutex);
-    array_type content = _array;
-
-    // Can't call clear() here to prevent dead lock.
-    _is_in_array.fill(false);
-    _array.clear();
-    return content;
+    return _set.get_and_clear();
   }
 
   inline array_type get_content() const noexcept {
     scoped_spin_lock lock(_mutex);
-    return _array;
+    return _set.content();
   }
 
   inline size_type size() const noexcept {
     scoped_spin_lock lock(_mutex);
-    return _array.size();
+    return _set.size();
   }
 
   inline bool empty() const noexcept {
     scoped_spin_lock lock(_mutex);
-    return _array.empty();
+    return _set.empty();
   }
 
 private:
-  array_type _array;
-  std::array<bool, maximum_size> _is_in_array;
+  set_type _set;
   mutable spin_lock_mutex _mutex;
 };
 } // namespace fst.
@@ -35,6 +35,8 @@
 #include "fst/assert.h"
 #include "fst/traits.h"
 #include "fst/aligned_buffer.h"
+#include "fst/span.h"
+#include "fst/util.h"
 
 #include <cstddef>
 #include <cstring>
@@ -42,6 +44,7 @@
 #include <utility>
 #include <iterator>
 #include <algorithm>
+#include <initializer_list>
 #include <stdexcept>
 
 namespace fst {
@@ -97,6 +100,11 @@ private:
   template <bool _Dummy, class _D = dependent_type_condition<_Dummy, is_not_heap_buffer_condition>>
   using enable_if_is_not_heap_buffer = enable_if_same<_Dummy, _D>;
 
+  // Keeps insert(pos, count, value) from matching the iterator range overloads.
+  template <class _InputIt>
+  using enable_if_forward_iterator = std::enable_if_t<std::is_base_of<std::forward_iterator_tag,
+      typename std::iterator_traits<_InputIt>::iterator_category>::value>;
+
 public:
   fixed_vector() = default;
 
@@ -349,7 +357,10 @@ public:
       return;
     }
 
-    if constexpr (!is_trivial) {
+    if constexpr (is_trivial) {
+      std::fill(data() + _size, data() + size, value);
+    }
+    else {
       for (size_type i = _size; i < size; i++) {
         new (&_data[i]) value_type(value);
       }
@@ -363,22 +374,153 @@ public:
       return;
     }
 
-    if (_size == 0) {
-      return;
+    erase_range(index, 1);
+  }
+
+  void erase(iterator it) { erase((size_type)std::distance(begin(), it)); }
+
+  /// Erases [first, last) and returns the iterator following the last removed element.
+  iterator erase(iterator first, iterator last) {
+    fst_assert(first >= begin() && first <= last && last <= end(), "fixed_vector::erase invalid range");
+    const size_type index = (size_type)std::distance(begin(), first);
+    erase_range(index, (size_type)std::distance(first, last));
+    return begin() + index;
+  }
+
+  /// Removes all the elements satisfying pred in a single pass and returns the number of removed elements.
+  template <class _Predicate>
+  size_type erase_if(_Predicate pred) {
+    iterator it = std::remove_if(begin(), end(), pred);
+    const size_type count = (size_type)std::distance(it, end());
+    destroy_range((size_type)std::distance(begin(), it), _size);
+    _size -= count;
+    return count;
+  }
+
+  template <bool _Dummy = true, class = enable_if_is_copy_constructible<_Dummy>>
+  iterator insert(iterator pos, const_reference value) {
+    // The value could be an element of this vector.
+    const value_type tmp = value;
+    return insert(pos, &tmp, &tmp + 1);
+  }
+
+  template <bool _Dummy = true, class = enable_if_is_move_constructible_and_not_fundamental<_Dummy>>
+  iterator insert(iterator pos, value_type&& value) {
+    const size_type index = (size_type)std::distance(begin(), pos);
+    fst_assert(index <= _size, "fixed_vector::insert position out of bounds");
+    fst_assert(_size < maximum_size, "Out of bounds insert");
+
+    if (index == _size) {
+      push_back(std::move(value));
+      return begin() + index;
     }
 
-    for (size_type i = index; i < _size - 1; i++) {
-      _data[i] = std::move(_data[i + 1]);
+    if constexpr (is_trivial) {
+      std::memmove(data() + index + 1, data() + index, (_size - index) * sizeof(value_type));
+      _data[index] = std::move(value);
+    }
+    else {
+      new (&_data[_size]) value_type(std::move(_data[_size - 1]));
+      std::move_backward(data() + index, data() + _size - 1, data() + _size);
+      _data[index] = std::move(value);
     }
 
-    if constexpr (!std::is_trivially_destructible<value_type>::value) {
-      _data[_size - 1].~value_type();
+    _size++;
+    return begin() + index;
+  }
+
+  template <bool _Dummy = true, class = enable_if_is_copy_constructible<_Dummy>>
+  iterator insert(iterator pos, size_type count, const_reference value) {
+    const size_type index = (size_type)std::distance(begin(), pos);
+    const value_type tmp = value;
+    value_type* dst = make_gap(index, count);
+
+    if constexpr (is_trivial) {
+      std::fill_n(dst, count, tmp);
+    }
+    else {
+      // The first elements of the gap may still hold moved-from objects.
+      const size_type constructed = fst::minimum(count, _size - index);
+      std::fill_n(dst, constructed, tmp);
+      std::uninitialized_fill_n(dst + constructed, count - constructed, tmp);
     }
 
-    _size--;
+    _size += count;
+    return begin() + index;
   }
 
-  void erase(iterator it) { erase((size_type)std::distance(begin(), it)); }
+  /// Inserts the forward iterator range [first, last) before pos.
+  template <class _InputIt, class = enable_if_forward_iterator<_InputIt>>
+  iterator insert(iterator pos, _InputIt first, _InputIt last) {
+    const size_type index = (size_type)std::distance(begin(), pos);
+    const size_type count = (size_type)std::distance(first, last);
+    value_type* dst = make_gap(index, count);
+
+    if constexpr (is_trivial) {
+      std::copy(first, last, dst);
+    }
+    else {
+      const size_type constructed = fst::minimum(count, _size - index);
+      _InputIt mid = std::next(first, (difference_type)constructed);
+      std::copy(first, mid, dst);
+      std::uninitialized_copy(mid, last, dst + constructed);
+    }
+
+    _size += count;
+    return begin() + index;
+  }
+
+  template <bool _Dummy = true, class = enable_if_is_copy_constructible<_Dummy>>
+  iterator insert(iterator pos, std::initializer_list<value_type> ilist) {
+    return insert(pos, ilist.begin(), ilist.end());
+  }
+
+  template <bool _Dummy = true, class = enable_if_is_copy_constructible<_Dummy>>
+  void append(fst::span<const value_type> values) {
+    insert(end(), values.begin(), values.end());
+  }
+
+  template <class _InputIt, class = enable_if_forward_iterator<_InputIt>>
+  void assign(_InputIt first, _InputIt last) {
+    const size_type count = (size_type)std::distance(first, last);
+    fst_assert(count <= maximum_size, "Out of bounds assign");
+
+    if constexpr (is_trivial) {
+      std::copy(first, last, data());
+    }
+    else {
+      // Copy assign over the existing elements, construct or destroy the rest.
+      const size_type assigned = fst::minimum(count, _size);
+      _InputIt mid = std::next(first, (difference_type)assigned);
+      std::copy(first, mid, data());
+      std::uninitialized_copy(mid, last, data() + assigned);
+      destroy_range(count, _size);
+    }
+
+    _size = count;
+  }
+
+  template <bool _Dummy = true, class = enable_if_is_copy_constructible<_Dummy>>
+  void assign(size_type count, const_reference value) {
+    fst_assert(count <= maximum_size, "Out of bounds assign");
+
+    if constexpr (is_trivial) {
+      std::fill_n(data(), count, value);
+    }
+    else {
+      const size_type assigned = fst::minimum(count, _size);
+      std::fill_n(data(), assigned, value);
+      std::uninitialized_fill_n(data() + assigned, count - assigned, value);
+      destroy_range(count, _size);
+    }
+
+    _size = count;
+  }
+
+  template <bool _Dummy = true, class = enable_if_is_copy_constructible<_Dummy>>
+  void assign(std::initializer_list<value_type> ilist) {
+    assign(ilist.begin(), ilist.end());
+  }
 
   inline void unordered_erase(size_type index) {
     if (index >= _size) {
@@ -421,6 +563,55 @@ public:
 private:
   buffer_type _data;
   size_type _size = 0;
+
+  inline void destroy_range(size_type first, size_type last) noexcept {
+    if constexpr (!std::is_trivially_destructible<value_type>::value) {
+      for (size_type i = first; i < last; i++) {
+        _data[i].~value_type();
+      }
+    }
+  }
+
+  // Shifts the elements after index + count to index.
+  inline void erase_range(size_type index, size_type count) {
+    if (count == 0) {
+      return;
+    }
+
+    if constexpr (is_trivial) {
+      std::memmove(data() + index, data() + index + count, (_size - index - count) * sizeof(value_type));
+    }
+    else {
+      std::move(data() + index + count, data() + _size, data() + index);
+      destroy_range(_size - count, _size);
+    }
+
+    _size -= count;
+  }
+
+  // Opens a gap of count elements at index and returns a pointer to it, _size is left unchanged.
+  // For non trivial types, the elements moved past the end are move constructed and the
+  // ones moved inside the constructed range are move assigned.
+  inline value_type* make_gap(size_type index, size_type count) {
+    fst_assert(index <= _size, "fixed_vector::insert position out of bounds");
+    fst_assert(_size + count <= maximum_size, "Out of bounds insert");
+
+    const size_type tail = _size - index;
+    if constexpr (is_trivial) {
+      std::memmove(data() + index + count, data() + index, tail * sizeof(value_type));
+    }
+    else {
+      if (count <= tail) {
+        std::uninitialized_move(data() + _size - count, data() + _size, data() + _size);
+        std::move_backward(data() + index, data() + _size - count, data() + _size);
+      }
+      else {
+        std::uninitialized_move(data() + index, data() + _size, data() + index + count);
+      }
+    }
+
+    return data() + index;
+  }
 };
 
 template <typename _Tp, std::size_t _Size>
@@ -0,0 +1,633 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+#pragma once
+#include "fst/common.h"
+#include "fst/assert.h"
+#include "fst/hash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// clang-format off
+#if __FST_SSE2__
+  #include <emmintrin.h>
+#endif
+
+#if __FST_MSVC__
+  #include <intrin.h>
+#endif
+// clang-format on
+
+// Open addressing hash map in the style of abseil's Swiss tables.
+// https://abseil.io/about/design/swisstables
+//
+// Each slot has a control byte, either empty, deleted or the 7 lower bits of the key hash.
+// Lookups probe groups of 16 control bytes at once and only compare the keys whose 7 bits match.
+
+namespace fst {
+namespace flat_map_detail {
+  using ctrl_t = std::int8_t;
+  inline constexpr ctrl_t ctrl_empty = -128;
+  inline constexpr ctrl_t ctrl_deleted = -2;
+  inline constexpr std::size_t group_size = 16;
+
+  inline std::uint32_t first_bit_index(std::uint32_t mask) noexcept {
+#if __FST_MSVC__
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (std::uint32_t)index;
+#else
+    return (std::uint32_t)__builtin_ctz(mask);
+#endif
+  }
+
+  /// Bit masks of the matching control bytes in a group of 16 slots.
+  class group {
+  public:
+#if __FST_SSE2__
+    inline explicit group(const ctrl_t* ctrl) noexcept
+        : _ctrl(_mm_loadu_si128((const __m128i*)ctrl)) {}
+
+    inline std::uint32_t match(ctrl_t h2) const noexcept {
+      return (std::uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_ctrl, _mm_set1_epi8(h2)));
+    }
+
+    inline std::uint32_t match_empty() const noexcept {
+      return (std::uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_ctrl, _mm_set1_epi8(ctrl_empty)));
+    }
+
+    // Empty and deleted are the only negative values.
+    inline std::uint32_t match_empty_or_deleted() const noexcept {
+      return (std::uint32_t)_mm_movemask_epi8(_ctrl);
+    }
+
+  private:
+    __m128i _ctrl;
+
+#else
+    inline explicit group(const ctrl_t* ctrl) noexcept
+        : _ctrl(ctrl) {}
+
+    inline std::uint32_t match(ctrl_t h2) const noexcept {
+      std::uint32_t mask = 0;
+      for (std::size_t i = 0; i < group_size; i++) {
+        mask |= (std::uint32_t)(_ctrl[i] == h2) << i;
+      }
+      return mask;
+    }
+
+    inline std::uint32_t match_empty() const noexcept { return match(ctrl_empty); }
+
+    inline std::uint32_t match_empty_or_deleted() const noexcept {
+      std::uint32_t mask = 0;
+      for (std::size_t i = 0; i < group_size; i++) {
+        mask |= (std::uint32_t)(_ctrl[i] < 0) << i;
+      }
+      return mask;
+    }
+
+  private:
+    const ctrl_t* _ctrl;
+#endif
+  };
+
+  template <typename _Tp, typename = void>
+  struct is_transparent : std::false_type {};
+
+  template <typename _Tp>
+  struct is_transparent<_Tp, std::void_t<typename _Tp::is_transparent>> : std::true_type {};
+
+  // The member alias resolves before deduction so the lookup key type can be deduced.
+  template <bool _IsTransparent>
+  struct key_arg {
+    template <class _K, class _Key>
+    using type = _Key;
+  };
+
+  template <>
+  struct key_arg<true> {
+    template <class _K, class _Key>
+    using type = _K;
+  };
+} // namespace flat_map_detail.
+
+template <class _Key, class _Value, class _Hash = fst::hash<_Key>, class _KeyEqual = std::equal_to<>>
+class flat_map {
+  template <bool _IsConst>
+  class iterator_base;
+
+public:
+  using key_type = _Key;
+  using mapped_type = _Value;
+  using value_type = std::pair<const _Key, _Value>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using hasher = _Hash;
+  using key_equal = _KeyEqual;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+  using iterator = iterator_base<false>;
+  using const_iterator = iterator_base<true>;
+
+  /// Lookups accept any type the hasher and key_equal accept when both are transparent.
+  static constexpr bool is_transparent
+      = flat_map_detail::is_transparent<_Hash>::value && flat_map_detail::is_transparent<_KeyEqual>::value;
+
+  template <class _K>
+  using key_arg = typename flat_map_detail::key_arg<is_transparent>::template type<_K, key_type>;
+
+  flat_map() noexcept = default;
+
+  inline flat_map(std::initializer_list<value_type> ilist) {
+    reserve(ilist.size());
+    for (const value_type& v : ilist) {
+      insert(v);
+    }
+  }
+
+  inline flat_map(const flat_map& m)
+      : _hash(m._hash)
+      , _equal(m._equal) {
+    reserve(m.size());
+    for (const value_type& v : m) {
+      insert(v);
+    }
+  }
+
+  inline flat_map(flat_map&& m) noexcept
+      : _ctrl(m._ctrl)
+      , _slots(m._slots)
+      , _capacity(m._capacity)
+      , _size(m._size)
+      , _growth_left(m._growth_left)
+      , _hash(std::move(m._hash))
+      , _equal(std::move(m._equal)) {
+    m.reset();
+  }
+
+  inline ~flat_map() { destroy(); }
+
+  inline flat_map& operator=(const flat_map& m) {
+    if (this != &m) {
+      flat_map tmp(m);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  inline flat_map& operator=(flat_map&& m) noexcept {
+    if (this != &m) {
+      destroy();
+      _ctrl = m._ctrl;
+      _slots = m._slots;
+      _capacity = m._capacity;
+      _size = m._size;
+      _growth_left = m._growth_left;
+      _hash = std::move(m._hash);
+      _equal = std::move(m._equal);
+      m.reset();
+    }
+    return *this;
+  }
+
+  inline void swap(flat_map& m) noexcept {
+    std::swap(_ctrl, m._ctrl);
+    std::swap(_slots, m._slots);
+    std::swap(_capacity, m._capacity);
+    std::swap(_size, m._size);
+    std::swap(_growth_left, m._growth_left);
+    std::swap(_hash, m._hash);
+    std::swap(_equal, m._equal);
+  }
+
+  //
+  // Capacity.
+  //
+  [[nodiscard]] inline size_type size() const noexcept { return _size; }
+  [[nodiscard]] inline bool empty() const noexcept { return _size == 0; }
+  [[nodiscard]] inline size_type capacity() const noexcept { return _capacity; }
+
+  /// Makes room for count elements without rehashing.
+  inline void reserve(size_type count) {
+    if (count > _size + _growth_left) {
+      rehash(capacity_for(count));
+    }
+  }
+
+  inline void clear() noexcept {
+    if (_capacity) {
+      destroy_slots();
+      std::memset(_ctrl, (std::uint8_t)flat_map_detail::ctrl_empty, _capacity);
+      _size = 0;
+      _growth_left = max_load(_capacity);
+    }
+  }
+
+  //
+  // Iterators.
+  //
+  inline iterator begin() noexcept { return iterator_at(0); }
+  inline const_iterator begin() const noexcept { return iterator_at(0); }
+  inline const_iterator cbegin() const noexcept { return begin(); }
+
+  inline iterator end() noexcept { return iterator(_ctrl + _capacity, _slots + _capacity, _ctrl + _capacity); }
+  inline const_iterator end() const noexcept {
+    return const_iterator(_ctrl + _capacity, _slots + _capacity, _ctrl + _capacity);
+  }
+  inline const_iterator cend() const noexcept { return end(); }
+
+  //
+  // Lookup.
+  //
+  template <class _K = key_type>
+  inline iterator find(const key_arg<_K>& key) noexcept {
+    const size_type index = find_index(key, hash_key(key));
+    return index == npos ? end() : iterator_at(index);
+  }
+
+  template <class _K = key_type>
+  inline const_iterator find(const key_arg<_K>& key) const noexcept {
+    const size_type index = find_index(key, hash_key(key));
+    return index == npos ? end() : iterator_at(index);
+  }
+
+  template <class _K = key_type>
+  inline bool contains(const key_arg<_K>& key) const noexcept {
+    return find_index(key, hash_key(key)) != npos;
+  }
+
+  template <class _K = key_type>
+  inline size_type count(const key_arg<_K>& key) const noexcept {
+    return contains<_K>(key) ? 1 : 0;
+  }
+
+  template <class _K = key_type>
+  inline mapped_type& at(const key_arg<_K>& key) {
+    const size_type index = find_index(key, hash_key(key));
+    if (index == npos) {
+      throw std::out_of_range("flat_map::at");
+    }
+    return _slots[index].second;
+  }
+
+  template <class _K = key_type>
+  inline const mapped_type& at(const key_arg<_K>& key) const {
+    const size_type index = find_index(key, hash_key(key));
+    if (index == npos) {
+      throw std::out_of_range("flat_map::at");
+    }
+    return _slots[index].second;
+  }
+
+  inline mapped_type& operator[](const key_type& key) { return try_emplace(key).first->second; }
+  inline mapped_type& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+  //
+  // Modifiers.
+  //
+  template <class... _Args>
+  inline std::pair<iterator, bool> try_emplace(const key_type& key, _Args&&... args) {
+    return emplace_impl(key, std::forward<_Args>(args)...);
+  }
+
+  template <class... _Args>
+  inline std::pair<iterator, bool> try_emplace(key_type&& key, _Args&&... args) {
+    return emplace_impl(std::move(key), std::forward<_Args>(args)...);
+  }
+
+  template <class _K, class... _Args, class _Dummy = _K,
+      class = std::enable_if_t<std::is_same<_Dummy, _K>::value && is_transparent>>
+  inline std::pair<iterator, bool> try_emplace(const _K& key, _Args&&... args) {
+    return emplace_impl(key, std::forward<_Args>(args)...);
+  }
+
+  inline std::pair<iterator, bool> insert(const value_type& value) { return emplace_impl(value.first, value.second); }
+
+  inline std::pair<iterator, bool> insert(value_type&& value) {
+    return emplace_impl(value.first, std::move(value.second));
+  }
+
+  template <class _M>
+  inline std::pair<iterator, bool> insert_or_assign(const key_type& key, _M&& value) {
+    std::pair<iterator, bool> it = emplace_impl(key, std::forward<_M>(value));
+    if (!it.second) {
+      it.first->second = std::forward<_M>(value);
+    }
+    return it;
+  }
+
+  template <class _K = key_type>
+  inline size_type erase(const key_arg<_K>& key) {
+    const size_type index = find_index(key, hash_key(key));
+    if (index == npos) {
+      return 0;
+    }
+
+    erase_index(index);
+    return 1;
+  }
+
+  /// Returns the iterator following the erased element.
+  inline iterator erase(const_iterator pos) {
+    const size_type index = (size_type)(pos._slot - _slots);
+    fst_assert(index < _capacity && _ctrl[index] >= 0, "flat_map::erase invalid iterator");
+    erase_index(index);
+    return iterator_at(index + 1);
+  }
+
+  inline iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+  inline hasher hash_function() const { return _hash; }
+  inline key_equal key_eq() const { return _equal; }
+
+private:
+  using ctrl_t = flat_map_detail::ctrl_t;
+  static constexpr size_type group_size = flat_map_detail::group_size;
+  static constexpr size_type npos = (size_type)-1;
+  static constexpr size_type alignment = alignof(value_type) > group_size ? alignof(value_type) : group_size;
+
+  ctrl_t* _ctrl = nullptr;
+  value_type* _slots = nullptr;
+  size_type _capacity = 0;
+  size_type _size = 0;
+  size_type _growth_left = 0;
+  hasher _hash;
+  key_equal _equal;
+
+  template <bool _IsConst>
+  class iterator_base {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename flat_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<_IsConst, const value_type*, value_type*>;
+    using reference = std::conditional_t<_IsConst, const value_type&, value_type&>;
+
+    iterator_base() noexcept = default;
+
+    template <bool _C = _IsConst, class = std::enable_if_t<_C>>
+    inline iterator_base(const iterator_base<false>& it) noexcept
+        : _ctrl(it._ctrl)
+        , _slot(it._slot)
+        , _end(it._end) {}
+
+    inline reference operator*() const noexcept { return *_slot; }
+    inline pointer operator->() const noexcept { return _slot; }
+
+    inline iterator_base& operator++() noexcept {
+      ++_ctrl;
+      ++_slot;
+      skip_empty();
+      return *this;
+    }
+
+    inline iterator_base operator++(int) noexcept {
+      iterator_base it = *this;
+      ++(*this);
+      return it;
+    }
+
+    inline bool operator==(const iterator_base& it) const noexcept { return _slot == it._slot; }
+    inline bool operator!=(const iterator_base& it) const noexcept { return _slot != it._slot; }
+
+  private:
+    friend class flat_map;
+    template <bool>
+    friend class iterator_base;
+
+    const ctrl_t* _ctrl = nullptr;
+    value_type* _slot = nullptr;
+    const ctrl_t* _end = nullptr;
+
+    inline iterator_base(const ctrl_t* ctrl, value_type* slot, const ctrl_t* end) noexcept
+        : _ctrl(ctrl)
+        , _slot(slot)
+        , _end(end) {
+      skip_empty();
+    }
+
+    inline void skip_empty() noexcept {
+      while (_ctrl != _end && *_ctrl < 0) {
+        ++_ctrl;
+        ++_slot;
+      }
+    }
+  };
+
+  inline iterator iterator_at(size_type index) noexcept {
+    return iterator(_ctrl + index, _slots + index, _ctrl + _capacity);
+  }
+
+  inline const_iterator iterator_at(size_type index) const noexcept {
+    return const_iterator(_ctrl + index, _slots + index, _ctrl + _capacity);
+  }
+
+  static inline constexpr size_type max_load(size_type cap) noexcept { return cap - cap / 8; }
+
+  static inline size_type capacity_for(size_type count) noexcept {
+    size_type cap = group_size;
+    while (max_load(cap) < count) {
+      cap *= 2;
+    }
+    return cap;
+  }
+
+  template <class _K>
+  inline size_type hash_key(const _K& key) const noexcept {
+    return (size_type)_hash(key);
+  }
+
+  static inline ctrl_t h2(size_type h) noexcept { return (ctrl_t)(h & 0x7F); }
+
+  // Triangular probing over the groups visits every group when the group count is a power of two.
+  template <class _K>
+  inline size_type find_index(const _K& key, size_type h) const noexcept {
+    if (!_capacity) {
+      return npos;
+    }
+
+    const size_type group_mask = _capacity / group_size - 1;
+    size_type g = (h >> 7) & group_mask;
+
+    for (size_type step = 1;; step++) {
+      const flat_map_detail::group grp(_ctrl + g * group_size);
+
+      for (std::uint32_t mask = grp.match(h2(h)); mask; mask &= mask - 1) {
+        const size_type index = g * group_size + flat_map_detail::first_bit_index(mask);
+        if (_equal(_slots[index].first, key)) {
+          return index;
+        }
+      }
+
+      if (grp.match_empty()) {
+        return npos;
+      }
+
+      g = (g + step) & group_mask;
+    }
+  }
+
+  inline size_type find_insert_index(size_type h) const noexcept {
+    const size_type group_mask = _capacity / group_size - 1;
+    size_type g = (h >> 7) & group_mask;
+
+    for (size_type step = 1;; step++) {
+      const flat_map_detail::group grp(_ctrl + g * group_size);
+      if (std::uint32_t mask = grp.match_empty_or_deleted()) {
+        return g * group_size + flat_map_detail::first_bit_index(mask);
+      }
+
+      g = (g + step) & group_mask;
+    }
+  }
+
+  template <class _K, class... _Args>
+  inline std::pair<iterator, bool> emplace_impl(_K&& key, _Args&&... args) {
+    const size_type h = hash_key(key);
+    size_type index = find_index(key, h);
+    if (index != npos) {
+      return { iterator_at(index), false };
+    }
+
+    if (!_capacity) {
+      rehash(group_size);
+    }
+
+    index = find_insert_index(h);
+    if (_growth_left == 0 && _ctrl[index] != flat_map_detail::ctrl_deleted) {
+      // Many tombstones, rehashing in a table of the same capacity is enough.
+      rehash(_size < max_load(_capacity) / 2 ? _capacity : _capacity * 2);
+      index = find_insert_index(h);
+    }
+
+    // The control byte is set once the value is constructed in case it throws.
+    new (_slots + index) value_type(std::piecewise_construct, std::forward_as_tuple(std::forward<_K>(key)),
+        std::forward_as_tuple(std::forward<_Args>(args)...));
+
+    _growth_left -= _ctrl[index] == flat_map_detail::ctrl_empty;
+    _ctrl[index] = h2(h);
+    _size++;
+    return { iterator_at(index), true };
+  }
+
+  inline void erase_index(size_type index) noexcept {
+    _slots[index].~value_type();
+    _size--;
+
+    // A group that still has an empty slot was never full, no probe sequence went through it.
+    const flat_map_detail::group grp(_ctrl + (index & ~(group_size - 1)));
+    if (grp.match_empty()) {
+      _ctrl[index] = flat_map_detail::ctrl_empty;
+      _growth_left++;
+    }
+    else {
+      _ctrl[index] = flat_map_detail::ctrl_deleted;
+    }
+  }
+
+  inline void rehash(size_type new_capacity) {
+    fst_assert(new_capacity >= group_size && (new_capacity & (new_capacity - 1)) == 0,
+        "flat_map capacity must be a power of two");
+
+    ctrl_t* old_ctrl = _ctrl;
+    value_type* old_slots = _slots;
+    const size_type old_capacity = _capacity;
+
+    allocate(new_capacity);
+    _growth_left = max_load(new_capacity) - _size;
+
+    for (size_type i = 0; i < old_capacity; i++) {
+      if (old_ctrl[i] >= 0) {
+        value_type& slot = old_slots[i];
+        const size_type h = hash_key(slot.first);
+        const size_type index = find_insert_index(h);
+        new (_slots + index) value_type(std::move(slot));
+        _ctrl[index] = h2(h);
+        slot.~value_type();
+      }
+    }
+
+    if (old_ctrl) {
+      ::operator delete((void*)old_ctrl, std::align_val_t(alignment));
+    }
+  }
+
+  // Control bytes and slots share one allocation.
+  inline void allocate(size_type cap) {
+    const size_type slots_offset = (cap + alignof(value_type) - 1) & ~(alignof(value_type) - 1);
+    void* data = ::operator new(slots_offset + cap * sizeof(value_type), std::align_val_t(alignment));
+    _ctrl = (ctrl_t*)data;
+    _slots = (value_type*)((std::uint8_t*)data + slots_offset);
+    _capacity = cap;
+    std::memset(_ctrl, (std::uint8_t)flat_map_detail::ctrl_empty, cap);
+  }
+
+  inline void destroy_slots() noexcept {
+    if constexpr (!std::is_trivially_destructible<value_type>::value) {
+      for (size_type i = 0; i < _capacity; i++) {
+        if (_ctrl[i] >= 0) {
+          _slots[i].~value_type();
+        }
+      }
+    }
+  }
+
+  inline void destroy() noexcept {
+    if (_ctrl) {
+      destroy_slots();
+      ::operator delete((void*)_ctrl, std::align_val_t(alignment));
+    }
+    reset();
+  }
+
+  inline void reset() noexcept {
+    _ctrl = nullptr;
+    _slots = nullptr;
+    _capacity = 0;
+    _size = 0;
+    _growth_left = 0;
+  }
+};
+} // namespace fst.
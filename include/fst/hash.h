@@ -0,0 +1,222 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+#pragma once
+#include "fst/common.h"
+#include "fst/small_string.h"
+#include "fst/unmanaged_string.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Based on wyhash (public domain) https://github.com/wangyi-fudan/wyhash
+
+namespace fst {
+namespace hash_detail {
+  inline constexpr std::uint64_t secret[4]
+      = { 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull };
+
+  /// 64 x 64 -> 128 bits multiplication, lo in a and hi in b.
+  inline void multiply(std::uint64_t& a, std::uint64_t& b) noexcept {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)a * b;
+    a = (std::uint64_t)r;
+    b = (std::uint64_t)(r >> 64);
+#else
+    const std::uint64_t ha = a >> 32, hb = b >> 32, la = (std::uint32_t)a, lb = (std::uint32_t)b;
+    const std::uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const std::uint64_t t = rl + (rm0 << 32);
+    std::uint64_t c = t < rl;
+    const std::uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    a = lo;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+  }
+
+  inline std::uint64_t mix(std::uint64_t a, std::uint64_t b) noexcept {
+    multiply(a, b);
+    return a ^ b;
+  }
+
+  inline std::uint64_t read8(const std::uint8_t* p) noexcept {
+    std::uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+  }
+
+  inline std::uint64_t read4(const std::uint8_t* p) noexcept {
+    std::uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+  }
+
+  /// Reads 1 to 3 bytes.
+  inline std::uint64_t read3(const std::uint8_t* p, std::size_t k) noexcept {
+    return ((std::uint64_t)p[0] << 16) | ((std::uint64_t)p[k >> 1] << 8) | p[k - 1];
+  }
+} // namespace hash_detail.
+
+/// Hashes size bytes, inputs up to 16 bytes are read with at most two pairs of overlapping loads.
+inline std::uint64_t hash_bytes(const void* data, std::size_t size, std::uint64_t seed = 0) noexcept {
+  using namespace hash_detail;
+  const std::uint8_t* p = (const std::uint8_t*)data;
+  seed ^= mix(seed ^ secret[0], secret[1]);
+  std::uint64_t a;
+  std::uint64_t b;
+
+  if (size <= 16) {
+    if (size >= 4) {
+      const std::size_t k = (size >> 3) << 2;
+      a = (read4(p) << 32) | read4(p + k);
+      b = (read4(p + size - 4) << 32) | read4(p + size - 4 - k);
+    }
+    else if (size > 0) {
+      a = read3(p, size);
+      b = 0;
+    }
+    else {
+      a = b = 0;
+    }
+  }
+  else {
+    std::size_t i = size;
+    if (i > 48) {
+      std::uint64_t see1 = seed;
+      std::uint64_t see2 = seed;
+      do {
+        seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+        see1 = mix(read8(p + 16) ^ secret[2], read8(p + 24) ^ see1);
+        see2 = mix(read8(p + 32) ^ secret[3], read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+
+    while (i > 16) {
+      seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+
+    a = read8(p + i - 16);
+    b = read8(p + i - 8);
+  }
+
+  a ^= secret[1];
+  b ^= seed;
+  multiply(a, b);
+  return mix(a ^ secret[0] ^ size, b ^ secret[1]);
+}
+
+/// Hashes a 64 bits integer.
+inline std::uint64_t hash_int(std::uint64_t value) noexcept {
+  return hash_detail::mix(value ^ hash_detail::secret[0], hash_detail::secret[1]);
+}
+
+inline std::uint64_t hash_combine(std::uint64_t seed, std::uint64_t value) noexcept {
+  return hash_detail::mix(seed ^ hash_detail::secret[2], value ^ hash_detail::secret[3]);
+}
+
+template <typename _CharT>
+inline std::uint64_t hash_string(std::basic_string_view<_CharT> str, std::uint64_t seed = 0) noexcept {
+  return hash_bytes(str.data(), str.size() * sizeof(_CharT), seed);
+}
+
+/// Hash function object.
+/// All string types with the same content have the same hash, small_string keys can be looked up
+/// with a std::string_view when the key_equal is transparent too.
+template <typename _Tp, typename = void>
+struct hash : std::hash<_Tp> {};
+
+template <typename _Tp>
+struct hash<_Tp, std::enable_if_t<std::is_integral<_Tp>::value || std::is_enum<_Tp>::value>> {
+  inline std::size_t operator()(_Tp value) const noexcept { return (std::size_t)hash_int((std::uint64_t)value); }
+};
+
+template <typename _Tp>
+struct hash<_Tp*> {
+  inline std::size_t operator()(const _Tp* value) const noexcept {
+    return (std::size_t)hash_int((std::uint64_t)(std::uintptr_t)value);
+  }
+};
+
+namespace hash_detail {
+  struct string_hash {
+    using is_transparent = void;
+
+    template <typename _CharT>
+    inline std::size_t operator()(std::basic_string_view<_CharT> str) const noexcept {
+      return (std::size_t)hash_string(str);
+    }
+
+    template <typename _CharT, std::size_t _Size>
+    inline std::size_t operator()(const basic_small_string<_CharT, _Size>& str) const noexcept {
+      return (std::size_t)hash_string(str.to_view());
+    }
+
+    template <typename _CharT>
+    inline std::size_t operator()(const basic_unmanaged_string<_CharT>& str) const noexcept {
+      return (std::size_t)hash_string(str.to_view());
+    }
+
+    template <typename _CharT>
+    inline std::size_t operator()(const std::basic_string<_CharT>& str) const noexcept {
+      return (std::size_t)hash_string(std::basic_string_view<_CharT>(str));
+    }
+
+    template <typename _CharT>
+    inline std::size_t operator()(const _CharT* str) const noexcept {
+      return (std::size_t)hash_string(std::basic_string_view<_CharT>(str));
+    }
+  };
+} // namespace hash_detail.
+
+template <typename _CharT>
+struct hash<std::basic_string_view<_CharT>> : hash_detail::string_hash {};
+
+template <typename _CharT>
+struct hash<std::basic_string<_CharT>> : hash_detail::string_hash {};
+
+template <typename _CharT, std::size_t _Size>
+struct hash<basic_small_string<_CharT, _Size>> : hash_detail::string_hash {};
+
+template <typename _CharT>
+struct hash<basic_unmanaged_string<_CharT>> : hash_detail::string_hash {};
+} // namespace fst.
@@ -0,0 +1,231 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+
+#pragma once
+#include "fst/assert.h"
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace fst {
+static constexpr std::size_t inplace_function_default_capacity = 32;
+
+template <typename _Signature, std::size_t _Capacity, std::size_t _Alignment>
+class inplace_function;
+
+namespace inplace_function_detail {
+  template <typename _R, typename... _Args>
+  struct vtable {
+    _R (*invoke)(void*, _Args&&...);
+    void (*copy)(void* dst, const void* src);
+    // Move constructs in dst and destroys src.
+    void (*relocate)(void* dst, void* src) noexcept;
+    void (*destroy)(void*) noexcept;
+  };
+
+  template <typename _Fct, typename _R, typename... _Args>
+  inline constexpr vtable<_R, _Args...> vtable_for = {
+    [](void* f, _Args&&... args) -> _R {
+      if constexpr (std::is_void_v<_R>) {
+        std::invoke(*static_cast<_Fct*>(f), std::forward<_Args>(args)...);
+      }
+      else {
+        return std::invoke(*static_cast<_Fct*>(f), std::forward<_Args>(args)...);
+      }
+    },
+    [](void* dst, const void* src) { ::new (dst) _Fct(*static_cast<const _Fct*>(src)); },
+    [](void* dst, void* src) noexcept {
+      ::new (dst) _Fct(std::move(*static_cast<_Fct*>(src)));
+      static_cast<_Fct*>(src)->~_Fct();
+    },
+    [](void* f) noexcept { static_cast<_Fct*>(f)->~_Fct(); },
+  };
+
+  template <typename _Fct>
+  struct is_nullable_function : std::false_type {};
+
+  template <typename _Signature>
+  struct is_nullable_function<std::function<_Signature>> : std::true_type {};
+
+  template <typename _Signature, std::size_t _Capacity, std::size_t _Alignment>
+  struct is_nullable_function<inplace_function<_Signature, _Capacity, _Alignment>> : std::true_type {};
+
+  /// Null pointers and empty function wrappers make an empty inplace_function, like std::function.
+  template <typename _Fct>
+  inline bool is_null(const _Fct& fct) noexcept {
+    if constexpr (std::is_pointer_v<_Fct> || std::is_member_pointer_v<_Fct>) {
+      return fct == nullptr;
+    }
+    else if constexpr (is_nullable_function<_Fct>::value) {
+      return !fct;
+    }
+    else {
+      return false;
+    }
+  }
+} // namespace inplace_function_detail.
+
+template <typename _Signature, std::size_t _Capacity = inplace_function_default_capacity,
+    std::size_t _Alignment = alignof(std::max_align_t)>
+class inplace_function;
+
+/// std::function that never allocates.
+///
+/// The callable is always stored in the object itself, one that doesn't fit in
+/// _Capacity bytes is a compile error instead of a heap allocation. Calling an
+/// empty inplace_function asserts.
+template <typename _R, typename... _Args, std::size_t _Capacity, std::size_t _Alignment>
+class inplace_function<_R(_Args...), _Capacity, _Alignment> {
+  template <typename _Fct>
+  using enable_if_callable = std::enable_if_t<!std::is_same_v<std::decay_t<_Fct>, inplace_function>
+      && std::is_invocable_r_v<_R, std::decay_t<_Fct>&, _Args...>>;
+
+public:
+  using result_type = _R;
+
+  static constexpr std::size_t capacity = _Capacity;
+  static constexpr std::size_t alignment = _Alignment;
+
+  template <typename _Fct>
+  static constexpr bool can_store
+      = sizeof(std::decay_t<_Fct>) <= capacity && alignment % alignof(std::decay_t<_Fct>) == 0;
+
+  inplace_function() noexcept = default;
+  inplace_function(std::nullptr_t) noexcept {}
+
+  template <typename _Fct, typename = enable_if_callable<_Fct>>
+  inline inplace_function(_Fct&& fct) {
+    using fct_type = std::decay_t<_Fct>;
+    static_assert(sizeof(fct_type) <= capacity, "inplace_function capture is too big");
+    static_assert(alignment % alignof(fct_type) == 0, "inplace_function capture alignment is too big");
+    static_assert(std::is_copy_constructible_v<fct_type>, "inplace_function callable must be copy constructible");
+    static_assert(std::is_nothrow_move_constructible_v<fct_type>, "inplace_function callable must be nothrow movable");
+
+    if (inplace_function_detail::is_null(fct)) {
+      return;
+    }
+
+    ::new (_storage) fct_type(std::forward<_Fct>(fct));
+    _vtable = &inplace_function_detail::vtable_for<fct_type, _R, _Args...>;
+  }
+
+  inline inplace_function(const inplace_function& other)
+      : _vtable(other._vtable) {
+    if (_vtable) {
+      _vtable->copy(_storage, other._storage);
+    }
+  }
+
+  inline inplace_function(inplace_function&& other) noexcept
+      : _vtable(other._vtable) {
+    if (_vtable) {
+      _vtable->relocate(_storage, other._storage);
+      other._vtable = nullptr;
+    }
+  }
+
+  inline ~inplace_function() { reset(); }
+
+  inline inplace_function& operator=(const inplace_function& other) {
+    if (this != &other) {
+      reset();
+      if (other._vtable) {
+        other._vtable->copy(_storage, other._storage);
+        _vtable = other._vtable;
+      }
+    }
+    return *this;
+  }
+
+  inline inplace_function& operator=(inplace_function&& other) noexcept {
+    if (this != &other) {
+      reset();
+      if (other._vtable) {
+        other._vtable->relocate(_storage, other._storage);
+        _vtable = std::exchange(other._vtable, nullptr);
+      }
+    }
+    return *this;
+  }
+
+  inline inplace_function& operator=(std::nullptr_t) noexcept {
+    reset();
+    return *this;
+  }
+
+  template <typename _Fct, typename = enable_if_callable<_Fct>>
+  inline inplace_function& operator=(_Fct&& fct) {
+    return *this = inplace_function(std::forward<_Fct>(fct));
+  }
+
+  inline _R operator()(_Args... args) const {
+    fst_assert(_vtable, "Call to an empty inplace_function");
+    return _vtable->invoke(const_cast<unsigned char*>(_storage), std::forward<_Args>(args)...);
+  }
+
+  inline explicit operator bool() const noexcept { return _vtable != nullptr; }
+
+  inline void reset() noexcept {
+    if (_vtable) {
+      _vtable->destroy(_storage);
+      _vtable = nullptr;
+    }
+  }
+
+  inline void swap(inplace_function& other) noexcept {
+    inplace_function tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+private:
+  using vtable_type = inplace_function_detail::vtable<_R, _Args...>;
+
+  alignas(alignment) unsigned char _storage[capacity];
+  const vtable_type* _vtable = nullptr;
+};
+
+template <typename _Signature, std::size_t _Capacity, std::size_t _Alignment>
+inline bool operator==(const inplace_function<_Signature, _Capacity, _Alignment>& f, std::nullptr_t) noexcept {
+  return !f;
+}
+
+template <typename _Signature, std::size_t _Capacity, std::size_t _Alignment>
+inline bool operator!=(const inplace_function<_Signature, _Capacity, _Alignment>& f, std::nullptr_t) noexcept {
+  return static_cast<bool>(f);
+}
+} // namespace fst.
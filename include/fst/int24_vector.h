@@ -0,0 +1,518 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+#pragma once
+#include "fst/common.h"
+#include "fst/assert.h"
+#include "fst/int24_t.h"
+#include "fst/span.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+// clang-format off
+#if __FST_AVX2__
+  #include <immintrin.h>
+#elif __FST_SSSE3__
+  #include <tmmintrin.h>
+#endif
+// clang-format on
+
+namespace fst {
+namespace int24_detail {
+  using size_type = std::size_t;
+
+  inline constexpr float to_float_scale = 1.0f / 8388608.0f;
+  inline constexpr float from_float_scale = 8388608.0f;
+  inline constexpr float max_float_value = 8388607.0f;
+  inline constexpr float min_float_value = -8388608.0f;
+
+  inline std::int32_t load(const std::uint8_t* src) noexcept {
+    const std::uint32_t v = (std::uint32_t)src[0] | ((std::uint32_t)src[1] << 8) | ((std::uint32_t)src[2] << 16);
+    // Sign extend from bit 23.
+    return (std::int32_t)(v << 8) >> 8;
+  }
+
+  inline void store(std::uint8_t* dst, std::int32_t value) noexcept {
+    dst[0] = (std::uint8_t)(value & 0xFF);
+    dst[1] = (std::uint8_t)((value >> 8) & 0xFF);
+    dst[2] = (std::uint8_t)((value >> 16) & 0xFF);
+  }
+
+  // NaN becomes 0 and infinities saturate, like the simd kernels.
+  inline std::int32_t float_to_int(float value) noexcept {
+    const float v = value * from_float_scale;
+    if (std::isnan(v)) {
+      return 0;
+    }
+    return (std::int32_t)(v < min_float_value ? min_float_value : (v > max_float_value ? max_float_value : v));
+  }
+
+#if __FST_SSSE3__ || __FST_AVX2__
+  // Moves each packed sample to the upper 3 bytes of a 32 bit lane, an arithmetic
+  // right shift then sign extends it.
+  inline __m128i widen_shuffle_mask() noexcept {
+    return _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+  }
+
+  // Packs the lower 3 bytes of each 32 bit lane in the first 12 bytes.
+  inline __m128i narrow_shuffle_mask() noexcept {
+    return _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+  }
+#endif
+
+  // Each kernel returns the number of samples it processed, the caller finishes
+  // the remaining ones with the scalar code. Vector loads and stores touch 4 bytes
+  // past the last sample of each block, the loop bounds keep them inside the buffer.
+#if __FST_AVX2__
+  inline size_type widen_simd(const std::uint8_t* src, std::int32_t* dst, size_type count) noexcept {
+    const __m256i mask = _mm256_broadcastsi128_si256(widen_shuffle_mask());
+    size_type i = 0;
+    for (; (i + 8) * 3 + 4 <= count * 3; i += 8) {
+      const __m128i lo = _mm_loadu_si128((const __m128i*)(src + i * 3));
+      const __m128i hi = _mm_loadu_si128((const __m128i*)(src + i * 3 + 12));
+      const __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+      _mm256_storeu_si256((__m256i*)(dst + i), _mm256_srai_epi32(_mm256_shuffle_epi8(v, mask), 8));
+    }
+    return i;
+  }
+
+  inline size_type widen_simd(const std::uint8_t* src, float* dst, size_type count) noexcept {
+    const __m256i mask = _mm256_broadcastsi128_si256(widen_shuffle_mask());
+    const __m256 scale = _mm256_set1_ps(to_float_scale);
+    size_type i = 0;
+    for (; (i + 8) * 3 + 4 <= count * 3; i += 8) {
+      const __m128i lo = _mm_loadu_si128((const __m128i*)(src + i * 3));
+      const __m128i hi = _mm_loadu_si128((const __m128i*)(src + i * 3 + 12));
+      const __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+      const __m256i w = _mm256_srai_epi32(_mm256_shuffle_epi8(v, mask), 8);
+      _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(w), scale));
+    }
+    return i;
+  }
+
+  inline void narrow_store(std::uint8_t* dst, __m256i v) noexcept {
+    const __m256i packed = _mm256_shuffle_epi8(v, _mm256_broadcastsi128_si256(narrow_shuffle_mask()));
+    // The upper half store overwrites the 4 unused bytes of the lower one.
+    _mm_storeu_si128((__m128i*)dst, _mm256_castsi256_si128(packed));
+    _mm_storeu_si128((__m128i*)(dst + 12), _mm256_extracti128_si256(packed, 1));
+  }
+
+  inline size_type narrow_simd(const std::int32_t* src, std::uint8_t* dst, size_type count) noexcept {
+    size_type i = 0;
+    for (; (i + 8) * 3 + 4 <= count * 3; i += 8) {
+      narrow_store(dst + i * 3, _mm256_loadu_si256((const __m256i*)(src + i)));
+    }
+    return i;
+  }
+
+  inline size_type narrow_simd(const float* src, std::uint8_t* dst, size_type count) noexcept {
+    const __m256 scale = _mm256_set1_ps(from_float_scale);
+    const __m256 max_value = _mm256_set1_ps(max_float_value);
+    const __m256 min_value = _mm256_set1_ps(min_float_value);
+    size_type i = 0;
+    for (; (i + 8) * 3 + 4 <= count * 3; i += 8) {
+      const __m256 v = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+      // Zeroes the NaN lanes, min/max would return max_value for them.
+      const __m256 n = _mm256_and_ps(v, _mm256_cmp_ps(v, v, _CMP_ORD_Q));
+      const __m256 c = _mm256_max_ps(_mm256_min_ps(n, max_value), min_value);
+      narrow_store(dst + i * 3, _mm256_cvttps_epi32(c));
+    }
+    return i;
+  }
+
+#elif __FST_SSSE3__
+  inline size_type widen_simd(const std::uint8_t* src, std::int32_t* dst, size_type count) noexcept {
+    const __m128i mask = widen_shuffle_mask();
+    size_type i = 0;
+    for (; (i + 4) * 3 + 4 <= count * 3; i += 4) {
+      const __m128i v = _mm_loadu_si128((const __m128i*)(src + i * 3));
+      _mm_storeu_si128((__m128i*)(dst + i), _mm_srai_epi32(_mm_shuffle_epi8(v, mask), 8));
+    }
+    return i;
+  }
+
+  inline size_type widen_simd(const std::uint8_t* src, float* dst, size_type count) noexcept {
+    const __m128i mask = widen_shuffle_mask();
+    const __m128 scale = _mm_set1_ps(to_float_scale);
+    size_type i = 0;
+    for (; (i + 4) * 3 + 4 <= count * 3; i += 4) {
+      const __m128i v = _mm_loadu_si128((const __m128i*)(src + i * 3));
+      const __m128i w = _mm_srai_epi32(_mm_shuffle_epi8(v, mask), 8);
+      _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(w), scale));
+    }
+    return i;
+  }
+
+  inline size_type narrow_simd(const std::int32_t* src, std::uint8_t* dst, size_type count) noexcept {
+    const __m128i mask = narrow_shuffle_mask();
+    size_type i = 0;
+    for (; (i + 4) * 3 + 4 <= count * 3; i += 4) {
+      const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+      _mm_storeu_si128((__m128i*)(dst + i * 3), _mm_shuffle_epi8(v, mask));
+    }
+    return i;
+  }
+
+  inline size_type narrow_simd(const float* src, std::uint8_t* dst, size_type count) noexcept {
+    const __m128i mask = narrow_shuffle_mask();
+    const __m128 scale = _mm_set1_ps(from_float_scale);
+    const __m128 max_value = _mm_set1_ps(max_float_value);
+    const __m128 min_value = _mm_set1_ps(min_float_value);
+    size_type i = 0;
+    for (; (i + 4) * 3 + 4 <= count * 3; i += 4) {
+      const __m128 v = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+      // Zeroes the NaN lanes, min/max would return max_value for them.
+      const __m128 n = _mm_and_ps(v, _mm_cmpord_ps(v, v));
+      const __m128i c = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(n, max_value), min_value));
+      _mm_storeu_si128((__m128i*)(dst + i * 3), _mm_shuffle_epi8(c, mask));
+    }
+    return i;
+  }
+
+#else
+  template <typename T>
+  inline size_type widen_simd(const std::uint8_t*, T*, size_type) noexcept {
+    return 0;
+  }
+
+  template <typename T>
+  inline size_type narrow_simd(const T*, std::uint8_t*, size_type) noexcept {
+    return 0;
+  }
+#endif
+} // namespace int24_detail.
+
+//
+// Bulk conversions between packed little endian 24 bit samples and 32 bit values.
+// SSSE3 or AVX2 shuffles are used when enabled at compile time.
+//
+
+/// Sign extends count packed samples to int32.
+inline void int24_widen(const void* src, std::int32_t* dst, std::size_t count) noexcept {
+  const std::uint8_t* s = (const std::uint8_t*)src;
+  for (std::size_t i = int24_detail::widen_simd(s, dst, count); i < count; i++) {
+    dst[i] = int24_detail::load(s + i * 3);
+  }
+}
+
+/// Converts count packed samples to float in [-1, 1), same scaling as convert_options::pcm_24_bit.
+inline void int24_widen(const void* src, float* dst, std::size_t count) noexcept {
+  const std::uint8_t* s = (const std::uint8_t*)src;
+  for (std::size_t i = int24_detail::widen_simd(s, dst, count); i < count; i++) {
+    dst[i] = (float)int24_detail::load(s + i * 3) * int24_detail::to_float_scale;
+  }
+}
+
+/// Keeps the lower 24 bits of each value, like assigning to an fst::int24_t.
+inline void int24_narrow(const std::int32_t* src, void* dst, std::size_t count) noexcept {
+  std::uint8_t* d = (std::uint8_t*)dst;
+  for (std::size_t i = int24_detail::narrow_simd(src, d, count); i < count; i++) {
+    int24_detail::store(d + i * 3, src[i]);
+  }
+}
+
+/// Scales and saturates float samples in [-1, 1] to packed 24 bit samples.
+inline void int24_narrow(const float* src, void* dst, std::size_t count) noexcept {
+  std::uint8_t* d = (std::uint8_t*)dst;
+  for (std::size_t i = int24_detail::narrow_simd(src, d, count); i < count; i++) {
+    int24_detail::store(d + i * 3, int24_detail::float_to_int(src[i]));
+  }
+}
+
+/// Proxy to a packed 24 bit sample.
+class int24_reference {
+public:
+  inline explicit int24_reference(std::uint8_t* data) noexcept
+      : _data(data) {}
+
+  int24_reference(const int24_reference&) noexcept = default;
+
+  inline int24_reference& operator=(const int24_reference& ref) noexcept { return operator=((std::int32_t)ref); }
+
+  inline int24_reference& operator=(std::int32_t value) noexcept {
+    int24_detail::store(_data, value);
+    return *this;
+  }
+
+  inline int24_reference& operator=(fst::int24_t value) noexcept { return operator=((std::int32_t)value); }
+
+  inline int24_reference& operator+=(std::int32_t value) noexcept { return operator=((std::int32_t)(*this) + value); }
+  inline int24_reference& operator-=(std::int32_t value) noexcept { return operator=((std::int32_t)(*this) - value); }
+
+  inline operator std::int32_t() const noexcept { return int24_detail::load(_data); }
+  inline operator fst::int24_t() const noexcept { return fst::int24_t(int24_detail::load(_data)); }
+
+private:
+  std::uint8_t* _data;
+};
+
+template <typename _Byte>
+class int24_iterator {
+public:
+  static constexpr bool is_const = std::is_const<_Byte>::value;
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = std::int32_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = std::conditional_t<is_const, std::int32_t, int24_reference>;
+  using pointer = void;
+
+  int24_iterator() noexcept = default;
+
+  inline explicit int24_iterator(_Byte* data) noexcept
+      : _data(data) {}
+
+  inline reference operator*() const noexcept { return reference(deref()); }
+  inline reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+  inline int24_iterator& operator++() noexcept {
+    _data += 3;
+    return *this;
+  }
+
+  inline int24_iterator operator++(int) noexcept {
+    int24_iterator it = *this;
+    _data += 3;
+    return it;
+  }
+
+  inline int24_iterator& operator--() noexcept {
+    _data -= 3;
+    return *this;
+  }
+
+  inline int24_iterator operator--(int) noexcept {
+    int24_iterator it = *this;
+    _data -= 3;
+    return it;
+  }
+
+  inline int24_iterator& operator+=(difference_type n) noexcept {
+    _data += n * 3;
+    return *this;
+  }
+
+  inline int24_iterator& operator-=(difference_type n) noexcept {
+    _data -= n * 3;
+    return *this;
+  }
+
+  inline int24_iterator operator+(difference_type n) const noexcept { return int24_iterator(_data + n * 3); }
+  inline int24_iterator operator-(difference_type n) const noexcept { return int24_iterator(_data - n * 3); }
+  inline difference_type operator-(const int24_iterator& it) const noexcept { return (_data - it._data) / 3; }
+
+  inline bool operator==(const int24_iterator& it) const noexcept { return _data == it._data; }
+  inline bool operator!=(const int24_iterator& it) const noexcept { return _data != it._data; }
+  inline bool operator<(const int24_iterator& it) const noexcept { return _data < it._data; }
+  inline bool operator>(const int24_iterator& it) const noexcept { return _data > it._data; }
+  inline bool operator<=(const int24_iterator& it) const noexcept { return _data <= it._data; }
+  inline bool operator>=(const int24_iterator& it) const noexcept { return _data >= it._data; }
+
+private:
+  _Byte* _data = nullptr;
+
+  inline auto deref() const noexcept {
+    if constexpr (is_const) {
+      return int24_detail::load(_data);
+    }
+    else {
+      return _data;
+    }
+  }
+};
+
+/// Non owning view of contiguous packed little endian 24 bit samples.
+template <typename _Byte>
+class basic_int24_span {
+public:
+  static constexpr bool is_const = std::is_const<_Byte>::value;
+  using value_type = std::int32_t;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using byte_pointer = _Byte*;
+  using reference = std::conditional_t<is_const, std::int32_t, int24_reference>;
+  using const_reference = std::int32_t;
+  using iterator = int24_iterator<_Byte>;
+  using const_iterator = int24_iterator<const std::uint8_t>;
+
+  basic_int24_span() noexcept = default;
+
+  inline basic_int24_span(byte_pointer data, size_type size) noexcept
+      : _data(data)
+      , _size(size) {}
+
+  template <typename _Int24, typename = std::enable_if_t<std::is_same<std::remove_const_t<_Int24>, int24_t>::value>>
+  inline basic_int24_span(_Int24* data, size_type size) noexcept
+      : _data((byte_pointer)data)
+      , _size(size) {}
+
+  template <typename _OtherByte,
+      typename = std::enable_if_t<std::is_convertible<_OtherByte*, _Byte*>::value && !std::is_same<_OtherByte, _Byte>::value>>
+  inline basic_int24_span(const basic_int24_span<_OtherByte>& s) noexcept
+      : _data(s.data())
+      , _size(s.size()) {}
+
+  [[nodiscard]] inline byte_pointer data() const noexcept { return _data; }
+  [[nodiscard]] inline size_type size() const noexcept { return _size; }
+  [[nodiscard]] inline size_type size_bytes() const noexcept { return _size * 3; }
+  [[nodiscard]] inline bool empty() const noexcept { return _size == 0; }
+
+  inline reference operator[](size_type __index) const noexcept {
+    fst_assert(__index < _size, "Index out of bounds");
+    return *(begin() + (difference_type)__index);
+  }
+
+  inline iterator begin() const noexcept { return iterator(_data); }
+  inline iterator end() const noexcept { return iterator(_data + _size * 3); }
+
+  inline basic_int24_span subspan(size_type offset, size_type count) const noexcept {
+    fst_assert(offset + count <= _size, "Out of bounds subspan");
+    return basic_int24_span(_data + offset * 3, count);
+  }
+
+  /// Converts min(size(), dst.size()) samples.
+  inline void widen(fst::span<std::int32_t> dst) const noexcept {
+    int24_widen(_data, dst.data(), std::min<size_type>(_size, dst.size()));
+  }
+
+  inline void widen(fst::span<float> dst) const noexcept {
+    int24_widen(_data, dst.data(), std::min<size_type>(_size, dst.size()));
+  }
+
+  template <bool _Dummy = true, typename = std::enable_if_t<_Dummy && !is_const>>
+  inline void narrow(fst::span<const std::int32_t> src) const noexcept {
+    int24_narrow(src.data(), _data, std::min<size_type>(_size, src.size()));
+  }
+
+  template <bool _Dummy = true, typename = std::enable_if_t<_Dummy && !is_const>>
+  inline void narrow(fst::span<const float> src) const noexcept {
+    int24_narrow(src.data(), _data, std::min<size_type>(_size, src.size()));
+  }
+
+private:
+  byte_pointer _data = nullptr;
+  size_type _size = 0;
+};
+
+using int24_span = basic_int24_span<std::uint8_t>;
+using const_int24_span = basic_int24_span<const std::uint8_t>;
+
+/// Contiguous vector of packed little endian 24 bit samples (3 bytes per element).
+class int24_vector {
+public:
+  using value_type = std::int32_t;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = int24_reference;
+  using const_reference = std::int32_t;
+  using iterator = int24_iterator<std::uint8_t>;
+  using const_iterator = int24_iterator<const std::uint8_t>;
+
+  int24_vector() noexcept = default;
+
+  inline explicit int24_vector(size_type size)
+      : _data(size * 3, 0) {}
+
+  inline int24_vector(fst::span<const std::int32_t> values)
+      : _data(values.size() * 3) {
+    int24_narrow(values.data(), _data.data(), values.size());
+  }
+
+  inline int24_vector(fst::span<const float> values)
+      : _data(values.size() * 3) {
+    int24_narrow(values.data(), _data.data(), values.size());
+  }
+
+  inline int24_vector(std::initializer_list<std::int32_t> values)
+      : int24_vector(fst::span<const std::int32_t>(values.begin(), values.size())) {}
+
+  [[nodiscard]] inline size_type size() const noexcept { return _data.size() / 3; }
+  [[nodiscard]] inline size_type size_bytes() const noexcept { return _data.size(); }
+  [[nodiscard]] inline size_type capacity() const noexcept { return _data.capacity() / 3; }
+  [[nodiscard]] inline bool empty() const noexcept { return _data.empty(); }
+
+  inline void resize(size_type size) { _data.resize(size * 3, 0); }
+  inline void reserve(size_type size) { _data.reserve(size * 3); }
+  inline void clear() noexcept { _data.clear(); }
+
+  inline void push_back(std::int32_t value) {
+    const size_type index = _data.size();
+    _data.resize(index + 3);
+    int24_detail::store(_data.data() + index, value);
+  }
+
+  inline void pop_back() noexcept {
+    fst_assert(!empty(), "pop_back when empty");
+    _data.resize(_data.size() - 3);
+  }
+
+  /// Appends the samples converted from int32 or float values.
+  template <typename T>
+  inline void append(fst::span<const T> values) {
+    const size_type index = _data.size();
+    _data.resize(index + values.size() * 3);
+    int24_narrow(values.data(), _data.data() + index, values.size());
+  }
+
+  inline reference operator[](size_type __index) noexcept {
+    fst_assert(__index < size(), "Index out of bounds");
+    return reference(_data.data() + __index * 3);
+  }
+
+  inline const_reference operator[](size_type __index) const noexcept {
+    fst_assert(__index < size(), "Index out of bounds");
+    return int24_detail::load(_data.data() + __index * 3);
+  }
+
+  inline std::uint8_t* data() noexcept { return _data.data(); }
+  inline const std::uint8_t* data() const noexcept { return _data.data(); }
+
+  inline iterator begin() noexcept { return iterator(_data.data()); }
+  inline const_iterator begin() const noexcept { return const_iterator(_data.data()); }
+  inline iterator end() noexcept { return iterator(_data.data() + _data.size()); }
+  inline const_iterator end() const noexcept { return const_iterator(_data.data() + _data.size()); }
+
+  inline int24_span span() noexcept { return int24_span(_data.data(), size()); }
+  inline const_int24_span span() const noexcept { return const_int24_span(_data.data(), size()); }
+
+  inline void widen(fst::span<std::int32_t> dst) const noexcept { span().widen(dst); }
+  inline void widen(fst::span<float> dst) const noexcept { span().widen(dst); }
+
+private:
+  std::vector<std::uint8_t> _data;
+};
+} // namespace fst.
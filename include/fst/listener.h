@@ -31,51 +31,235 @@
 /// POSSIBILITY OF SUCH DAMAGE.
 ///
 
+
 #pragma once
 #include "fst/pointer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 namespace fst {
+/// Thread safe list of listeners, copy-on-write.
+///
+/// Notifying iterates an immutable snapshot of the list without taking a lock,
+/// add() and remove() copy the list and publish the new one atomically. Each
+/// published list gets its own reader count, a replaced list is freed by the
+/// add() or remove() that replaces it, or a later one, once its own readers are
+/// gone, even while new readers keep using the newer lists. A listener can
+/// therefore remove itself, or others, while being notified.
+///
+/// A notification that started before a remove() returned can still reach the
+/// removed listener, the ones started after can't.
 template <typename _Listener>
 class listener_manager {
 public:
   using listener = _Listener;
   using vector_type = std::vector<listener*>;
-  using iterator = typename vector_type::iterator;
+  using iterator = typename vector_type::const_iterator;
   using const_iterator = typename vector_type::const_iterator;
   using size_type = typename vector_type::size_type;
 
-  inline void add(fst::not_null<listener*> new_listener) {
-    for (listener* l : _listeners) {
-      if (l == new_listener) {
-        return;
+private:
+  // A published list and its readers. Generations are reused but never freed
+  // before the manager, so a reader can always register on one it just loaded.
+  struct alignas(64) generation {
+    std::atomic<std::size_t> reader_count = 0;
+    std::atomic<const vector_type*> listeners = nullptr;
+  };
+
+public:
+  /// Keeps a list alive while it's being read.
+  class snapshot {
+  public:
+    inline explicit snapshot(const listener_manager& manager) noexcept
+        : _generation(manager.acquire()) {
+      if (_generation) {
+        _listeners = _generation->listeners.load(std::memory_order_acquire);
       }
     }
 
-    _listeners.push_back(new_listener);
+    snapshot(const snapshot&) = delete;
+    inline snapshot(snapshot&& s) noexcept
+        : _generation(std::exchange(s._generation, nullptr))
+        , _listeners(std::exchange(s._listeners, nullptr)) {}
+
+    inline ~snapshot() noexcept {
+      if (_generation) {
+        _generation->reader_count.fetch_sub(1, std::memory_order_release);
+      }
+    }
+
+    snapshot& operator=(const snapshot&) = delete;
+    snapshot& operator=(snapshot&&) = delete;
+
+    inline size_type size() const noexcept { return _listeners ? _listeners->size() : 0; }
+    inline bool empty() const noexcept { return size() == 0; }
+
+    inline listener* operator[](size_type __index) const noexcept { return (*_listeners)[__index]; }
+
+    inline const_iterator begin() const noexcept { return _listeners ? _listeners->begin() : const_iterator(); }
+    inline const_iterator end() const noexcept { return _listeners ? _listeners->end() : const_iterator(); }
+
+  private:
+    generation* _generation;
+    const vector_type* _listeners = nullptr;
+  };
+
+  listener_manager() noexcept = default;
+
+  listener_manager(const listener_manager&) = delete;
+  listener_manager(listener_manager&&) = delete;
+
+  inline ~listener_manager() {
+    for (generation& g : _generations) {
+      delete g.listeners.load(std::memory_order_relaxed);
+    }
+  }
+
+  listener_manager& operator=(const listener_manager&) = delete;
+  listener_manager& operator=(listener_manager&&) = delete;
+
+  inline void add(fst::not_null<listener*> new_listener) {
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    const vector_type* current = current_list();
+    if (current && std::find(current->begin(), current->end(), new_listener) != current->end()) {
+      return;
+    }
+
+    std::unique_ptr<vector_type> list
+        = current ? std::make_unique<vector_type>(*current) : std::make_unique<vector_type>();
+    list->push_back(new_listener);
+    publish(list.release());
   }
 
   inline void remove(fst::not_null<listener*> old_listener) {
-    for (auto it = _listeners.begin(); it != _listeners.end(); ++it) {
-      if ((*it) == old_listener) {
-        _listeners.erase(it);
-        return;
-      }
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    const vector_type* current = current_list();
+    if (!current) {
+      return;
+    }
+
+    auto it = std::find(current->begin(), current->end(), old_listener);
+    if (it == current->end()) {
+      return;
+    }
+
+    // An empty list is published as nullptr so that notify() doesn't register as a reader.
+    std::unique_ptr<vector_type> list;
+    if (current->size() > 1) {
+      list = std::make_unique<vector_type>(current->begin(), it);
+      list->insert(list->end(), it + 1, current->end());
     }
+    publish(list.release());
   }
 
-  inline std::vector<listener*>& get() { return _listeners; }
-  inline const std::vector<listener*>& get() const { return _listeners; }
+  inline bool contains(fst::not_null<listener*> l) const {
+    snapshot s(*this);
+    return std::find(s.begin(), s.end(), l) != s.end();
+  }
+
+  /// Calls fct(listener*) for every listener.
+  template <typename _Fct>
+  inline void notify(_Fct&& fct) const {
+    // Fast path, nothing to do and no reader to register.
+    if (!_current.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    snapshot s(*this);
+    for (listener* l : s) {
+      fct(l);
+    }
+  }
+
+  /// Calls (listener->*fct)(args...) for every listener.
+  template <typename _R, typename _L, typename... _FctArgs, typename... _Args>
+  inline void notify(_R (_L::*fct)(_FctArgs...), _Args&&... args) const {
+    notify([&](listener* l) { (l->*fct)(args...); });
+  }
 
-  inline size_type size() const noexcept { return _listeners.size(); }
-  inline bool empty() const noexcept { return _listeners.empty(); }
+  inline snapshot get() const noexcept { return snapshot(*this); }
 
-  inline iterator begin() { return _listeners.begin(); }
-  inline const_iterator begin() const { return _listeners.begin(); }
-  inline iterator end() { return _listeners.end(); }
-  inline const_iterator end() const { return _listeners.end(); }
+  inline size_type size() const noexcept { return get().size(); }
+  inline bool empty() const noexcept { return !_current.load(std::memory_order_acquire); }
+
+  /// Replaced lists that are still read by a snapshot and aren't freed yet.
+  inline size_type retired_count() const {
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    const generation* current = _current.load(std::memory_order_relaxed);
+    return (size_type)std::count_if(_generations.begin(), _generations.end(), [&](const generation& g) {
+      return &g != current && g.listeners.load(std::memory_order_relaxed);
+    });
+  }
 
 private:
-  vector_type _listeners;
+  // nullptr when there is no listener.
+  std::atomic<generation*> _current = nullptr;
+
+  // Writers only, a deque keeps the generations in place when it grows.
+  mutable std::mutex _write_mutex;
+  std::deque<generation> _generations;
+
+  inline generation* acquire() const noexcept {
+    generation* g = _current.load(std::memory_order_seq_cst);
+    while (g) {
+      // Still current after registering, so publish() can't free its list before release.
+      g->reader_count.fetch_add(1, std::memory_order_seq_cst);
+      generation* current = _current.load(std::memory_order_seq_cst);
+      if (current == g) {
+        return g;
+      }
+
+      g->reader_count.fetch_sub(1, std::memory_order_release);
+      g = current;
+    }
+
+    return nullptr;
+  }
+
+  /// Called with _write_mutex held.
+  inline const vector_type* current_list() const noexcept {
+    const generation* current = _current.load(std::memory_order_relaxed);
+    return current ? current->listeners.load(std::memory_order_relaxed) : nullptr;
+  }
+
+  /// Called with _write_mutex held.
+  inline void publish(const vector_type* list) {
+    generation* next = nullptr;
+    if (list) {
+      // A free generation can still be counted by a reader that's about to find
+      // out it's not current, it's reused anyway since that reader never reads it.
+      generation* current = _current.load(std::memory_order_relaxed);
+      for (generation& g : _generations) {
+        if (&g != current && !g.listeners.load(std::memory_order_relaxed)) {
+          next = &g;
+          break;
+        }
+      }
+
+      if (!next) {
+        next = &_generations.emplace_back();
+      }
+
+      next->listeners.store(list, std::memory_order_release);
+    }
+
+    _current.store(next, std::memory_order_seq_cst);
+
+    // Readers registered after the store above can only get next, the load of
+    // each reader_count also synchronizes with the release of its last reader.
+    for (generation& g : _generations) {
+      if (&g != next && g.listeners.load(std::memory_order_relaxed)
+          && g.reader_count.load(std::memory_order_seq_cst) == 0) {
+        delete g.listeners.exchange(nullptr, std::memory_order_relaxed);
+      }
+    }
+  }
 };
 } // namespace fst.
@@ -0,0 +1,136 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+
+#pragma once
+#include "fst/event_manager.h"
+#include "fst/flat_map.h"
+#include "fst/listener.h"
+#include "fst/mpsc_queue.h"
+#include "fst/span.h"
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace fst {
+/// Batched and coalescing notifications for a listener_manager.
+///
+/// post() queues a (key, value) pair from any thread without locking. On
+/// flush(), usually called on every event_manager tick after connect(), the
+/// queued pairs are coalesced by key, the last value wins and the order of the
+/// first post of each key is kept, and every listener gets the whole batch in
+/// a single call to its batch member function.
+///
+/// The listener_manager and the connected event_manager must outlive the dispatcher.
+template <typename _Listener, typename _Key, typename _Value>
+class coalescing_listener_dispatcher {
+public:
+  using listener = _Listener;
+  using key_type = _Key;
+  using mapped_type = _Value;
+  using value_type = std::pair<key_type, mapped_type>;
+  using batch_type = fst::span<const value_type>;
+  using batch_function = void (listener::*)(batch_type);
+  using listener_manager_type = fst::listener_manager<listener>;
+
+  inline coalescing_listener_dispatcher(listener_manager_type& listeners, batch_function fct)
+      : _listeners(listeners)
+      , _fct(fct) {
+    _pending.reserve(mpsc_queue<value_type>::default_recycled_capacity);
+  }
+
+  coalescing_listener_dispatcher(const coalescing_listener_dispatcher&) = delete;
+  coalescing_listener_dispatcher(coalescing_listener_dispatcher&&) = delete;
+
+  inline ~coalescing_listener_dispatcher() { disconnect(); }
+
+  coalescing_listener_dispatcher& operator=(const coalescing_listener_dispatcher&) = delete;
+  coalescing_listener_dispatcher& operator=(coalescing_listener_dispatcher&&) = delete;
+
+  /// Flushes every tick_count ticks of evt_manager.
+  inline void connect(event_manager& evt_manager, std::size_t tick_count = 1) {
+    disconnect();
+    _connection = event_manager::disconnector(
+        evt_manager, evt_manager.add_recurrent_event([this]() { flush(); }, tick_count));
+  }
+
+  /// Waits for a flush that is running on the event_manager, mustn't be called from a listener.
+  inline void disconnect() { _connection.disconnect(); }
+
+  inline void post(const key_type& key, const mapped_type& value) { _pending.emplace(key, value); }
+  inline void post(key_type&& key, mapped_type&& value) { _pending.emplace(std::move(key), std::move(value)); }
+
+  /// Delivers the queued notifications, does nothing if another flush is running.
+  inline void flush() {
+    if (_is_flushing.exchange(true, std::memory_order_acquire)) {
+      return;
+    }
+
+    value_type notification;
+    while (_pending.try_pop(notification)) {
+      auto [it, is_new] = _indexes.try_emplace(notification.first, _batch.size());
+      if (is_new) {
+        _batch.push_back(std::move(notification));
+      }
+      else {
+        _batch[it->second].second = std::move(notification.second);
+      }
+    }
+
+    if (!_batch.empty()) {
+      const batch_type batch(_batch.data(), _batch.size());
+      _listeners.notify([&](listener* l) { (l->*_fct)(batch); });
+
+      // Keeps the memory for the next batch.
+      _batch.clear();
+      _indexes.clear();
+    }
+
+    _is_flushing.store(false, std::memory_order_release);
+  }
+
+private:
+  listener_manager_type& _listeners;
+  batch_function _fct;
+  fst::mpsc_queue<value_type> _pending;
+
+  // Flush only.
+  std::atomic<bool> _is_flushing = false;
+  std::vector<value_type> _batch;
+  fst::flat_map<key_type, std::size_t> _indexes;
+
+  event_manager::disconnector _connection;
+};
+} // namespace fst.
@@ -96,6 +96,11 @@ public:
 
   mapped_file& operator=(const mapped_file&) = delete;
   inline mapped_file& operator=(mapped_file&& fb) noexcept {
+    if (this == &fb) {
+      return *this;
+    }
+
+    close();
     _data = fb._data;
     _size = fb._size;
     fb._data = nullptr;
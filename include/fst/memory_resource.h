@@ -0,0 +1,347 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+#pragma once
+#include "fst/common.h"
+#include "fst/assert.h"
+#include "fst/memory.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+// clang-format off
+#if __FST_UNISTD__
+  #include <sys/mman.h>
+#endif
+// clang-format on
+
+namespace fst {
+/// Bump allocator over a chain of blocks.
+///
+/// deallocate() is a no-op, memory is only given back by reset() or release().
+/// reset() rewinds to the first block and keeps the chain, so a steady state
+/// workload (e.g. one arena per request) stops reaching for the upstream
+/// allocator after the first few resets.
+///
+/// @code
+///   fst::monotonic_arena arena;
+///   fst::pmr_byte_vector bv(&arena);
+///   ...
+///   arena.reset();
+/// @endcode
+class monotonic_arena : public std::pmr::memory_resource {
+public:
+  static constexpr std::size_t default_block_size = 64 * 1024;
+
+  enum class backing {
+    upstream, ///< Blocks come from the upstream memory resource.
+    mmap ///< Blocks are mapped pages, upstream is used where mmap is not available.
+  };
+
+  inline explicit monotonic_arena(std::size_t block_size = default_block_size, backing __backing = backing::upstream,
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+      : _upstream(upstream)
+      , _block_size(block_size)
+      , _backing(__backing) {
+    fst_assert(upstream, "monotonic_arena upstream memory resource can't be null.");
+
+    if (_backing == backing::mmap) {
+      const std::size_t page_size = std::max<std::size_t>(memory::get_page_size(), 4096);
+      _block_size = (_block_size + page_size - 1) / page_size * page_size;
+    }
+  }
+
+  monotonic_arena(const monotonic_arena&) = delete;
+  monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+  inline ~monotonic_arena() override { release(); }
+
+  /// Makes all the memory available again while keeping the blocks.
+  inline void reset() noexcept {
+    _current = _first;
+    set_current_range();
+  }
+
+  /// Gives all the blocks back.
+  inline void release() noexcept {
+    for (block* b = _first; b;) {
+      block* next = b->next;
+      free_block(b);
+      b = next;
+    }
+
+    _first = nullptr;
+    _current = nullptr;
+    _ptr = nullptr;
+    _end = nullptr;
+  }
+
+  inline std::size_t block_count() const noexcept {
+    std::size_t count = 0;
+    for (block* b = _first; b; b = b->next) {
+      count++;
+    }
+    return count;
+  }
+
+  /// Total size of the blocks, headers included.
+  inline std::size_t capacity() const noexcept {
+    std::size_t size = 0;
+    for (block* b = _first; b; b = b->next) {
+      size += b->size;
+    }
+    return size;
+  }
+
+  inline std::pmr::memory_resource* upstream_resource() const noexcept { return _upstream; }
+
+protected:
+  inline void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    if (void* ptr = bump(bytes, alignment)) {
+      return ptr;
+    }
+
+    const std::size_t required_size = bytes + alignment + header_size;
+
+    // Moves to the next block of the chain (kept by reset()) when it is large enough.
+    if (_current && _current->next && _current->next->size >= required_size) {
+      _current = _current->next;
+      set_current_range();
+      return bump(bytes, alignment);
+    }
+
+    // Otherwise a new block is inserted after the current one.
+    block* b = allocate_block(std::max(_block_size, required_size));
+    if (_current) {
+      b->next = _current->next;
+      _current->next = b;
+    }
+    else {
+      _first = b;
+    }
+
+    _current = b;
+    set_current_range();
+    return bump(bytes, alignment);
+  }
+
+  inline void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+  inline bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+  struct block {
+    block* next;
+    std::size_t size;
+  };
+
+  static constexpr std::size_t header_size = (sizeof(block) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+  std::pmr::memory_resource* _upstream;
+  std::size_t _block_size;
+  backing _backing;
+  block* _first = nullptr;
+  block* _current = nullptr;
+  std::byte* _ptr = nullptr;
+  std::byte* _end = nullptr;
+
+  inline void* bump(std::size_t bytes, std::size_t alignment) noexcept {
+    if (!_ptr) {
+      return nullptr;
+    }
+
+    const std::uintptr_t p = reinterpret_cast<std::uintptr_t>(_ptr);
+    const std::uintptr_t aligned = (p + alignment - 1) & ~(std::uintptr_t)(alignment - 1);
+    if (aligned + bytes > reinterpret_cast<std::uintptr_t>(_end)) {
+      return nullptr;
+    }
+
+    _ptr = reinterpret_cast<std::byte*>(aligned + bytes);
+    return reinterpret_cast<void*>(aligned);
+  }
+
+  inline void set_current_range() noexcept {
+    if (_current) {
+      _ptr = reinterpret_cast<std::byte*>(_current) + header_size;
+      _end = reinterpret_cast<std::byte*>(_current) + _current->size;
+    }
+    else {
+      _ptr = nullptr;
+      _end = nullptr;
+    }
+  }
+
+  inline block* allocate_block(std::size_t size) {
+    void* ptr = nullptr;
+
+#if __FST_UNISTD__
+    if (_backing == backing::mmap) {
+      const std::size_t page_size = std::max<std::size_t>(memory::get_page_size(), 4096);
+      size = (size + page_size - 1) / page_size * page_size;
+      ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (ptr == MAP_FAILED) {
+        throw std::bad_alloc();
+      }
+    }
+#endif
+
+    if (!ptr) {
+      ptr = _upstream->allocate(size, alignof(std::max_align_t));
+    }
+
+    return new (ptr) block{ nullptr, size };
+  }
+
+  inline void free_block(block* b) noexcept {
+#if __FST_UNISTD__
+    if (_backing == backing::mmap) {
+      ::munmap(b, b->size);
+      return;
+    }
+#endif
+
+    _upstream->deallocate(b, b->size, alignof(std::max_align_t));
+  }
+};
+
+/// Fixed size chunk pool.
+///
+/// Allocations of at most chunk_size bytes are served from a free list carved out
+/// of blocks of chunks_per_block chunks, larger ones go to the upstream resource.
+/// Freed chunks go back to the free list, the blocks are only given back by release().
+class pool_allocator : public std::pmr::memory_resource {
+public:
+  static constexpr std::size_t default_chunks_per_block = 256;
+
+  inline explicit pool_allocator(std::size_t chunk_size, std::size_t chunks_per_block = default_chunks_per_block,
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+      : _upstream(upstream)
+      , _chunk_size(round_chunk_size(chunk_size))
+      , _chunks_per_block(std::max<std::size_t>(chunks_per_block, 1)) {
+    fst_assert(upstream, "pool_allocator upstream memory resource can't be null.");
+  }
+
+  pool_allocator(const pool_allocator&) = delete;
+  pool_allocator& operator=(const pool_allocator&) = delete;
+
+  inline ~pool_allocator() override { release(); }
+
+  /// Gives all the blocks back, every chunk must have been deallocated or abandoned.
+  inline void release() noexcept {
+    for (block* b = _blocks; b;) {
+      block* next = b->next;
+      _upstream->deallocate(b, block_size(), alignof(std::max_align_t));
+      b = next;
+    }
+
+    _blocks = nullptr;
+    _free_list = nullptr;
+  }
+
+  inline std::size_t chunk_size() const noexcept { return _chunk_size; }
+
+  inline std::pmr::memory_resource* upstream_resource() const noexcept { return _upstream; }
+
+protected:
+  inline void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    if (!is_pooled(bytes, alignment)) {
+      return _upstream->allocate(bytes, alignment);
+    }
+
+    if (!_free_list) {
+      add_block();
+    }
+
+    chunk* c = _free_list;
+    _free_list = c->next;
+    return c;
+  }
+
+  inline void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+    if (!is_pooled(bytes, alignment)) {
+      _upstream->deallocate(ptr, bytes, alignment);
+      return;
+    }
+
+    chunk* c = static_cast<chunk*>(ptr);
+    c->next = _free_list;
+    _free_list = c;
+  }
+
+  inline bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+  struct chunk {
+    chunk* next;
+  };
+
+  struct block {
+    block* next;
+  };
+
+  static constexpr std::size_t chunk_alignment = alignof(std::max_align_t);
+
+  std::pmr::memory_resource* _upstream;
+  std::size_t _chunk_size;
+  std::size_t _chunks_per_block;
+  block* _blocks = nullptr;
+  chunk* _free_list = nullptr;
+
+  static inline std::size_t round_chunk_size(std::size_t size) noexcept {
+    size = std::max(size, sizeof(chunk));
+    return (size + chunk_alignment - 1) & ~(chunk_alignment - 1);
+  }
+
+  inline bool is_pooled(std::size_t bytes, std::size_t alignment) const noexcept {
+    return bytes <= _chunk_size && alignment <= chunk_alignment;
+  }
+
+  // The block header takes the space of one chunk to keep the chunks aligned.
+  inline std::size_t block_size() const noexcept { return (_chunks_per_block + 1) * _chunk_size; }
+
+  inline void add_block() {
+    std::byte* data = static_cast<std::byte*>(_upstream->allocate(block_size(), alignof(std::max_align_t)));
+    block* b = new (data) block{ _blocks };
+    _blocks = b;
+
+    // Links the chunks in address order.
+    for (std::size_t i = _chunks_per_block; i > 0; i--) {
+      chunk* c = new (data + i * _chunk_size) chunk{ _free_list };
+      _free_list = c;
+    }
+  }
+};
+} // namespace fst.
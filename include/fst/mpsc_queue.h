@@ -0,0 +1,305 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+
+#pragma once
+#include "fst/assert.h"
+#include "fst/aligned_buffer.h"
+#include "fst/math.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace fst {
+namespace mpsc_detail {
+  /// Bounded ring buffer from Dmitry Vyukov.
+  /// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+  ///
+  /// Every cell holds a sequence number telling whether it's ready to be written
+  /// or read for a given position, so producers only contend on the enqueue
+  /// position and never wait on each other's writes.
+  template <typename _Tp, bool _IsMultiConsumer>
+  class bounded_ring {
+  public:
+    using value_type = _Tp;
+    using size_type = std::size_t;
+
+    inline explicit bounded_ring(size_type __capacity)
+        : _mask(fst::math::round_to_power_of_two(std::max<size_type>(__capacity, 2)) - 1)
+        , _cells(new cell[_mask + 1]) {
+      for (size_type i = 0; i <= _mask; i++) {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    bounded_ring(const bounded_ring&) = delete;
+    bounded_ring(bounded_ring&&) = delete;
+
+    inline ~bounded_ring() {
+      if constexpr (!std::is_trivially_destructible_v<value_type>) {
+        const size_type end = _enqueue.pos.load(std::memory_order_relaxed);
+        for (size_type pos = _dequeue.pos.load(std::memory_order_relaxed); pos != end; pos++) {
+          std::launder(reinterpret_cast<value_type*>(_cells[pos & _mask].data()))->~value_type();
+        }
+      }
+    }
+
+    bounded_ring& operator=(const bounded_ring&) = delete;
+    bounded_ring& operator=(bounded_ring&&) = delete;
+
+    inline size_type capacity() const noexcept { return _mask + 1; }
+
+    /// Returns false when the ring is full.
+    template <typename... _Args>
+    inline bool try_emplace(_Args&&... args) {
+      size_type pos = _enqueue.pos.load(std::memory_order_relaxed);
+      cell* c;
+
+      while (true) {
+        c = &_cells[pos & _mask];
+        const size_type seq = c->sequence.load(std::memory_order_acquire);
+        const std::intptr_t diff = (std::intptr_t)seq - (std::intptr_t)pos;
+
+        if (diff == 0) {
+          if (_enqueue.pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            break;
+          }
+        }
+        else if (diff < 0) {
+          return false;
+        }
+        else {
+          pos = _enqueue.pos.load(std::memory_order_relaxed);
+        }
+      }
+
+      ::new (c->data()) value_type(std::forward<_Args>(args)...);
+      c->sequence.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    inline bool try_push(const value_type& value) { return try_emplace(value); }
+    inline bool try_push(value_type&& value) { return try_emplace(std::move(value)); }
+
+    /// Returns false when the ring is empty.
+    inline bool try_pop(value_type& value) {
+      size_type pos = _dequeue.pos.load(std::memory_order_relaxed);
+      cell* c;
+
+      while (true) {
+        c = &_cells[pos & _mask];
+        const size_type seq = c->sequence.load(std::memory_order_acquire);
+        const std::intptr_t diff = (std::intptr_t)seq - (std::intptr_t)(pos + 1);
+
+        if (diff < 0) {
+          return false;
+        }
+
+        if constexpr (_IsMultiConsumer) {
+          if (diff == 0) {
+            if (_dequeue.pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+              break;
+            }
+          }
+          else {
+            pos = _dequeue.pos.load(std::memory_order_relaxed);
+          }
+        }
+        else {
+          // Single consumer, nobody else moves the dequeue position.
+          fst_assert(diff == 0, "Cell already read");
+          _dequeue.pos.store(pos + 1, std::memory_order_relaxed);
+          break;
+        }
+      }
+
+      value_type* ptr = std::launder(reinterpret_cast<value_type*>(c->data()));
+      value = std::move(*ptr);
+      ptr->~value_type();
+
+      // Ready to be written on the next lap.
+      c->sequence.store(pos + _mask + 1, std::memory_order_release);
+      return true;
+    }
+
+    /// Only a hint while producers are running.
+    inline bool empty() const noexcept {
+      const size_type pos = _dequeue.pos.load(std::memory_order_relaxed);
+      return _cells[pos & _mask].sequence.load(std::memory_order_acquire) != pos + 1;
+    }
+
+  private:
+    struct cell {
+      std::atomic<size_type> sequence;
+      alignas(value_type) unsigned char storage[sizeof(value_type)];
+
+      inline void* data() noexcept { return storage; }
+    };
+
+    // Producers and consumer each own a cache line.
+    struct alignas(aligned_memory::cache_line_size) position {
+      std::atomic<size_type> pos = 0;
+    };
+
+    const size_type _mask;
+    std::unique_ptr<cell[]> _cells;
+    position _enqueue;
+    position _dequeue;
+  };
+} // namespace mpsc_detail.
+
+/// Bounded lock-free multiple producers single consumer queue.
+///
+/// The capacity is rounded up to a power of two. try_push() fails when the queue
+/// is full instead of waiting, try_pop() must only be called from one thread at a time.
+template <typename _Tp>
+using bounded_mpsc_queue = mpsc_detail::bounded_ring<_Tp, false>;
+
+/// Unbounded multiple producers single consumer queue.
+/// https://www.1024cores.net/home/lock-free-algorithms/queues/non-intrusive-mpsc-node-based-queue
+///
+/// push() is a single atomic exchange and never fails. Popped nodes are
+/// recycled through a bounded lock-free pool (see reserve()), so producers
+/// only allocate when the pool is empty.
+///
+/// A push() that is still between its exchange and its link makes try_pop()
+/// return false until it completes, even if later pushes are done.
+template <typename _Tp>
+class mpsc_queue {
+public:
+  using value_type = _Tp;
+  using size_type = std::size_t;
+
+  static constexpr size_type default_recycled_capacity = 256;
+
+  inline explicit mpsc_queue(size_type recycled_capacity = default_recycled_capacity)
+      : _pool(recycled_capacity) {
+    _tail = new node;
+    _head.store(_tail, std::memory_order_relaxed);
+  }
+
+  mpsc_queue(const mpsc_queue&) = delete;
+  mpsc_queue(mpsc_queue&&) = delete;
+
+  inline ~mpsc_queue() {
+    while (node* next = _tail->next.load(std::memory_order_acquire)) {
+      delete _tail;
+      next->value()->~value_type();
+      _tail = next;
+    }
+    delete _tail;
+
+    node* n;
+    while (_pool.try_pop(n)) {
+      delete n;
+    }
+  }
+
+  mpsc_queue& operator=(const mpsc_queue&) = delete;
+  mpsc_queue& operator=(mpsc_queue&&) = delete;
+
+  /// Fills the node pool, up to its capacity, so that the next pushes don't allocate.
+  inline void reserve(size_type count) {
+    for (size_type i = 0; i < count; i++) {
+      node* n = new node;
+      if (!_pool.try_push(n)) {
+        delete n;
+        return;
+      }
+    }
+  }
+
+  template <typename... _Args>
+  inline void emplace(_Args&&... args) {
+    node* n;
+    if (!_pool.try_pop(n)) {
+      n = new node;
+    }
+
+    ::new (n->storage) value_type(std::forward<_Args>(args)...);
+    n->next.store(nullptr, std::memory_order_relaxed);
+
+    node* prev = _head.exchange(n, std::memory_order_acq_rel);
+    prev->next.store(n, std::memory_order_release);
+  }
+
+  inline void push(const value_type& value) { emplace(value); }
+  inline void push(value_type&& value) { emplace(std::move(value)); }
+
+  /// Consumer only.
+  inline bool try_pop(value_type& value) {
+    node* next = _tail->next.load(std::memory_order_acquire);
+    if (!next) {
+      return false;
+    }
+
+    // next becomes the new stub once its value is moved out.
+    value = std::move(*next->value());
+    next->value()->~value_type();
+
+    recycle(_tail);
+    _tail = next;
+    return true;
+  }
+
+  /// Consumer only.
+  inline bool empty() const noexcept { return !_tail->next.load(std::memory_order_acquire); }
+
+private:
+  struct node {
+    std::atomic<node*> next = nullptr;
+    alignas(value_type) unsigned char storage[sizeof(value_type)];
+
+    inline value_type* value() noexcept { return std::launder(reinterpret_cast<value_type*>(storage)); }
+  };
+
+  // Producers exchange _head, the consumer follows _tail.
+  alignas(aligned_memory::cache_line_size) std::atomic<node*> _head;
+  alignas(aligned_memory::cache_line_size) node* _tail;
+
+  // Popped by the producers, pushed by the consumer.
+  mpsc_detail::bounded_ring<node*, true> _pool;
+
+  inline void recycle(node* n) {
+    if (!_pool.try_push(n)) {
+      delete n;
+    }
+  }
+};
+} // namespace fst.
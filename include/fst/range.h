@@ -35,6 +35,7 @@
 #include "fst/assert.h"
 #include "fst/traits.h"
 #include <algorithm>
+#include <cmath>
 
 namespace fst {
 template <typename T>
@@ -71,7 +72,7 @@ inline constexpr range<T> make_range(T min, T max) {
 
 template <const auto& _Range>
 struct clipped_value {
-  using value_type = typename std::remove_cvref_t<decltype(_Range)>::value_type;
+  using value_type = typename fst::remove_cvref_t<decltype(_Range)>::value_type;
 
   clipped_value(value_type v)
       : value(std::clamp(v, _Range.min, _Range.max)) {}
@@ -83,7 +84,7 @@ struct clipped_value {
 
 template <const auto& _Range>
 struct assert_clipped_value {
-  using value_type = typename std::remove_cvref_t<decltype(_Range)>::value_type;
+  using value_type = typename fst::remove_cvref_t<decltype(_Range)>::value_type;
 
 #if __FST_HAS_DEBUG_ASSERT
   assert_clipped_value(value_type v) {
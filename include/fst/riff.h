@@ -0,0 +1,305 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+#pragma once
+#include "fst/assert.h"
+#include "fst/byte_reader.h"
+#include "fst/byte_view.h"
+#include "fst/mapped_file.h"
+#include "fst/verified_value.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+namespace fst {
+/// Four character code stored the way it appears in the file, as a little endian integer.
+using four_cc = std::uint32_t;
+
+inline constexpr four_cc make_four_cc(const char (&id)[5]) noexcept {
+  return (four_cc)(std::uint8_t)id[0] | ((four_cc)(std::uint8_t)id[1] << 8) | ((four_cc)(std::uint8_t)id[2] << 16)
+      | ((four_cc)(std::uint8_t)id[3] << 24);
+}
+
+inline std::string_view four_cc_name(const four_cc& id) noexcept {
+  return std::string_view(reinterpret_cast<const char*>(&id), 4);
+}
+
+struct riff_chunk {
+  four_cc id;
+
+  // Offset of the chunk content (after the 8 bytes header) from the start of the file.
+  std::size_t offset;
+
+  // Content size, without the pad byte.
+  std::size_t size;
+
+  inline std::string_view name() const noexcept { return four_cc_name(id); }
+};
+
+/// Table of the top level chunks of a RIFF file (WAVE, AVI, ...).
+///
+/// The chunk headers are walked once, the first time the index is queried, and
+/// chunk contents are handed out as byte_view slices of the original view.
+/// A truncated last chunk (e.g. a recording that was never finalized) is clamped
+/// to the available data.
+///
+/// Lazy building makes const queries not thread safe until the index is built,
+/// call build() first when sharing an index between threads.
+class riff_index {
+public:
+  using size_type = std::size_t;
+  using const_iterator = std::vector<riff_chunk>::const_iterator;
+
+  static constexpr four_cc riff_id = make_four_cc("RIFF");
+  static constexpr size_type header_size = 12;
+  static constexpr size_type chunk_header_size = 8;
+
+  riff_index() noexcept = default;
+
+  inline explicit riff_index(byte_view view) noexcept
+      : _view(view) {}
+
+  [[nodiscard]] inline byte_view view() const noexcept { return _view; }
+
+  inline void build() const {
+    if (_is_built) {
+      return;
+    }
+
+    _is_built = true;
+    fst::byte_reader reader(_view);
+
+    if (!reader.require(header_size) || reader.read_unchecked<four_cc>() != riff_id) {
+      return;
+    }
+
+    reader.skip(sizeof(std::uint32_t));
+    _form_type = reader.read_unchecked<four_cc>();
+    _is_valid = true;
+
+    while (reader.require(chunk_header_size)) {
+      const four_cc id = reader.read_unchecked<four_cc>();
+      const size_type size = reader.read_unchecked<std::uint32_t>();
+      const size_type available = size < reader.remaining() ? size : reader.remaining();
+      _chunks.push_back(riff_chunk{ id, reader.position(), available });
+
+      // Chunks are word aligned.
+      if (!reader.skip(size + (size & 1))) {
+        break;
+      }
+    }
+  }
+
+  /// True when the view starts with a RIFF header.
+  [[nodiscard]] inline bool is_valid() const {
+    build();
+    return _is_valid;
+  }
+
+  [[nodiscard]] inline four_cc form_type() const {
+    build();
+    return _form_type;
+  }
+
+  [[nodiscard]] inline const std::vector<riff_chunk>& chunks() const {
+    build();
+    return _chunks;
+  }
+
+  [[nodiscard]] inline size_type size() const { return chunks().size(); }
+  [[nodiscard]] inline bool empty() const { return chunks().empty(); }
+  inline const_iterator begin() const { return chunks().begin(); }
+  inline const_iterator end() const { return chunks().end(); }
+
+  /// First chunk with the given id or nullptr.
+  inline const riff_chunk* find(four_cc id) const {
+    for (const riff_chunk& chunk : chunks()) {
+      if (chunk.id == id) {
+        return &chunk;
+      }
+    }
+
+    return nullptr;
+  }
+
+  inline bool contains(four_cc id) const { return find(id) != nullptr; }
+
+  inline byte_view content(const riff_chunk& chunk) const noexcept {
+    return byte_view(_view.data() + chunk.offset, chunk.size);
+  }
+
+  /// Content of the first chunk with the given id, or an empty view.
+  inline byte_view content(four_cc id) const {
+    const riff_chunk* chunk = find(id);
+    return chunk ? content(*chunk) : byte_view();
+  }
+
+private:
+  byte_view _view;
+  mutable std::vector<riff_chunk> _chunks;
+  mutable four_cc _form_type = 0;
+  mutable bool _is_built = false;
+  mutable bool _is_valid = false;
+};
+
+/// WAVE file on top of a riff_index.
+/// Either maps a file with open() or wraps an existing byte_view.
+class wave_file {
+public:
+  using size_type = std::size_t;
+  using convert_options = byte_view::convert_options;
+
+  static constexpr four_cc wave_id = make_four_cc("WAVE");
+  static constexpr four_cc format_id = make_four_cc("fmt ");
+  static constexpr four_cc data_id = make_four_cc("data");
+
+  enum class format_tag : std::uint16_t {
+    pcm = 0x0001,
+    ieee_float = 0x0003,
+    alaw = 0x0006,
+    mulaw = 0x0007,
+    extensible = 0xFFFE,
+  };
+
+  struct format {
+    // For extensible files, this is the tag of the sub format.
+    format_tag tag = format_tag::pcm;
+    std::uint16_t channel_count = 0;
+    std::uint32_t sample_rate = 0;
+    std::uint32_t byte_rate = 0;
+    std::uint16_t block_align = 0;
+    std::uint16_t bits_per_sample = 0;
+
+    inline bool is_pcm() const noexcept { return tag == format_tag::pcm; }
+    inline bool is_float() const noexcept { return tag == format_tag::ieee_float; }
+  };
+
+  wave_file() noexcept = default;
+  wave_file(const wave_file&) = delete;
+  wave_file(wave_file&&) = default;
+
+  inline explicit wave_file(byte_view view) { load(view); }
+
+  wave_file& operator=(const wave_file&) = delete;
+  wave_file& operator=(wave_file&&) = default;
+
+  inline bool open(const std::filesystem::path& file_path) {
+    _file.close();
+    if (!_file.open(file_path)) {
+      load(byte_view());
+      return false;
+    }
+
+    return load(byte_view(_file.data(), _file.size()));
+  }
+
+  /// The view must outlive the wave_file.
+  inline bool load(byte_view view) {
+    _index = riff_index(view);
+    _format = format();
+    _is_valid = false;
+
+    if (!_index.is_valid() || _index.form_type() != wave_id) {
+      return false;
+    }
+
+    fst::byte_reader reader(_index.content(format_id));
+    if (!reader.require(16)) {
+      return false;
+    }
+
+    _format.tag = (format_tag)reader.read_unchecked<std::uint16_t>();
+    _format.channel_count = reader.read_unchecked<std::uint16_t>();
+    _format.sample_rate = reader.read_unchecked<std::uint32_t>();
+    _format.byte_rate = reader.read_unchecked<std::uint32_t>();
+    _format.block_align = reader.read_unchecked<std::uint16_t>();
+    _format.bits_per_sample = reader.read_unchecked<std::uint16_t>();
+
+    // WAVE_FORMAT_EXTENSIBLE : cbSize, valid bits, channel mask then the sub format GUID
+    // which starts with the actual format tag.
+    if (_format.tag == format_tag::extensible) {
+      if (!reader.skip(8) || !reader.require(sizeof(std::uint16_t))) {
+        return false;
+      }
+
+      _format.tag = (format_tag)reader.read_unchecked<std::uint16_t>();
+    }
+
+    _is_valid = _format.block_align != 0 && _index.contains(data_id);
+    return _is_valid;
+  }
+
+  [[nodiscard]] inline bool is_valid() const noexcept { return _is_valid; }
+  [[nodiscard]] inline const format& get_format() const noexcept { return _format; }
+  [[nodiscard]] inline const riff_index& index() const noexcept { return _index; }
+
+  /// Zero copy view of the interleaved sample data.
+  [[nodiscard]] inline byte_view samples() const { return _is_valid ? _index.content(data_id) : byte_view(); }
+
+  [[nodiscard]] inline size_type frame_count() const {
+    return _is_valid ? samples().size() / _format.block_align : 0;
+  }
+
+  [[nodiscard]] inline size_type bytes_per_sample() const noexcept { return (_format.bits_per_sample + 7) / 8; }
+
+  /// Options to read the samples() with byte_view::as<T, convert_options>.
+  /// Only valid for integer pcm formats.
+  inline verified_value<convert_options> pcm_convert_options() const noexcept {
+    if (!_is_valid || !_format.is_pcm()) {
+      return verified_value<convert_options>::invalid();
+    }
+
+    switch (bytes_per_sample()) {
+    case 1:
+      return convert_options::pcm_8_bit;
+    case 2:
+      return convert_options::pcm_16_bit;
+    case 3:
+      return convert_options::pcm_24_bit;
+    case 4:
+      return convert_options::pcm_32_bit;
+    }
+
+    return verified_value<convert_options>::invalid();
+  }
+
+private:
+  fst::mapped_file _file;
+  riff_index _index;
+  format _format;
+  bool _is_valid = false;
+};
+} // namespace fst.
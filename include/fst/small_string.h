@@ -40,6 +40,7 @@
 //#include "fst/string_conv.h"
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <cstring>
 #include <cstdio>
 #include <iterator>
@@ -50,10 +51,96 @@
 #include <string_view>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
 
 namespace fst {
+namespace small_string_detail {
+  /// The size is stored in the last character as the remaining capacity when it fits.
+  /// A full string then has a remaining capacity of zero which is also its null terminator.
+  template <typename _CharT, std::size_t _Size>
+  inline constexpr bool is_packed_layout
+      = _Size <= (std::size_t)std::numeric_limits<std::make_unsigned_t<_CharT>>::max();
+
+  template <bool _IsPacked>
+  struct size_field {
+    std::size_t _size = 0;
+  };
+
+  template <>
+  struct size_field<true> {};
+
+  template <typename _Word>
+  inline _Word load_word(const void* data) noexcept {
+    _Word w;
+    std::memcpy(&w, data, sizeof(_Word));
+    return w;
+  }
+
+  /// Word-wise equality of count characters.
+  template <typename _CharT>
+  inline bool equal(const _CharT* lhs, const _CharT* rhs, std::size_t count) noexcept {
+    if constexpr (sizeof(_CharT) != 1) {
+      return std::char_traits<_CharT>::compare(lhs, rhs, count) == 0;
+    }
+    else {
+      if (count >= 8) {
+        // The last word overlaps the previous one when count is not a multiple of 8.
+        for (std::size_t i = 0; i + 8 < count; i += 8) {
+          if (load_word<std::uint64_t>(lhs + i) != load_word<std::uint64_t>(rhs + i)) {
+            return false;
+          }
+        }
+
+        return load_word<std::uint64_t>(lhs + count - 8) == load_word<std::uint64_t>(rhs + count - 8);
+      }
+
+      if (count >= 4) {
+        return load_word<std::uint32_t>(lhs) == load_word<std::uint32_t>(rhs)
+            && load_word<std::uint32_t>(lhs + count - 4) == load_word<std::uint32_t>(rhs + count - 4);
+      }
+
+      for (std::size_t i = 0; i < count; i++) {
+        if (lhs[i] != rhs[i]) {
+          return false;
+        }
+      }
+
+      return true;
+    }
+  }
+
+  /// Same result as std::char_traits<_CharT>::compare, skipping equal 8 bytes words.
+  template <typename _CharT>
+  inline int compare(const _CharT* lhs, const _CharT* rhs, std::size_t count) noexcept {
+    using traits_type = std::char_traits<_CharT>;
+    if constexpr (sizeof(_CharT) != 1) {
+      return traits_type::compare(lhs, rhs, count);
+    }
+    else {
+      std::size_t i = 0;
+      for (; i + 8 <= count; i += 8) {
+        if (load_word<std::uint64_t>(lhs + i) != load_word<std::uint64_t>(rhs + i)) {
+          return traits_type::compare(lhs + i, rhs + i, 8);
+        }
+      }
+
+      return traits_type::compare(lhs + i, rhs + i, count - i);
+    }
+  }
+
+  template <typename _CharT>
+  inline int compare(const _CharT* lhs, std::size_t lhs_size, const _CharT* rhs, std::size_t rhs_size) noexcept {
+    if (int c = compare(lhs, rhs, fst::minimum(lhs_size, rhs_size))) {
+      return c;
+    }
+
+    return lhs_size == rhs_size ? 0 : (lhs_size < rhs_size ? -1 : 1);
+  }
+} // namespace small_string_detail.
+
 template <typename _CharT, std::size_t _Size>
-class basic_small_string {
+class basic_small_string
+    : private small_string_detail::size_field<small_string_detail::is_packed_layout<_CharT, _Size>> {
 public:
   using __self = basic_small_string;
   using view_type = std::basic_string_view<_CharT>;
@@ -72,6 +159,7 @@ public:
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
   static constexpr size_type maximum_size = _Size;
   static constexpr size_type npos = std::numeric_limits<size_type>::max();
+  static constexpr bool is_packed = small_string_detail::is_packed_layout<_CharT, _Size>;
 
   static_assert(!std::is_array<value_type>::value, "Character type of basic_small_string must not be an array.");
   static_assert(
@@ -80,79 +168,72 @@ public:
   static_assert(std::is_same<value_type, typename traits_type::char_type>::value,
       "traits_type::char_type must be the same type as value_type.");
 
-  constexpr basic_small_string() noexcept = default;
+  inline constexpr basic_small_string() noexcept { set_size(0); }
 
   inline constexpr basic_small_string(size_type count, value_type ch) noexcept {
     fst_assert(count <= maximum_size, "basic_small_string count must be smaller or equal to maximum_size.");
     std::fill_n(_data.data(), count, ch);
-    _size = count;
-    _data[_size] = 0;
+    set_size(count);
   }
 
-  inline constexpr basic_small_string(const basic_small_string& other) noexcept
-      : _data(other._data)
-      , _size(other._size) {}
-
-  inline constexpr basic_small_string(basic_small_string&& other) noexcept
-      : _data(std::move(other._data))
-      , _size(other._size) {
+  inline constexpr basic_small_string(const basic_small_string& other) noexcept { copy_from(other); }
 
-    other._size = 0;
-    other._data[0] = 0;
+  inline constexpr basic_small_string(basic_small_string&& other) noexcept {
+    copy_from(other);
+    other.set_size(0);
   }
 
   inline constexpr basic_small_string(const basic_small_string& other, size_type pos, size_type count = npos) noexcept {
-    fst_assert(pos <= other._size, "basic_small_string pos must be smaller or equal to size.");
-    _size = fst::minimum(count, other._size - pos);
-    std::copy_n(other._data.data() + pos, _size, _data.data());
-    _data[_size] = 0;
+    fst_assert(pos <= other.size(), "basic_small_string pos must be smaller or equal to size.");
+    const size_type __size = fst::minimum(count, other.size() - pos);
+    std::copy_n(other._data.data() + pos, __size, _data.data());
+    set_size(__size);
   }
 
   inline constexpr basic_small_string(const value_type* s) noexcept {
-    _size = c_strlen(s);
-    fst_assert(_size <= maximum_size, "basic_small_string c string must be smaller or equal to maximum_size.");
-    std::copy_n(s, _size, _data.data());
-    _data[_size] = 0;
+    const size_type __size = c_strlen(s);
+    fst_assert(__size <= maximum_size, "basic_small_string c string must be smaller or equal to maximum_size.");
+    std::copy_n(s, __size, _data.data());
+    set_size(__size);
   }
 
   inline constexpr basic_small_string(const value_type* s, size_type count) noexcept {
     fst_assert(count <= maximum_size, "basic_small_string count must be smaller or equal to maximum_size.");
     fst_assert(count <= c_strlen(s), "basic_small_string count must be smaller or equal to c string size.");
-    _size = count;
-    std::copy_n(s, _size, _data.data());
-    _data[_size] = 0;
+    std::copy_n(s, count, _data.data());
+    set_size(count);
   }
 
   template <class InputIt>
   inline constexpr basic_small_string(InputIt first, InputIt last) noexcept {
-    _size = std::distance(first, last);
+    const size_type __size = std::distance(first, last);
     fst_assert(
-        _size <= maximum_size, "basic_small_string iteration distance must be smaller or equal to maximum_size.");
-    std::copy_n(first, last, _data.data());
-    _data[_size] = 0;
+        __size <= maximum_size, "basic_small_string iteration distance must be smaller or equal to maximum_size.");
+    std::copy(first, last, _data.data());
+    set_size(__size);
   }
 
   inline constexpr basic_small_string(std::initializer_list<value_type> ilist) noexcept {
     fst_assert(ilist.size() <= maximum_size,
         "basic_small_string initializer_list size must be smaller or equal to maximum_size.");
-    _size = ilist.size();
-    std::copy_n(ilist.begin(), ilist.end(), _data.data());
-    _data[_size] = 0;
+    const size_type __size = ilist.size();
+    std::copy(ilist.begin(), ilist.end(), _data.data());
+    set_size(__size);
   }
 
   inline constexpr basic_small_string(view_type v) noexcept {
     fst_assert(v.size() <= maximum_size, "basic_small_string view size must be smaller or equal to maximum_size.");
-    _size = v.size();
-    std::copy_n(v.begin(), v.end(), _data.data());
-    _data[_size] = 0;
+    const size_type __size = v.size();
+    std::copy(v.begin(), v.end(), _data.data());
+    set_size(__size);
   }
 
   inline constexpr basic_small_string(view_type v, size_type pos, size_type count = npos) noexcept {
     fst_assert(pos <= v.size(), "basic_small_string pos must be smaller or equal to view size.");
-    _size = fst::minimum(count, v.size() - pos);
-    fst_assert(_size <= maximum_size, "basic_small_string size must be smaller or equal to maximum_size.");
-    std::copy_n(v.data() + pos, _size, _data.data());
-    _data[_size] = 0;
+    const size_type __size = fst::minimum(count, v.size() - pos);
+    fst_assert(__size <= maximum_size, "basic_small_string size must be smaller or equal to maximum_size.");
+    std::copy_n(v.data() + pos, __size, _data.data());
+    set_size(__size);
   }
 
   inline constexpr basic_small_string(const string_type& s) noexcept
@@ -174,26 +255,28 @@ public:
       : basic_small_string(view_type(t), pos, count) {}
 
   inline constexpr basic_small_string& operator=(const basic_small_string& other) noexcept {
-    _data = other._data;
-    _size = other._size;
+    if (this != &other) {
+      copy_from(other);
+    }
     return *this;
   }
 
   inline constexpr basic_small_string& operator=(basic_small_string&& other) noexcept {
-    _data = std::move(other._data);
-    _size = other._size;
-    other._size = 0;
+    if (this != &other) {
+      copy_from(other);
+      other.set_size(0);
+    }
     return *this;
   }
 
   inline constexpr basic_small_string& operator=(view_type v) noexcept {
     fst_assert(v.size() <= maximum_size, "basic_small_string view size must be smaller or equal to maximum_size.");
-    _size = v.size();
-    for (size_type i = 0; i < _size; i++) {
+    const size_type __size = v.size();
+    for (size_type i = 0; i < __size; i++) {
       _data[i] = v[i];
     }
 
-    _data[_size] = 0;
+    set_size(__size);
     return *this;
   }
 
@@ -202,17 +285,17 @@ public:
   inline constexpr basic_small_string& operator=(std::initializer_list<value_type> ilist) noexcept {
     fst_assert(ilist.size() <= maximum_size,
         "basic_small_string initializer_list size must be smaller or equal to maximum_size.");
-    _size = ilist.size();
-    std::copy_n(ilist.begin(), ilist.end(), _data.data());
-    _data[_size] = 0;
+    const size_type __size = ilist.size();
+    std::copy(ilist.begin(), ilist.end(), _data.data());
+    set_size(__size);
     return *this;
   }
 
   inline constexpr basic_small_string& operator=(const value_type* s) noexcept {
-    _size = c_strlen(s);
-    fst_assert(_size <= maximum_size, "basic_small_string c string must be smaller or equal to maximum_size.");
-    std::copy_n(s, _size, _data.data());
-    _data[_size] = 0;
+    const size_type __size = c_strlen(s);
+    fst_assert(__size <= maximum_size, "basic_small_string c string must be smaller or equal to maximum_size.");
+    std::copy_n(s, __size, _data.data());
+    set_size(__size);
     return *this;
   }
 
@@ -231,8 +314,8 @@ public:
   inline constexpr iterator begin() noexcept { return iterator(_data.data()); }
   inline constexpr const_iterator begin() const noexcept { return const_iterator(_data.data()); }
 
-  inline constexpr iterator end() noexcept { return iterator(_data.data() + _size); }
-  inline constexpr const_iterator end() const noexcept { return const_iterator(_data.data() + _size); }
+  inline constexpr iterator end() noexcept { return iterator(_data.data() + size()); }
+  inline constexpr const_iterator end() const noexcept { return const_iterator(_data.data() + size()); }
 
   inline constexpr reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
   inline constexpr const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
@@ -247,11 +330,19 @@ public:
   inline constexpr const_reverse_iterator crend() const noexcept { return rend(); }
 
   // Capacity.
-  [[nodiscard]] inline constexpr size_type size() const noexcept { return _size; }
-  [[nodiscard]] inline constexpr size_type length() const noexcept { return _size; }
+  [[nodiscard]] inline constexpr size_type size() const noexcept {
+    if constexpr (is_packed) {
+      return maximum_size - (size_type)(unsigned_value_type)_data[maximum_size];
+    }
+    else {
+      return this->_size;
+    }
+  }
+
+  [[nodiscard]] inline constexpr size_type length() const noexcept { return size(); }
   [[nodiscard]] inline constexpr size_type max_size() const noexcept { return maximum_size; }
   [[nodiscard]] inline constexpr size_type capacity() const noexcept { return maximum_size; }
-  [[nodiscard]] inline constexpr bool empty() const noexcept { return _size == 0; }
+  [[nodiscard]] inline constexpr bool empty() const noexcept { return size() == 0; }
 
   // Element access.
   inline constexpr reference at(size_type pos) {
@@ -279,22 +370,22 @@ public:
   }
 
   inline constexpr reference front() noexcept {
-    fst_assert(_size > 0, "basic_small_string::front when empty.");
+    fst_assert(size() > 0, "basic_small_string::front when empty.");
     return _data[0];
   }
   inline constexpr const_reference front() const noexcept {
-    fst_assert(_size > 0, "basic_small_string::front when empty.");
+    fst_assert(size() > 0, "basic_small_string::front when empty.");
     return _data[0];
   }
 
   inline constexpr reference back() noexcept {
-    fst_assert(_size > 0, "basic_small_string::back when empty.");
-    return _data[_size - 1];
+    fst_assert(size() > 0, "basic_small_string::back when empty.");
+    return _data[size() - 1];
   }
 
   inline constexpr const_reference back() const noexcept {
-    fst_assert(_size > 0, "basic_small_string::back when empty.");
-    return _data[_size - 1];
+    fst_assert(size() > 0, "basic_small_string::back when empty.");
+    return _data[size() - 1];
   }
 
   inline constexpr pointer data() noexcept { return _data.data(); }
@@ -304,22 +395,19 @@ public:
   // Operations.
   //
 
-  inline constexpr void clear() noexcept {
-    _data[0] = 0;
-    _size = 0;
-  }
+  inline constexpr void clear() noexcept { set_size(0); }
 
   inline constexpr void push_back(value_type c) noexcept {
     fst_assert(
-        _size + 1 <= maximum_size, "basic_small_string::push_back size would end up greather than maximum_size.");
-    _data[_size++] = c;
-    _data[_size] = 0;
+        size() + 1 <= maximum_size, "basic_small_string::push_back size would end up greather than maximum_size.");
+    const size_type __size = size();
+    _data[__size] = c;
+    set_size(__size + 1);
   }
 
   inline constexpr void pop_back() noexcept {
-    fst_assert(_size, "basic_small_string::pop_back when empty.");
-    _size--;
-    _data[_size] = 0;
+    fst_assert(size(), "basic_small_string::pop_back when empty.");
+    set_size(size() - 1);
   }
 
   //
@@ -335,37 +423,36 @@ public:
   //    return (pos <= other.size()) && (_size + fst::minimum(count, other.size() - pos) <= maximum_size);
   //  }
 
-  inline constexpr bool is_appendable(size_type count) const noexcept { return _size + count <= maximum_size; }
+  inline constexpr bool is_appendable(size_type count) const noexcept { return size() + count <= maximum_size; }
 
-  inline constexpr bool is_appendable(view_type v) const noexcept { return _size + v.size() <= maximum_size; }
+  inline constexpr bool is_appendable(view_type v) const noexcept { return size() + v.size() <= maximum_size; }
 
   inline constexpr bool is_appendable(view_type v, size_type pos, size_type count = npos) const noexcept {
-    return (pos <= v.size()) && (_size + fst::minimum(count, v.size() - pos) <= maximum_size);
+    return (pos <= v.size()) && (size() + fst::minimum(count, v.size() - pos) <= maximum_size);
   }
 
   inline constexpr basic_small_string& append(value_type c) noexcept {
     fst_assert(
-        _size + 1 <= maximum_size, "basic_small_string::push_back size would end up greather than maximum_size.");
-    _data[_size++] = c;
-    _data[_size] = 0;
+        size() + 1 <= maximum_size, "basic_small_string::push_back size would end up greather than maximum_size.");
+    const size_type __size = size();
+    _data[__size] = c;
+    set_size(__size + 1);
     return *this;
   }
 
   inline constexpr basic_small_string& append(size_type count, value_type c) noexcept {
     fst_assert(
-        _size + count <= maximum_size, "basic_small_string::append size would end up greather than maximum_size.");
-    std::fill_n(_data.data() + _size, count, c);
-    _size += count;
-    _data[_size] = 0;
+        size() + count <= maximum_size, "basic_small_string::append size would end up greather than maximum_size.");
+    std::fill_n(_data.data() + size(), count, c);
+    set_size(size() + count);
     return *this;
   }
 
   inline constexpr basic_small_string& append(const basic_small_string& other) noexcept {
-    fst_assert(_size + other.size() <= maximum_size,
+    fst_assert(size() + other.size() <= maximum_size,
         "basic_small_string::append size would end up greather than maximum_size.");
-    std::copy_n(other.data(), other.size(), _data.data() + _size);
-    _size += other.size();
-    _data[_size] = 0;
+    std::copy_n(other.data(), other.size(), _data.data() + size());
+    set_size(size() + other.size());
     return *this;
   }
 
@@ -374,21 +461,19 @@ public:
     fst_assert(pos <= other.size(), "basic_small_string pos must be smaller or equal to string size.");
     size_type o_size = fst::minimum(count, other.size() - pos);
     fst_assert(
-        _size + o_size <= maximum_size, "basic_small_string::append size would end up greather than maximum_size.");
+        size() + o_size <= maximum_size, "basic_small_string::append size would end up greather than maximum_size.");
 
-    std::copy_n(other.data() + pos, o_size, _data.data() + _size);
-    _size += o_size;
-    _data[_size] = 0;
+    std::copy_n(other.data() + pos, o_size, _data.data() + size());
+    set_size(size() + o_size);
     return *this;
   }
 
   inline constexpr basic_small_string& append(view_type v) noexcept {
     fst_assert(
-        _size + v.size() <= maximum_size, "basic_small_string::append size would end up greather than maximum_size.");
+        size() + v.size() <= maximum_size, "basic_small_string::append size would end up greather than maximum_size.");
 
-    std::copy_n(v.data(), v.size(), _data.data() + _size);
-    _size += v.size();
-    _data[_size] = 0;
+    std::copy_n(v.data(), v.size(), _data.data() + size());
+    set_size(size() + v.size());
     return *this;
   }
 
@@ -396,11 +481,10 @@ public:
     fst_assert(pos <= v.size(), "basic_small_string pos must be smaller or equal to view size.");
     size_type o_size = fst::minimum(count, v.size() - pos);
     fst_assert(
-        _size + o_size <= maximum_size, "basic_small_string::append size would end up greather than maximum_size.");
+        size() + o_size <= maximum_size, "basic_small_string::append size would end up greather than maximum_size.");
 
-    std::copy_n(v.data() + pos, o_size, _data.data() + _size);
-    _size += o_size;
-    _data[_size] = 0;
+    std::copy_n(v.data() + pos, o_size, _data.data() + size());
+    set_size(size() + o_size);
     return *this;
   }
 
@@ -462,58 +546,54 @@ public:
   // Insert.
   //
   inline constexpr basic_small_string& insert(size_type index, size_type count, value_type c) {
-    fst_assert(index <= _size, "basic_small_string::insert index out of bounds.");
+    fst_assert(index <= size(), "basic_small_string::insert index out of bounds.");
     fst_assert(
-        count + _size <= maximum_size, "basic_small_string::insert size would end up greather than maximum_size.");
-    size_type delta = _size - index;
+        count + size() <= maximum_size, "basic_small_string::insert size would end up greather than maximum_size.");
+    size_type delta = size() - index;
     std::memmove(
         (void*)(_data.data() + index + count), (const void*)(_data.data() + index), delta * sizeof(value_type));
     std::fill_n(_data.data() + index, count, c);
-    _size += count;
-    _data[_size] = 0;
+    set_size(size() + count);
     return *this;
   }
 
   inline constexpr basic_small_string& insert(size_type index, view_type v) {
-    fst_assert(index <= _size, "basic_small_string::insert index out of bounds.");
+    fst_assert(index <= size(), "basic_small_string::insert index out of bounds.");
     fst_assert(
-        v.size() + _size <= maximum_size, "basic_small_string::insert size would end up greather than maximum_size.");
-    size_type delta = _size - index;
+        v.size() + size() <= maximum_size, "basic_small_string::insert size would end up greather than maximum_size.");
+    size_type delta = size() - index;
     std::memmove(
         (void*)(_data.data() + index + v.size()), (const void*)(_data.data() + index), delta * sizeof(value_type));
     std::copy_n(v.data(), v.size(), _data.data() + index);
-    _size += v.size();
-    _data[_size] = 0;
+    set_size(size() + v.size());
     return *this;
   }
 
   inline constexpr basic_small_string& insert(size_type index, view_type v, size_type count) {
-    fst_assert(index <= _size, "basic_small_string::insert index out of bounds.");
+    fst_assert(index <= size(), "basic_small_string::insert index out of bounds.");
     fst_assert(count <= v.size(), "basic_small_string::insert count out of bounds.");
     fst_assert(
-        count + _size <= maximum_size, "basic_small_string::insert size would end up greather than maximum_size.");
-    size_type delta = _size - index;
+        count + size() <= maximum_size, "basic_small_string::insert size would end up greather than maximum_size.");
+    size_type delta = size() - index;
     std::memmove(
         (void*)(_data.data() + index + count), (const void*)(_data.data() + index), delta * sizeof(value_type));
     std::copy_n(v.data(), count, _data.data() + index);
-    _size += count;
-    _data[_size] = 0;
+    set_size(size() + count);
     return *this;
   }
 
   inline constexpr basic_small_string& insert(size_type index, view_type v, size_type index_str, size_type count) {
-    fst_assert(index <= _size, "basic_small_string::insert index out of bounds.");
+    fst_assert(index <= size(), "basic_small_string::insert index out of bounds.");
     fst_assert(index_str <= v.size(), "basic_small_string::insert index_str out of bounds.");
     size_type s_size = fst::minimum(count, v.size() - index_str);
     fst_assert(
-        s_size + _size <= maximum_size, "basic_small_string::insert size would end up greather than maximum_size.");
+        s_size + size() <= maximum_size, "basic_small_string::insert size would end up greather than maximum_size.");
 
-    size_type delta = _size - index;
+    size_type delta = size() - index;
     std::memmove(
         (void*)(_data.data() + index + s_size), (const void*)(_data.data() + index), delta * sizeof(value_type));
     std::copy_n(v.data() + index_str, s_size, _data.data() + index);
-    _size += s_size;
-    _data[_size] = 0;
+    set_size(size() + s_size);
     return *this;
   }
 
@@ -526,32 +606,30 @@ public:
   }
 
   inline constexpr basic_small_string& insert(size_type index, const basic_small_string& str) {
-    fst_assert(index <= _size, "basic_small_string::insert index out of bounds.");
+    fst_assert(index <= size(), "basic_small_string::insert index out of bounds.");
     fst_assert(
-        str.size() + _size <= maximum_size, "basic_small_string::insert size would end up greather than maximum_size.");
-    size_type delta = _size - index;
+        str.size() + size() <= maximum_size, "basic_small_string::insert size would end up greather than maximum_size.");
+    size_type delta = size() - index;
     std::memmove(
         (void*)(_data.data() + index + str.size()), (const void*)(_data.data() + index), delta * sizeof(value_type));
     std::copy_n(str.data(), str.size(), _data.data() + index);
-    _size += str.size();
-    _data[_size] = 0;
+    set_size(size() + str.size());
     return *this;
   }
 
   inline constexpr basic_small_string& insert(
       size_type index, const basic_small_string& str, size_type index_str, size_type count = npos) {
-    fst_assert(index <= _size, "basic_small_string::insert index out of bounds.");
+    fst_assert(index <= size(), "basic_small_string::insert index out of bounds.");
     fst_assert(index_str <= str.size(), "basic_small_string::insert index_str out of bounds.");
     size_type s_size = fst::minimum(count, str.size() - index_str);
     fst_assert(
-        s_size + _size <= maximum_size, "basic_small_string::insert size would end up greather than maximum_size.");
+        s_size + size() <= maximum_size, "basic_small_string::insert size would end up greather than maximum_size.");
 
-    size_type delta = _size - index;
+    size_type delta = size() - index;
     std::memmove(
         (void*)(_data.data() + index + s_size), (const void*)(_data.data() + index), delta * sizeof(value_type));
     std::copy_n(str.data() + index_str, s_size, _data.data() + index);
-    _size += s_size;
-    _data[_size] = 0;
+    set_size(size() + s_size);
     return *this;
   }
 
@@ -582,13 +660,12 @@ public:
   //
   //
   inline constexpr basic_small_string& erase(size_type index = 0, size_type count = npos) {
-    fst_assert(index <= _size, "basic_small_string::insert index out of bounds.");
-    size_type s_size = fst::minimum(count, _size - index);
-    size_type delta = _size - s_size;
+    fst_assert(index <= size(), "basic_small_string::insert index out of bounds.");
+    size_type s_size = fst::minimum(count, size() - index);
+    size_type delta = size() - s_size;
     std::memmove(
         (void*)(_data.data() + index), (const void*)(_data.data() + index + s_size), delta * sizeof(value_type));
-    _size -= s_size;
-    _data[_size] = 0;
+    set_size(size() - s_size);
     return *this;
   }
 
@@ -600,14 +677,13 @@ public:
   //
   inline constexpr void resize(size_type count, value_type c = value_type()) {
     fst_assert(count <= maximum_size, "basic_small_string::resize count must be smaller or equal to maximum_size.");
-    if (count < _size) {
-      _size = count;
-      _data[_size] = 0;
+    const size_type __size = size();
+    if (count < __size) {
+      set_size(count);
     }
-    else if (count > _size) {
-      std::fill_n(_data.data() + _size, count - _size, c);
-      _size = count;
-      _data[_size] = 0;
+    else if (count > __size) {
+      std::fill_n(_data.data() + __size, count - __size, c);
+      set_size(count);
     }
   }
 
@@ -615,13 +691,13 @@ public:
   //
   //
   inline constexpr void to_upper_case() {
-    for (std::size_t i = 0; i < _size; i++) {
+    for (std::size_t i = 0; i < size(); i++) {
       _data[i] = fst::to_upper_case(_data[i]);
     }
   }
 
   inline constexpr void to_lower_case() {
-    for (std::size_t i = 0; i < _size; i++) {
+    for (std::size_t i = 0; i < size(); i++) {
       _data[i] = fst::to_lower_case(_data[i]);
     }
   }
@@ -701,9 +777,39 @@ public:
   }
 
 private:
+  using unsigned_value_type = std::make_unsigned_t<value_type>;
   static constexpr size_type maximum_size_with_escape_char = maximum_size + 1;
+
+  // Buffers up to this size are always copied entirely.
+  static constexpr size_type full_copy_size = 32;
+
   std::array<value_type, maximum_size_with_escape_char> _data;
-  std::size_t _size = 0;
+
+  inline constexpr void set_size(size_type __size) noexcept {
+    _data[__size] = 0;
+
+    if constexpr (is_packed) {
+      _data[maximum_size] = (value_type)(unsigned_value_type)(maximum_size - __size);
+    }
+    else {
+      this->_size = __size;
+    }
+  }
+
+  inline constexpr void copy_from(const basic_small_string& other) noexcept {
+    const size_type __size = other.size();
+
+    if constexpr (sizeof(_data) <= full_copy_size) {
+      _data = other._data;
+    }
+    else {
+      // Only the used part rounded up to 16 bytes blocks, the null terminator included.
+      const size_type byte_size = ((__size + 1) * sizeof(value_type) + 15) & ~size_type(15);
+      std::memcpy(_data.data(), other._data.data(), fst::minimum(byte_size, sizeof(_data)));
+    }
+
+    set_size(__size);
+  }
 
   inline constexpr size_type c_strlen(const char* str) noexcept { return *str ? 1 + c_strlen(str + 1) : 0; }
 };
@@ -714,8 +820,7 @@ private:
 template <class _CharT, std::size_t _Size>
 inline bool operator==(
     const basic_small_string<_CharT, _Size>& __lhs, const basic_small_string<_CharT, _Size>& __rhs) noexcept {
-  using view_type = typename basic_small_string<_CharT, _Size>::view_type;
-  return (__lhs.size() == __rhs.size()) && (view_type(__lhs) == view_type(__rhs));
+  return (__lhs.size() == __rhs.size()) && small_string_detail::equal(__lhs.data(), __rhs.data(), __lhs.size());
 }
 
 template <class _CharT, std::size_t _Size>
@@ -755,8 +860,7 @@ inline bool operator!=(const _CharT* __lhs, const basic_small_string<_CharT, _Si
 template <class _CharT, std::size_t _Size>
 inline bool operator<(
     const basic_small_string<_CharT, _Size>& __lhs, const basic_small_string<_CharT, _Size>& __rhs) noexcept {
-  using view_type = typename basic_small_string<_CharT, _Size>::view_type;
-  return view_type(__lhs).compare(view_type(__rhs)) < 0;
+  return small_string_detail::compare(__lhs.data(), __lhs.size(), __rhs.data(), __rhs.size()) < 0;
 }
 
 template <class _CharT, std::size_t _Size>
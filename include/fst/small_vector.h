@@ -0,0 +1,548 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+#pragma once
+#include "fst/assert.h"
+#include "fst/traits.h"
+#include "fst/aligned_buffer.h"
+#include "fst/span.h"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <initializer_list>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+
+namespace fst {
+/// Contiguous container keeping its first _InlineSize elements inside the object.
+///
+/// Once full it spills to a heap buffer grown geometrically, like std::vector.
+/// Trivially copyable types are relocated with memcpy/memmove, other types are
+/// move constructed into the new storage.
+///
+/// The heap buffer comes from _Allocator, pmr_small_vector takes a
+/// std::pmr::memory_resource such as fst::monotonic_arena.
+template <typename _Tp, std::size_t _InlineSize, typename _Allocator = std::allocator<_Tp>>
+class small_vector : private _Allocator {
+public:
+  using value_type = _Tp;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using allocator_type = _Allocator;
+
+  static constexpr size_type inline_size = _InlineSize;
+  static_assert(inline_size > 0, "small_vector inline size must be greater than 0");
+
+  static constexpr bool is_trivially_relocatable = std::is_trivially_copyable<value_type>::value;
+
+private:
+  // Keeps insert(pos, count, value) from matching the iterator range overloads.
+  template <class _InputIt>
+  using enable_if_input_iterator = std::enable_if_t<
+      std::is_base_of<std::input_iterator_tag, typename std::iterator_traits<_InputIt>::iterator_category>::value>;
+
+public:
+  small_vector() noexcept = default;
+
+  inline explicit small_vector(const allocator_type& alloc) noexcept
+      : allocator_type(alloc) {}
+
+  inline explicit small_vector(size_type size, const allocator_type& alloc = allocator_type())
+      : allocator_type(alloc) {
+    resize(size);
+  }
+
+  inline small_vector(size_type size, const value_type& value, const allocator_type& alloc = allocator_type())
+      : allocator_type(alloc) {
+    resize(size, value);
+  }
+
+  template <class _InputIt, class = enable_if_input_iterator<_InputIt>>
+  inline small_vector(_InputIt first, _InputIt last, const allocator_type& alloc = allocator_type())
+      : allocator_type(alloc) {
+    insert(end(), first, last);
+  }
+
+  inline small_vector(std::initializer_list<value_type> ilist, const allocator_type& alloc = allocator_type())
+      : allocator_type(alloc) {
+    insert(end(), ilist.begin(), ilist.end());
+  }
+
+  inline small_vector(const small_vector& sv)
+      : allocator_type(alloc_traits::select_on_container_copy_construction(sv.get_allocator())) {
+    reserve(sv._size);
+    copy_construct(sv.begin(), sv.end(), _data);
+    _size = sv._size;
+  }
+
+  inline small_vector(small_vector&& sv) noexcept
+      : allocator_type(std::move(sv.get_allocator_ref())) {
+    steal(sv);
+  }
+
+  inline ~small_vector() {
+    destroy_range(_data, _data + _size);
+    release();
+  }
+
+  inline small_vector& operator=(const small_vector& sv) {
+    if (this == &sv) {
+      return *this;
+    }
+
+    clear();
+    reserve(sv._size);
+    copy_construct(sv.begin(), sv.end(), _data);
+    _size = sv._size;
+    return *this;
+  }
+
+  inline small_vector& operator=(small_vector&& sv) {
+    if (this == &sv) {
+      return *this;
+    }
+
+    clear();
+
+    if constexpr (!alloc_traits::propagate_on_container_move_assignment::value) {
+      // The heap buffer of sv can't be taken when it comes from another resource.
+      if (!sv.is_inline() && get_allocator_ref() != sv.get_allocator_ref()) {
+        reserve(sv._size);
+        relocate(sv._data, sv._size, _data);
+        _size = sv._size;
+        sv._size = 0;
+        return *this;
+      }
+    }
+
+    release();
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+      get_allocator_ref() = std::move(sv.get_allocator_ref());
+    }
+    steal(sv);
+    return *this;
+  }
+
+  inline small_vector& operator=(std::initializer_list<value_type> ilist) {
+    assign(ilist.begin(), ilist.end());
+    return *this;
+  }
+
+  inline allocator_type get_allocator() const noexcept { return get_allocator_ref(); }
+
+  // Iterators.
+  inline iterator begin() noexcept { return _data; }
+  inline const_iterator begin() const noexcept { return _data; }
+
+  inline iterator end() noexcept { return _data + _size; }
+  inline const_iterator end() const noexcept { return _data + _size; }
+
+  inline reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  inline const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+
+  inline reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  inline const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+  inline const_iterator cbegin() const noexcept { return begin(); }
+  inline const_iterator cend() const noexcept { return end(); }
+
+  // Capacity.
+  [[nodiscard]] inline size_type size() const noexcept { return _size; }
+  [[nodiscard]] inline size_type capacity() const noexcept { return _capacity; }
+  [[nodiscard]] inline bool empty() const noexcept { return _size == 0; }
+  [[nodiscard]] inline constexpr size_type max_size() const noexcept {
+    return std::numeric_limits<difference_type>::max() / sizeof(value_type);
+  }
+
+  /// True while the elements live in the inline buffer.
+  [[nodiscard]] inline bool is_inline() const noexcept { return _data == _inline_data.data(); }
+
+  inline void reserve(size_type count) {
+    if (count > _capacity) {
+      reallocate(count);
+    }
+  }
+
+  /// Moves the elements back to the inline buffer when they fit, otherwise
+  /// shrinks the heap buffer to size().
+  inline void shrink_to_fit() {
+    if (!is_inline() && _size < _capacity) {
+      reallocate(_size);
+    }
+  }
+
+  // Element access.
+  inline reference operator[](size_type n) noexcept {
+    fst_assert(n < _size, "small_vector::operator[] Index out of bounds");
+    return _data[n];
+  }
+
+  inline const_reference operator[](size_type n) const noexcept {
+    fst_assert(n < _size, "small_vector::operator[] Index out of bounds");
+    return _data[n];
+  }
+
+  inline reference at(size_type n) {
+    if (n >= _size) {
+      throw std::out_of_range("small_vector::at");
+    }
+    return _data[n];
+  }
+
+  inline const_reference at(size_type n) const {
+    if (n >= _size) {
+      throw std::out_of_range("small_vector::at");
+    }
+    return _data[n];
+  }
+
+  inline reference front() noexcept {
+    fst_assert(_size > 0, "small_vector::front when empty.");
+    return _data[0];
+  }
+
+  inline const_reference front() const noexcept {
+    fst_assert(_size > 0, "small_vector::front when empty.");
+    return _data[0];
+  }
+
+  inline reference back() noexcept {
+    fst_assert(_size > 0, "small_vector::back when empty.");
+    return _data[_size - 1];
+  }
+
+  inline const_reference back() const noexcept {
+    fst_assert(_size > 0, "small_vector::back when empty.");
+    return _data[_size - 1];
+  }
+
+  inline pointer data() noexcept { return _data; }
+  inline const_pointer data() const noexcept { return _data; }
+
+  inline fst::span<value_type> to_span() noexcept { return fst::span<value_type>(_data, _size); }
+  inline fst::span<const value_type> to_span() const noexcept { return fst::span<const value_type>(_data, _size); }
+
+  // Modifiers.
+  inline void clear() noexcept {
+    destroy_range(_data, _data + _size);
+    _size = 0;
+  }
+
+  template <typename... _Args>
+  inline reference emplace_back(_Args&&... args) {
+    if (_size < _capacity) {
+      new (_data + _size) value_type(std::forward<_Args>(args)...);
+    }
+    else {
+      // The new element is constructed before relocating the others since args
+      // may refer to an element of this vector.
+      const size_type new_capacity = grown_capacity(_size + 1);
+      pointer new_data = alloc_traits::allocate(get_allocator_ref(), new_capacity);
+      new (new_data + _size) value_type(std::forward<_Args>(args)...);
+      relocate(_data, _size, new_data);
+      release();
+      _data = new_data;
+      _capacity = new_capacity;
+    }
+
+    return _data[_size++];
+  }
+
+  inline void push_back(const value_type& value) { emplace_back(value); }
+
+  inline void push_back(value_type&& value) { emplace_back(std::move(value)); }
+
+  inline void pop_back() noexcept {
+    fst_assert(_size > 0, "small_vector::pop_back when empty.");
+    _data[--_size].~value_type();
+  }
+
+  inline void resize(size_type count) {
+    if (count < _size) {
+      destroy_range(_data + count, _data + _size);
+    }
+    else {
+      reserve(grown_capacity(count));
+      std::uninitialized_value_construct(_data + _size, _data + count);
+    }
+    _size = count;
+  }
+
+  inline void resize(size_type count, const value_type& value) {
+    if (count < _size) {
+      destroy_range(_data + count, _data + _size);
+      _size = count;
+    }
+    else if (count > _size) {
+      insert(end(), count - _size, value);
+    }
+  }
+
+  template <typename... _Args>
+  inline iterator emplace(const_iterator pos, _Args&&... args) {
+    const size_type index = (size_type)(pos - _data);
+    fst_assert(index <= _size, "small_vector::emplace Out of bound position.");
+
+    if constexpr (is_trivially_relocatable) {
+      // args may refer to an element of this vector.
+      value_type v(std::forward<_Args>(args)...);
+      new (make_gap(index, 1)) value_type(v);
+    }
+    else {
+      emplace_back(std::forward<_Args>(args)...);
+      std::rotate(_data + index, _data + _size - 1, _data + _size);
+    }
+    return _data + index;
+  }
+
+  inline iterator insert(const_iterator pos, const value_type& value) { return emplace(pos, value); }
+
+  inline iterator insert(const_iterator pos, value_type&& value) { return emplace(pos, std::move(value)); }
+
+  inline iterator insert(const_iterator pos, size_type count, const value_type& value) {
+    const size_type index = (size_type)(pos - _data);
+    fst_assert(index <= _size, "small_vector::insert Out of bound position.");
+
+    // value may refer to an element of this vector.
+    const value_type v = value;
+
+    if constexpr (is_trivially_relocatable) {
+      std::uninitialized_fill_n(make_gap(index, count), count, v);
+    }
+    else {
+      const size_type old_size = _size;
+      reserve(grown_capacity(_size + count));
+      std::uninitialized_fill_n(_data + _size, count, v);
+      _size += count;
+      std::rotate(_data + index, _data + old_size, _data + _size);
+    }
+    return _data + index;
+  }
+
+  template <class _InputIt, class = enable_if_input_iterator<_InputIt>>
+  inline iterator insert(const_iterator pos, _InputIt first, _InputIt last) {
+    const size_type index = (size_type)(pos - _data);
+    fst_assert(index <= _size, "small_vector::insert Out of bound position.");
+
+    if constexpr (is_random_access_iterator<_InputIt>::value && is_trivially_relocatable) {
+      const size_type count = (size_type)std::distance(first, last);
+      std::uninitialized_copy(first, last, make_gap(index, count));
+      return _data + index;
+    }
+
+    // Appends the values and rotates them into place.
+    const size_type old_size = _size;
+    if constexpr (is_random_access_iterator<_InputIt>::value) {
+      const size_type count = (size_type)std::distance(first, last);
+      reserve(grown_capacity(_size + count));
+      std::uninitialized_copy(first, last, _data + _size);
+      _size += count;
+    }
+    else {
+      for (; first != last; ++first) {
+        emplace_back(*first);
+      }
+    }
+
+    std::rotate(_data + index, _data + old_size, _data + _size);
+    return _data + index;
+  }
+
+  inline iterator insert(const_iterator pos, std::initializer_list<value_type> ilist) {
+    return insert(pos, ilist.begin(), ilist.end());
+  }
+
+  inline void append(fst::span<const value_type> values) { insert(end(), values.begin(), values.end()); }
+
+  template <class _InputIt, class = enable_if_input_iterator<_InputIt>>
+  inline void assign(_InputIt first, _InputIt last) {
+    clear();
+    insert(end(), first, last);
+  }
+
+  inline void assign(size_type count, const value_type& value) {
+    clear();
+    insert(end(), count, value);
+  }
+
+  inline void assign(std::initializer_list<value_type> ilist) { assign(ilist.begin(), ilist.end()); }
+
+  inline iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+  inline iterator erase(const_iterator first, const_iterator last) {
+    const size_type index = (size_type)(first - _data);
+    const size_type count = (size_type)(last - first);
+    fst_assert(index + count <= _size, "small_vector::erase Out of bound range.");
+
+    if (!count) {
+      return _data + index;
+    }
+
+    if constexpr (is_trivially_relocatable) {
+      std::memmove((void*)(_data + index), _data + index + count, (_size - index - count) * sizeof(value_type));
+    }
+    else {
+      std::move(_data + index + count, _data + _size, _data + index);
+      destroy_range(_data + _size - count, _data + _size);
+    }
+
+    _size -= count;
+    return _data + index;
+  }
+
+  inline bool operator==(const small_vector& sv) const {
+    return _size == sv._size && std::equal(begin(), end(), sv.begin());
+  }
+
+  inline bool operator!=(const small_vector& sv) const { return !operator==(sv); }
+
+private:
+  fst::stack_buffer<value_type, inline_size> _inline_data;
+  pointer _data = _inline_data.data();
+  size_type _size = 0;
+  size_type _capacity = inline_size;
+
+  using alloc_traits = std::allocator_traits<allocator_type>;
+
+  inline allocator_type& get_allocator_ref() noexcept { return *this; }
+  inline const allocator_type& get_allocator_ref() const noexcept { return *this; }
+
+  static inline void destroy_range(pointer first, pointer last) noexcept {
+    if constexpr (!std::is_trivially_destructible<value_type>::value) {
+      for (; first != last; ++first) {
+        first->~value_type();
+      }
+    }
+  }
+
+  template <typename _It>
+  static inline void copy_construct(_It first, _It last, pointer dst) {
+    if constexpr (is_trivially_relocatable) {
+      std::memcpy((void*)dst, first, (size_type)(last - first) * sizeof(value_type));
+    }
+    else {
+      std::uninitialized_copy(first, last, dst);
+    }
+  }
+
+  /// Moves count elements from src to the uninitialized dst and destroys the sources.
+  static inline void relocate(pointer src, size_type count, pointer dst) noexcept {
+    if constexpr (is_trivially_relocatable) {
+      std::memcpy((void*)dst, src, count * sizeof(value_type));
+    }
+    else {
+      for (size_type i = 0; i < count; i++) {
+        new (dst + i) value_type(std::move(src[i]));
+        src[i].~value_type();
+      }
+    }
+  }
+
+  inline size_type grown_capacity(size_type count) const noexcept {
+    return count > _capacity ? std::max(count, _capacity * 2) : _capacity;
+  }
+
+  inline void reallocate(size_type count) {
+    pointer new_data;
+    size_type new_capacity;
+
+    if (count <= inline_size) {
+      new_data = _inline_data.data();
+      new_capacity = inline_size;
+    }
+    else {
+      new_data = alloc_traits::allocate(get_allocator_ref(), count);
+      new_capacity = count;
+    }
+
+    if (new_data != _data) {
+      relocate(_data, _size, new_data);
+      release();
+      _data = new_data;
+      _capacity = new_capacity;
+    }
+  }
+
+  /// Opens count uninitialized slots at index with a single memmove of the tail.
+  /// Only used for trivially relocatable types.
+  inline pointer make_gap(size_type index, size_type count) {
+    reserve(grown_capacity(_size + count));
+    std::memmove((void*)(_data + index + count), _data + index, (_size - index) * sizeof(value_type));
+    _size += count;
+    return _data + index;
+  }
+
+  inline void release() noexcept {
+    if (!is_inline()) {
+      alloc_traits::deallocate(get_allocator_ref(), _data, _capacity);
+      _data = _inline_data.data();
+      _capacity = inline_size;
+    }
+  }
+
+  inline void steal(small_vector& sv) noexcept {
+    if (sv.is_inline()) {
+      relocate(sv._data, sv._size, _inline_data.data());
+      _data = _inline_data.data();
+      _capacity = inline_size;
+    }
+    else {
+      _data = sv._data;
+      _capacity = sv._capacity;
+      sv._data = sv._inline_data.data();
+      sv._capacity = inline_size;
+    }
+
+    _size = sv._size;
+    sv._size = 0;
+  }
+};
+
+/// small_vector spilling to a std::pmr::memory_resource.
+template <typename _Tp, std::size_t _InlineSize>
+using pmr_small_vector = small_vector<_Tp, _InlineSize, std::pmr::polymorphic_allocator<_Tp>>;
+} // namespace fst.
@@ -0,0 +1,340 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+#pragma once
+#include "fst/assert.h"
+#include "fst/math.h"
+#include "fst/span.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace fst {
+/// Structure-of-arrays vector, each field is stored in its own column.
+///
+/// All columns share a single allocation and each one starts on a
+/// column_alignment boundary so they can be processed with aligned SIMD loads.
+/// Rows are accessed through a tuple of references.
+///
+/// @code
+///   fst::soa_vector<float, float, int> particles;
+///   particles.push_back(0.0f, 1.0f, 2);
+///
+///   for (float& x : particles.column<0>()) {
+///     x += 1.0f;
+///   }
+///
+///   auto [x, y, id] = particles[0];
+/// @endcode
+template <typename... _Fields>
+class soa_vector {
+public:
+  using size_type = std::size_t;
+  using value_type = std::tuple<_Fields...>;
+  using reference = std::tuple<_Fields&...>;
+  using const_reference = std::tuple<const _Fields&...>;
+
+  static constexpr size_type field_count = sizeof...(_Fields);
+  static constexpr size_type column_alignment = 64;
+
+  template <size_type _Index>
+  using field_type = std::tuple_element_t<_Index, value_type>;
+
+  static_assert(field_count > 0, "soa_vector requires at least one field");
+  static_assert(std::conjunction<std::is_trivially_copyable<_Fields>...>::value,
+      "soa_vector fields must be trivially copyable");
+  static_assert(((alignof(_Fields) <= column_alignment) && ...), "soa_vector field alignment is too big");
+
+  soa_vector() noexcept = default;
+
+  inline explicit soa_vector(size_type size) { resize(size); }
+
+  inline soa_vector(const soa_vector& v) {
+    reserve(v._size);
+    copy_columns(v, std::index_sequence_for<_Fields...>());
+    _size = v._size;
+  }
+
+  inline soa_vector(soa_vector&& v) noexcept
+      : _buffer(v._buffer)
+      , _columns(v._columns)
+      , _size(v._size)
+      , _capacity(v._capacity) {
+    v._buffer = nullptr;
+    v._columns = {};
+    v._size = 0;
+    v._capacity = 0;
+  }
+
+  inline ~soa_vector() { deallocate(_buffer); }
+
+  inline soa_vector& operator=(const soa_vector& v) {
+    if (this == &v) {
+      return *this;
+    }
+
+    _size = 0;
+    reserve(v._size);
+    copy_columns(v, std::index_sequence_for<_Fields...>());
+    _size = v._size;
+    return *this;
+  }
+
+  inline soa_vector& operator=(soa_vector&& v) noexcept {
+    if (this == &v) {
+      return *this;
+    }
+
+    deallocate(_buffer);
+    _buffer = v._buffer;
+    _columns = v._columns;
+    _size = v._size;
+    _capacity = v._capacity;
+    v._buffer = nullptr;
+    v._columns = {};
+    v._size = 0;
+    v._capacity = 0;
+    return *this;
+  }
+
+  // Capacity.
+  [[nodiscard]] inline size_type size() const noexcept { return _size; }
+  [[nodiscard]] inline size_type capacity() const noexcept { return _capacity; }
+  [[nodiscard]] inline bool empty() const noexcept { return _size == 0; }
+
+  inline void reserve(size_type count) {
+    if (count > _capacity) {
+      reallocate(count);
+    }
+  }
+
+  // Column access.
+  template <size_type _Index>
+  inline field_type<_Index>* data() noexcept {
+    return std::get<_Index>(_columns);
+  }
+
+  template <size_type _Index>
+  inline const field_type<_Index>* data() const noexcept {
+    return std::get<_Index>(_columns);
+  }
+
+  template <size_type _Index>
+  inline fst::span<field_type<_Index>> column() noexcept {
+    return fst::span<field_type<_Index>>(data<_Index>(), _size);
+  }
+
+  template <size_type _Index>
+  inline fst::span<const field_type<_Index>> column() const noexcept {
+    return fst::span<const field_type<_Index>>(data<_Index>(), _size);
+  }
+
+  template <size_type _Index>
+  inline field_type<_Index>& get(size_type index) noexcept {
+    fst_assert(index < _size, "soa_vector::get Index out of bounds");
+    return data<_Index>()[index];
+  }
+
+  template <size_type _Index>
+  inline const field_type<_Index>& get(size_type index) const noexcept {
+    fst_assert(index < _size, "soa_vector::get Index out of bounds");
+    return data<_Index>()[index];
+  }
+
+  // Row access.
+  inline reference operator[](size_type index) noexcept {
+    fst_assert(index < _size, "soa_vector::operator[] Index out of bounds");
+    return row(index, std::index_sequence_for<_Fields...>());
+  }
+
+  inline const_reference operator[](size_type index) const noexcept {
+    fst_assert(index < _size, "soa_vector::operator[] Index out of bounds");
+    return row(index, std::index_sequence_for<_Fields...>());
+  }
+
+  inline reference front() noexcept { return operator[](0); }
+  inline const_reference front() const noexcept { return operator[](0); }
+  inline reference back() noexcept { return operator[](_size - 1); }
+  inline const_reference back() const noexcept { return operator[](_size - 1); }
+
+  // Modifiers.
+  inline void clear() noexcept { _size = 0; }
+
+  inline void push_back(const _Fields&... fields) {
+    if (_size == _capacity) {
+      // The fields may refer to a row of this vector.
+      push_back(value_type(fields...));
+      return;
+    }
+
+    set_row(_size++, std::index_sequence_for<_Fields...>(), fields...);
+  }
+
+  inline void push_back(const value_type& value) {
+    if (_size == _capacity) {
+      reallocate(std::max<size_type>(_size + 1, _capacity * 2));
+    }
+
+    std::apply([this](const _Fields&... fields) { set_row(_size++, std::index_sequence_for<_Fields...>(), fields...); },
+        value);
+  }
+
+  inline void pop_back() noexcept {
+    fst_assert(_size > 0, "soa_vector::pop_back when empty.");
+    _size--;
+  }
+
+  /// New rows are value initialized.
+  inline void resize(size_type count) {
+    if (count > _capacity) {
+      reallocate(std::max(count, _capacity * 2));
+    }
+
+    if (count > _size) {
+      fill_columns(_size, count, std::index_sequence_for<_Fields...>());
+    }
+    _size = count;
+  }
+
+  /// Erases the row at index while keeping the order of the others.
+  inline void erase(size_type index) noexcept {
+    fst_assert(index < _size, "soa_vector::erase Index out of bounds");
+    erase_row(index, std::index_sequence_for<_Fields...>());
+    _size--;
+  }
+
+  /// Erases the row at index by moving the last row in its place.
+  inline void swap_erase(size_type index) noexcept {
+    fst_assert(index < _size, "soa_vector::swap_erase Index out of bounds");
+    const size_type last = _size - 1;
+    if (index != last) {
+      operator[](index) = operator[](last);
+    }
+    _size--;
+  }
+
+private:
+  using column_pointers = std::tuple<_Fields*...>;
+
+  std::byte* _buffer = nullptr;
+  column_pointers _columns = {};
+  size_type _size = 0;
+  size_type _capacity = 0;
+
+  static inline constexpr size_type align_up(size_type size) noexcept {
+    return (size + column_alignment - 1) & ~(column_alignment - 1);
+  }
+
+  /// Total bytes for count rows, every column being padded to column_alignment.
+  static inline constexpr size_type buffer_size(size_type count) noexcept {
+    return (align_up(sizeof(_Fields) * count) + ...);
+  }
+
+  static inline std::byte* allocate(size_type size) {
+    return static_cast<std::byte*>(::operator new(size, std::align_val_t(column_alignment)));
+  }
+
+  static inline void deallocate(std::byte* buffer) noexcept {
+    if (buffer) {
+      ::operator delete(buffer, std::align_val_t(column_alignment));
+    }
+  }
+
+  template <size_type... _Is>
+  static inline column_pointers make_columns(std::byte* buffer, size_type count, std::index_sequence<_Is...>) noexcept {
+    column_pointers columns;
+    size_type offset = 0;
+    ((std::get<_Is>(columns) = reinterpret_cast<field_type<_Is>*>(buffer + offset),
+         offset += align_up(sizeof(field_type<_Is>) * count)),
+        ...);
+    return columns;
+  }
+
+  inline void reallocate(size_type count) {
+    std::byte* buffer = allocate(buffer_size(count));
+    column_pointers columns = make_columns(buffer, count, std::index_sequence_for<_Fields...>());
+    move_columns(columns, std::index_sequence_for<_Fields...>());
+
+    deallocate(_buffer);
+    _buffer = buffer;
+    _columns = columns;
+    _capacity = count;
+  }
+
+  template <size_type... _Is>
+  inline void move_columns(column_pointers& columns, std::index_sequence<_Is...>) noexcept {
+    if (_size) {
+      (std::memcpy(std::get<_Is>(columns), std::get<_Is>(_columns), _size * sizeof(field_type<_Is>)), ...);
+    }
+  }
+
+  template <size_type... _Is>
+  inline void copy_columns(const soa_vector& v, std::index_sequence<_Is...>) noexcept {
+    if (v._size) {
+      (std::memcpy(std::get<_Is>(_columns), std::get<_Is>(v._columns), v._size * sizeof(field_type<_Is>)), ...);
+    }
+  }
+
+  template <size_type... _Is>
+  inline void fill_columns(size_type first, size_type last, std::index_sequence<_Is...>) noexcept {
+    (std::fill(std::get<_Is>(_columns) + first, std::get<_Is>(_columns) + last, field_type<_Is>()), ...);
+  }
+
+  template <size_type... _Is>
+  inline void erase_row(size_type index, std::index_sequence<_Is...>) noexcept {
+    (std::memmove(std::get<_Is>(_columns) + index, std::get<_Is>(_columns) + index + 1,
+         (_size - index - 1) * sizeof(field_type<_Is>)),
+        ...);
+  }
+
+  template <size_type... _Is>
+  inline void set_row(size_type index, std::index_sequence<_Is...>, const _Fields&... fields) noexcept {
+    ((std::get<_Is>(_columns)[index] = fields), ...);
+  }
+
+  template <size_type... _Is>
+  inline reference row(size_type index, std::index_sequence<_Is...>) noexcept {
+    return reference(std::get<_Is>(_columns)[index]...);
+  }
+
+  template <size_type... _Is>
+  inline const_reference row(size_type index, std::index_sequence<_Is...>) const noexcept {
+    return const_reference(std::get<_Is>(_columns)[index]...);
+  }
+};
+} // namespace fst.
@@ -32,11 +32,200 @@
 ///
 
 #pragma once
+#include "fst/common.h"
+#include "fst/aligned_buffer.h"
+
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <limits>
+#include <thread>
+
+// clang-format off
+#if __FST_SSE2__
+  #include <emmintrin.h>
+#endif
+
+#if defined(__linux__)
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <time.h>
+  #include <unistd.h>
+#elif defined(__APPLE__)
+  // Private but stable, libc++ waits on atomics with it.
+  extern "C" int __ulock_wait(std::uint32_t operation, void* addr, std::uint64_t value, std::uint32_t timeout_us);
+  extern "C" int __ulock_wake(std::uint32_t operation, void* addr, std::uint64_t wake_value);
+#elif defined(_WIN32)
+  #include <windows.h>
+  #if defined(_MSC_VER)
+    #pragma comment(lib, "Synchronization.lib")
+  #endif
+#endif
+
+// Counts acquisitions, spins and parks of every spin_lock_mutex.
+#ifndef FST_SPIN_LOCK_STATS
+  #define FST_SPIN_LOCK_STATS 0
+#endif
+// clang-format on
 
 // https://livebook.manning.com/book/c-plus-plus-concurrency-in-action/chapter-7/7
 
 namespace fst {
+/// Tells the cpu we are in a spin loop (pause on x86, yield on arm).
+inline void cpu_relax() noexcept {
+#if __FST_SSE2__
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield");
+#endif
+}
+
+struct spin_lock_stats {
+  std::uint64_t acquisitions = 0;
+  std::uint64_t spins = 0;
+  std::uint64_t parks = 0;
+};
+
+namespace spin_lock_detail {
+  template <bool _Enabled>
+  class stats_counter {
+  public:
+    inline void add_acquisition() noexcept {}
+    inline void add_spins(std::uint64_t) noexcept {}
+    inline void add_park() noexcept {}
+    inline spin_lock_stats get() const noexcept { return {}; }
+  };
+
+  template <>
+  class stats_counter<true> {
+  public:
+    inline void add_acquisition() noexcept { _acquisitions.fetch_add(1, std::memory_order_relaxed); }
+    inline void add_spins(std::uint64_t count) noexcept { _spins.fetch_add(count, std::memory_order_relaxed); }
+    inline void add_park() noexcept { _parks.fetch_add(1, std::memory_order_relaxed); }
+
+    inline spin_lock_stats get() const noexcept {
+      return { _acquisitions.load(std::memory_order_relaxed), _spins.load(std::memory_order_relaxed),
+        _parks.load(std::memory_order_relaxed) };
+    }
+
+  private:
+    std::atomic<std::uint64_t> _acquisitions = 0;
+    std::atomic<std::uint64_t> _spins = 0;
+    std::atomic<std::uint64_t> _parks = 0;
+  };
+
+#if defined(__APPLE__)
+  static constexpr std::uint32_t ulock_compare_and_wait = 1;
+  static constexpr std::uint32_t ulock_wake_all = 0x00000100;
+  static constexpr std::uint32_t ulock_no_errno = 0x01000000;
+#endif
+
+  /// Blocks while *addr == expected (futex on linux, ulock on macos, WaitOnAddress
+  /// on windows, yield elsewhere). Can return spuriously.
+  inline void wait(std::atomic<std::uint32_t>& addr, std::uint32_t expected) noexcept {
+#if defined(__linux__)
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&addr), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#elif defined(__APPLE__)
+    ::__ulock_wait(ulock_compare_and_wait | ulock_no_errno, &addr, expected, 0);
+#elif defined(_WIN32)
+    ::WaitOnAddress(&addr, &expected, sizeof(expected), INFINITE);
+#else
+    if (addr.load(std::memory_order_relaxed) == expected) {
+      std::this_thread::yield();
+    }
+#endif
+  }
+
+  /// Blocks while *addr == expected, at most for timeout. Without a native wait
+  /// it sleeps for at most a millisecond, the caller is expected to loop.
+  inline void wait_for(
+      std::atomic<std::uint32_t>& addr, std::uint32_t expected, std::chrono::nanoseconds timeout) noexcept {
+    if (timeout <= std::chrono::nanoseconds::zero()) {
+      return;
+    }
+
+#if defined(__linux__)
+    const std::chrono::seconds sec = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    const timespec ts = { (time_t)sec.count(), (long)(timeout - sec).count() };
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&addr), FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+#elif defined(__APPLE__)
+    // 0 means no timeout.
+    const std::uint64_t us = (std::uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(timeout).count();
+    ::__ulock_wait(ulock_compare_and_wait | ulock_no_errno, &addr, expected,
+        (std::uint32_t)std::clamp<std::uint64_t>(us, 1, std::numeric_limits<std::uint32_t>::max()));
+#elif defined(_WIN32)
+    const std::uint64_t ms = (std::uint64_t)std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+    ::WaitOnAddress(&addr, &expected, sizeof(expected), (DWORD)(std::min<std::uint64_t>)(ms, INFINITE - 1));
+#else
+    if (addr.load(std::memory_order_relaxed) == expected) {
+      std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::milliseconds(1)));
+    }
+#endif
+  }
+
+  /// Wakes one thread blocked in wait().
+  inline void wake_one(std::atomic<std::uint32_t>& addr) noexcept {
+#if defined(__linux__)
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&addr), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#elif defined(__APPLE__)
+    ::__ulock_wake(ulock_compare_and_wait | ulock_no_errno, &addr, 0);
+#elif defined(_WIN32)
+    ::WakeByAddressSingle(&addr);
+#else
+    (void)addr;
+#endif
+  }
+
+  /// Wakes every thread blocked in wait().
+  inline void wake_all(std::atomic<std::uint32_t>& addr) noexcept {
+#if defined(__linux__)
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&addr), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#elif defined(__APPLE__)
+    ::__ulock_wake(ulock_compare_and_wait | ulock_wake_all | ulock_no_errno, &addr, 0);
+#elif defined(_WIN32)
+    ::WakeByAddressAll(&addr);
+#else
+    (void)addr;
+#endif
+  }
+
+  /// Exponential pause backoff, yields the thread once the spin budget is spent.
+  class backoff {
+  public:
+    static constexpr std::uint32_t spin_budget = 4096;
+    static constexpr std::uint32_t maximum_pause_count = 64;
+
+    inline void operator()() noexcept {
+      if (_spins >= spin_budget) {
+        // The owner may be waiting for this cpu.
+        std::this_thread::yield();
+        return;
+      }
+
+      for (std::uint32_t i = 0; i < _pause_count; i++) {
+        cpu_relax();
+      }
+
+      _spins += _pause_count;
+      _pause_count = std::min(_pause_count * 2, maximum_pause_count);
+    }
+
+    inline std::uint32_t spins() const noexcept { return _spins; }
+    inline bool is_spin_budget_spent() const noexcept { return _spins >= spin_budget; }
+
+  private:
+    std::uint32_t _spins = 0;
+    std::uint32_t _pause_count = 1;
+  };
+} // namespace spin_lock_detail.
+
+/// Adaptive spin lock.
+///
+/// Spins with test-and-test-and-set, pausing with an exponential backoff so the
+/// cache line isn't hammered, and parks the thread on a futex once the spin
+/// budget is spent. Uncontended lock/unlock are a single atomic operation each.
 class spin_lock_mutex {
 public:
   spin_lock_mutex() noexcept = default;
@@ -49,14 +238,60 @@ public:
   spin_lock_mutex& operator=(spin_lock_mutex&&) = delete;
 
   inline void lock() noexcept {
-    while (_flag.test_and_set(std::memory_order_acquire))
-      ;
+    if (!try_acquire()) {
+      lock_contended();
+    }
+    _stats.add_acquisition();
+  }
+
+  inline bool try_lock() noexcept {
+    if (try_acquire()) {
+      _stats.add_acquisition();
+      return true;
+    }
+    return false;
+  }
+
+  inline void unlock() noexcept {
+    if (_state.exchange(unlocked, std::memory_order_release) == contended) {
+      spin_lock_detail::wake_one(_state);
+    }
   }
 
-  inline void unlock() noexcept { _flag.clear(std::memory_order_release); }
+  /// Always zero unless FST_SPIN_LOCK_STATS is set.
+  inline spin_lock_stats stats() const noexcept { return _stats.get(); }
 
 private:
-  std::atomic_flag _flag = ATOMIC_FLAG_INIT;
+  enum : std::uint32_t { unlocked, locked, contended };
+
+  std::atomic<std::uint32_t> _state = unlocked;
+  spin_lock_detail::stats_counter<FST_SPIN_LOCK_STATS != 0> _stats;
+
+  inline bool try_acquire() noexcept {
+    std::uint32_t expected = unlocked;
+    return _state.compare_exchange_strong(expected, locked, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  inline void lock_contended() noexcept {
+    spin_lock_detail::backoff backoff;
+    while (!backoff.is_spin_budget_spent()) {
+      // Test before test-and-set so waiters only share the cache line while it is held.
+      if (_state.load(std::memory_order_relaxed) == unlocked && try_acquire()) {
+        _stats.add_spins(backoff.spins());
+        return;
+      }
+
+      backoff();
+    }
+
+    _stats.add_spins(backoff.spins());
+
+    // Parks, contended tells the owner to wake a waiter on unlock.
+    while (_state.exchange(contended, std::memory_order_acquire) != unlocked) {
+      _stats.add_park();
+      spin_lock_detail::wait(_state, contended);
+    }
+  }
 };
 
 class scoped_spin_lock {
@@ -77,4 +312,155 @@ public:
 private:
   spin_lock_mutex& _mutex;
 };
+
+/// Fair spin lock, threads get the lock in the order they asked for it.
+///
+/// A waiter can only be handed the lock when its turn comes, so the ones further
+/// in line yield their cpu instead of spinning behind a preempted thread.
+class ticket_spin_lock {
+public:
+  ticket_spin_lock() noexcept = default;
+  ~ticket_spin_lock() noexcept = default;
+
+  ticket_spin_lock(const ticket_spin_lock&) = delete;
+  ticket_spin_lock(ticket_spin_lock&&) = delete;
+
+  ticket_spin_lock& operator=(const ticket_spin_lock&) = delete;
+  ticket_spin_lock& operator=(ticket_spin_lock&&) = delete;
+
+  inline void lock() noexcept {
+    const std::uint32_t ticket = _next.fetch_add(1, std::memory_order_relaxed);
+
+    spin_lock_detail::backoff backoff;
+    while (true) {
+      const std::uint32_t serving = _serving.load(std::memory_order_acquire);
+      if (serving == ticket) {
+        return;
+      }
+
+      // Only the next in line spins, the others would just take cpu time from the threads ahead.
+      if (ticket - serving > 1) {
+        std::this_thread::yield();
+      }
+      else {
+        backoff();
+      }
+    }
+  }
+
+  inline bool try_lock() noexcept {
+    std::uint32_t ticket = _serving.load(std::memory_order_acquire);
+    return _next.compare_exchange_strong(ticket, ticket + 1, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  inline void unlock() noexcept {
+    // Only the owner writes _serving.
+    _serving.store(_serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+private:
+  std::atomic<std::uint32_t> _next = 0;
+  std::atomic<std::uint32_t> _serving = 0;
+};
+
+/// Reader-writer spin lock.
+///
+/// Any number of readers or a single writer. Writers have priority: once a
+/// writer is waiting no new reader gets in, so frequent readers can't starve it.
+/// The lock takes a whole cache line to avoid false sharing with its neighbours.
+class alignas(aligned_memory::cache_line_size) rw_spin_lock {
+public:
+  rw_spin_lock() noexcept = default;
+  ~rw_spin_lock() noexcept = default;
+
+  rw_spin_lock(const rw_spin_lock&) = delete;
+  rw_spin_lock(rw_spin_lock&&) = delete;
+
+  rw_spin_lock& operator=(const rw_spin_lock&) = delete;
+  rw_spin_lock& operator=(rw_spin_lock&&) = delete;
+
+  inline void lock() noexcept {
+    spin_lock_detail::backoff backoff;
+    while (!try_lock()) {
+      // Blocks new readers until this writer, or another waiting one, gets the lock.
+      if (!(_state.load(std::memory_order_relaxed) & writer_pending)) {
+        _state.fetch_or(writer_pending, std::memory_order_relaxed);
+      }
+
+      backoff();
+    }
+  }
+
+  inline bool try_lock() noexcept {
+    std::uint32_t state = _state.load(std::memory_order_relaxed);
+    // Clears writer_pending, other waiting writers set it back.
+    return (state & ~writer_pending) == 0
+        && _state.compare_exchange_strong(state, writer_locked, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  inline void unlock() noexcept { _state.fetch_and(~writer_locked, std::memory_order_release); }
+
+  inline void lock_shared() noexcept {
+    spin_lock_detail::backoff backoff;
+    while (!try_lock_shared()) {
+      backoff();
+    }
+  }
+
+  inline bool try_lock_shared() noexcept {
+    std::uint32_t state = _state.load(std::memory_order_relaxed);
+    return !(state & (writer_locked | writer_pending))
+        && _state.compare_exchange_weak(state, state + reader, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  inline void unlock_shared() noexcept { _state.fetch_sub(reader, std::memory_order_release); }
+
+private:
+  // The reader count is stored above the two writer bits.
+  enum : std::uint32_t { writer_locked = 1, writer_pending = 2, reader = 4 };
+
+  std::atomic<std::uint32_t> _state = 0;
+};
+
+static_assert(sizeof(rw_spin_lock) == aligned_memory::cache_line_size, "rw_spin_lock should fill a cache line");
+
+/// Exclusive lock on a rw_spin_lock.
+class scoped_unique_spin_lock {
+public:
+  inline scoped_unique_spin_lock(rw_spin_lock& mutex)
+      : _mutex(mutex) {
+    _mutex.lock();
+  }
+
+  inline ~scoped_unique_spin_lock() { _mutex.unlock(); }
+
+  scoped_unique_spin_lock(const scoped_unique_spin_lock&) = delete;
+  scoped_unique_spin_lock(scoped_unique_spin_lock&&) = delete;
+
+  scoped_unique_spin_lock& operator=(const scoped_unique_spin_lock&) = delete;
+  scoped_unique_spin_lock& operator=(scoped_unique_spin_lock&&) = delete;
+
+private:
+  rw_spin_lock& _mutex;
+};
+
+/// Shared lock on a rw_spin_lock.
+class scoped_shared_spin_lock {
+public:
+  inline scoped_shared_spin_lock(rw_spin_lock& mutex)
+      : _mutex(mutex) {
+    _mutex.lock_shared();
+  }
+
+  inline ~scoped_shared_spin_lock() { _mutex.unlock_shared(); }
+
+  scoped_shared_spin_lock(const scoped_shared_spin_lock&) = delete;
+  scoped_shared_spin_lock(scoped_shared_spin_lock&&) = delete;
+
+  scoped_shared_spin_lock& operator=(const scoped_shared_spin_lock&) = delete;
+  scoped_shared_spin_lock& operator=(scoped_shared_spin_lock&&) = delete;
+
+private:
+  rw_spin_lock& _mutex;
+};
 } // namespace fst.
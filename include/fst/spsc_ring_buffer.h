@@ -0,0 +1,223 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+
+#pragma once
+#include "fst/assert.h"
+#include "fst/aligned_buffer.h"
+#include "fst/math.h"
+#include "fst/span.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace fst {
+/// Wait-free single producer single consumer ring buffer.
+///
+/// Made to hand sample blocks from a real-time thread to a worker thread, or
+/// back: no lock, no allocation after construction and every call finishes in
+/// a bounded number of steps. All the push/write functions must be called from
+/// one thread and all the pop/read ones from another.
+///
+/// The read and write indices live on separate cache lines and each side keeps
+/// a cached copy of the other side's index, so the shared lines are only read
+/// when the cached value says the ring looks full or empty.
+///
+/// write_region() and read_region() give direct access to the storage, as two
+/// spans since the region can wrap around, to be followed by commit_write() or
+/// commit_read().
+template <typename _Tp, std::size_t _Size>
+class spsc_ring_buffer {
+public:
+  using value_type = _Tp;
+  using size_type = std::size_t;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+
+  static constexpr size_type maximum_size = _Size;
+
+  static_assert(math::is_power_of_two(maximum_size), "spsc_ring_buffer size must be a power of 2");
+  static_assert(
+      std::is_trivially_copyable<value_type>::value, "spsc_ring_buffer value_type must be trivially copyable");
+
+  /// Up to two contiguous parts of the ring.
+  template <typename _T>
+  struct region {
+    fst::span<_T> first;
+    fst::span<_T> second;
+
+    inline size_type size() const noexcept { return first.size() + second.size(); }
+    inline bool empty() const noexcept { return size() == 0; }
+  };
+
+  spsc_ring_buffer() noexcept = default;
+
+  spsc_ring_buffer(const spsc_ring_buffer&) = delete;
+  spsc_ring_buffer(spsc_ring_buffer&&) = delete;
+
+  spsc_ring_buffer& operator=(const spsc_ring_buffer&) = delete;
+  spsc_ring_buffer& operator=(spsc_ring_buffer&&) = delete;
+
+  inline constexpr size_type capacity() const noexcept { return maximum_size; }
+
+  //
+  // Producer.
+  //
+
+  inline size_type write_available() noexcept {
+    const size_type w = _writer.index.load(std::memory_order_relaxed);
+    if (w - _writer.cached_index == maximum_size) {
+      _writer.cached_index = _reader.index.load(std::memory_order_acquire);
+    }
+    return maximum_size - (w - _writer.cached_index);
+  }
+
+  inline bool push(const value_type& value) noexcept {
+    if (!write_available()) {
+      return false;
+    }
+
+    const size_type w = _writer.index.load(std::memory_order_relaxed);
+    _buffer[w & mask] = value;
+    _writer.index.store(w + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Pushes as many values as there is room for, returns the count.
+  inline size_type push(fst::span<const value_type> values) noexcept {
+    region<value_type> r = write_region(values.size());
+    copy(r.first.data(), values.data(), r.first.size());
+    copy(r.second.data(), values.data() + r.first.size(), r.second.size());
+    commit_write(r.size());
+    return r.size();
+  }
+
+  /// At most count free slots, write_available() doesn't need to be called first.
+  inline region<value_type> write_region(size_type count) noexcept {
+    const size_type w = _writer.index.load(std::memory_order_relaxed);
+    size_type available = maximum_size - (w - _writer.cached_index);
+    if (count > available) {
+      _writer.cached_index = _reader.index.load(std::memory_order_acquire);
+      available = maximum_size - (w - _writer.cached_index);
+    }
+
+    return make_region<value_type>(_buffer.data(), w, std::min(count, available));
+  }
+
+  /// Publishes count values written in the last write_region().
+  inline void commit_write(size_type count) noexcept {
+    const size_type w = _writer.index.load(std::memory_order_relaxed);
+    fst_assert(w + count - _writer.cached_index <= maximum_size, "Commit more than the write region");
+    _writer.index.store(w + count, std::memory_order_release);
+  }
+
+  //
+  // Consumer.
+  //
+
+  inline size_type read_available() noexcept {
+    const size_type r = _reader.index.load(std::memory_order_relaxed);
+    if (r == _reader.cached_index) {
+      _reader.cached_index = _writer.index.load(std::memory_order_acquire);
+    }
+    return _reader.cached_index - r;
+  }
+
+  inline bool pop(value_type& value) noexcept {
+    if (!read_available()) {
+      return false;
+    }
+
+    const size_type r = _reader.index.load(std::memory_order_relaxed);
+    value = _buffer[r & mask];
+    _reader.index.store(r + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Pops as many values as available and fit in values, returns the count.
+  inline size_type pop(fst::span<value_type> values) noexcept {
+    region<const value_type> r = read_region(values.size());
+    copy(values.data(), r.first.data(), r.first.size());
+    copy(values.data() + r.first.size(), r.second.data(), r.second.size());
+    commit_read(r.size());
+    return r.size();
+  }
+
+  /// At most count readable values, read_available() doesn't need to be called first.
+  inline region<const value_type> read_region(size_type count) noexcept {
+    const size_type r = _reader.index.load(std::memory_order_relaxed);
+    if (count > _reader.cached_index - r) {
+      _reader.cached_index = _writer.index.load(std::memory_order_acquire);
+    }
+
+    return make_region<const value_type>(_buffer.data(), r, std::min(count, _reader.cached_index - r));
+  }
+
+  /// Releases count values read in the last read_region().
+  inline void commit_read(size_type count) noexcept {
+    const size_type r = _reader.index.load(std::memory_order_relaxed);
+    fst_assert(r + count <= _reader.cached_index, "Commit more than the read region");
+    _reader.index.store(r + count, std::memory_order_release);
+  }
+
+private:
+  static constexpr size_type mask = maximum_size - 1;
+
+  // The indices only grow, wrapping around size_type is fine since the capacity is a power of 2.
+  struct alignas(aligned_memory::cache_line_size) side {
+    std::atomic<size_type> index = 0;
+    // Last seen index of the other side, only used by this side's thread.
+    size_type cached_index = 0;
+  };
+
+  side _writer;
+  side _reader;
+  fst::heap_aligned_buffer<value_type, maximum_size, aligned_memory::cache_line_size> _buffer;
+
+  template <typename _T, typename _Data>
+  static inline region<_T> make_region(_Data* data, size_type index, size_type count) noexcept {
+    const size_type offset = index & mask;
+    const size_type first_count = std::min(count, maximum_size - offset);
+    return { fst::span<_T>(data + offset, first_count), fst::span<_T>(data, count - first_count) };
+  }
+
+  static inline void copy(value_type* dst, const value_type* src, size_type count) noexcept {
+    if (count) {
+      std::memcpy(dst, src, count * sizeof(value_type));
+    }
+  }
+};
+} // namespace fst.
@@ -0,0 +1,304 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+#pragma once
+#include "fst/assert.h"
+#include "fst/flat_map.h"
+#include "fst/hash.h"
+#include "fst/spin_lock.h"
+#include "fst/util.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace fst {
+namespace string_pool_detail {
+  struct hashed_view {
+    std::string_view str;
+    std::size_t hash;
+  };
+
+  struct hashed_view_hash {
+    inline std::size_t operator()(const hashed_view& v) const noexcept { return v.hash; }
+  };
+
+  struct hashed_view_equal {
+    inline bool operator()(const hashed_view& a, const hashed_view& b) const noexcept {
+      return a.hash == b.hash && a.str == b.str;
+    }
+  };
+} // namespace string_pool_detail.
+
+/// Interns strings in arena pages and identifies them with 32 bits handles.
+///
+/// Equal strings always get the same handle, comparing two handles compares the strings.
+/// The interned characters never move and are null terminated.
+///
+/// intern() and find() only lock one of the shards selected by the string hash.
+/// view() doesn't lock, a handle can be resolved from any thread.
+///
+/// A handle is the index of a page (upper page_index_bits) and the offset of the entry in that page.
+/// Each entry is stored as its uint32_t size followed by the characters and a null terminator.
+///
+/// The pages of a shard start at minimum_page_size and double up to page_size, the
+/// page table is allocated by blocks of pages_per_block entries as it fills.
+class string_pool {
+public:
+  enum class handle : std::uint32_t {};
+  static constexpr handle invalid_handle = (handle)std::numeric_limits<std::uint32_t>::max();
+
+  static constexpr std::size_t shard_bits = 4;
+  static constexpr std::size_t shard_count = std::size_t(1) << shard_bits;
+  static constexpr std::size_t offset_bits = 18;
+  static constexpr std::size_t page_index_bits = 32 - offset_bits;
+  static constexpr std::size_t page_size = std::size_t(1) << offset_bits;
+  static constexpr std::size_t maximum_page_count = (std::size_t(1) << page_index_bits) - 1;
+  static constexpr std::size_t minimum_page_size = 1024;
+  static constexpr std::size_t pages_per_block = 128;
+
+  string_pool() noexcept = default;
+
+  inline ~string_pool() {
+    for (std::atomic<page_block*>& b : _page_blocks) {
+      if (page_block* block = b.load(std::memory_order_relaxed)) {
+        for (std::atomic<char*>& page : *block) {
+          delete[] page.load(std::memory_order_relaxed);
+        }
+        delete block;
+      }
+    }
+  }
+
+  string_pool(const string_pool&) = delete;
+  string_pool(string_pool&&) = delete;
+  string_pool& operator=(const string_pool&) = delete;
+  string_pool& operator=(string_pool&&) = delete;
+
+  /// Returns the handle of str, adding it to the pool if needed.
+  /// Returns invalid_handle when all the pages are used.
+  inline handle intern(std::string_view str) {
+    const string_pool_detail::hashed_view key = make_key(str);
+    shard& s = _shards[shard_index(key.hash)];
+    fst::scoped_spin_lock lock(s.lock);
+    return intern(s, key);
+  }
+
+  /// Returns the handle of str or invalid_handle if it was never interned.
+  inline handle find(std::string_view str) const {
+    const string_pool_detail::hashed_view key = make_key(str);
+    const shard& s = _shards[shard_index(key.hash)];
+    fst::scoped_spin_lock lock(s.lock);
+    auto it = s.map.find(key);
+    return it == s.map.end() ? invalid_handle : it->second;
+  }
+
+  inline bool contains(std::string_view str) const { return find(str) != invalid_handle; }
+
+  /// Interns every line of text, a trailing '\r' is removed from each line.
+  /// Each shard is locked once for the whole batch.
+  inline void intern_lines(std::string_view text, std::vector<handle>& handles) {
+    std::vector<string_pool_detail::hashed_view> keys;
+    std::array<std::size_t, shard_count + 1> shard_offsets = {};
+
+    for (std::size_t pos = 0; pos < text.size();) {
+      std::size_t end = text.find('\n', pos);
+      end = end == std::string_view::npos ? text.size() : end;
+
+      std::string_view line = text.substr(pos, end - pos);
+      if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+      }
+
+      keys.push_back(make_key(line));
+      shard_offsets[shard_index(keys.back().hash) + 1]++;
+      pos = end + 1;
+    }
+
+    // Counting sort of the line indices by shard.
+    for (std::size_t i = 1; i <= shard_count; i++) {
+      shard_offsets[i] += shard_offsets[i - 1];
+    }
+
+    std::vector<std::uint32_t> order(keys.size());
+    std::array<std::size_t, shard_count> positions;
+    std::copy_n(shard_offsets.begin(), shard_count, positions.begin());
+    for (std::size_t i = 0; i < keys.size(); i++) {
+      order[positions[shard_index(keys[i].hash)]++] = (std::uint32_t)i;
+    }
+
+    const std::size_t first = handles.size();
+    handles.resize(first + keys.size());
+
+    for (std::size_t i = 0; i < shard_count; i++) {
+      if (shard_offsets[i] == shard_offsets[i + 1]) {
+        continue;
+      }
+
+      shard& s = _shards[i];
+      fst::scoped_spin_lock lock(s.lock);
+      for (std::size_t k = shard_offsets[i]; k < shard_offsets[i + 1]; k++) {
+        handles[first + order[k]] = intern(s, keys[order[k]]);
+      }
+    }
+  }
+
+  inline std::vector<handle> intern_lines(std::string_view text) {
+    std::vector<handle> handles;
+    intern_lines(text, handles);
+    return handles;
+  }
+
+  /// Lock free access to an interned string.
+  inline std::string_view view(handle h) const noexcept {
+    fst_assert(h != invalid_handle, "string_pool::view invalid handle");
+    const char* entry = entry_data(h);
+    std::uint32_t size;
+    std::memcpy(&size, entry, sizeof(size));
+    return std::string_view(entry + sizeof(size), size);
+  }
+
+  inline const char* c_str(handle h) const noexcept { return view(h).data(); }
+
+  /// Number of distinct strings.
+  inline std::size_t size() const noexcept { return _size.load(std::memory_order_relaxed); }
+  inline bool empty() const noexcept { return size() == 0; }
+
+  /// Bytes allocated for the pages.
+  inline std::size_t memory_size() const noexcept { return _memory_size.load(std::memory_order_relaxed); }
+
+private:
+  struct alignas(64) shard {
+    fst::flat_map<string_pool_detail::hashed_view, handle, string_pool_detail::hashed_view_hash,
+        string_pool_detail::hashed_view_equal>
+        map;
+    char* page = nullptr;
+    std::size_t page_index = 0;
+    std::size_t offset = 0;
+    std::size_t capacity = 0;
+    std::size_t next_page_size = minimum_page_size;
+    mutable fst::spin_lock_mutex lock;
+  };
+
+  using page_block = std::array<std::atomic<char*>, pages_per_block>;
+  static constexpr std::size_t page_block_count = (maximum_page_count + pages_per_block - 1) / pages_per_block;
+
+  std::array<shard, shard_count> _shards;
+  std::array<std::atomic<page_block*>, page_block_count> _page_blocks = {};
+  std::atomic<std::size_t> _page_count = 0;
+  std::atomic<std::size_t> _size = 0;
+  std::atomic<std::size_t> _memory_size = 0;
+
+  static inline string_pool_detail::hashed_view make_key(std::string_view str) noexcept {
+    return { str, (std::size_t)fst::hash_string(str) };
+  }
+
+  // The upper bits of size_t select the shard, flat_map uses the lower ones.
+  static inline std::size_t shard_index(std::size_t h) noexcept {
+    return h >> (sizeof(std::size_t) * 8 - shard_bits);
+  }
+
+  inline const char* entry_data(handle h) const noexcept {
+    const std::uint32_t value = (std::uint32_t)h;
+    const std::size_t index = value >> offset_bits;
+    const page_block* block = _page_blocks[index / pages_per_block].load(std::memory_order_acquire);
+    const char* page = (*block)[index % pages_per_block].load(std::memory_order_acquire);
+    return page + (value & (page_size - 1));
+  }
+
+  // Shards race for the blocks, the loser frees its copy.
+  inline std::atomic<char*>& page_slot(std::size_t index) {
+    std::atomic<page_block*>& b = _page_blocks[index / pages_per_block];
+    page_block* block = b.load(std::memory_order_acquire);
+    if (!block) {
+      std::unique_ptr<page_block> new_block = std::make_unique<page_block>();
+      if (b.compare_exchange_strong(block, new_block.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+        block = new_block.release();
+      }
+    }
+
+    return (*block)[index % pages_per_block];
+  }
+
+  // Must be called with the shard locked.
+  inline handle intern(shard& s, const string_pool_detail::hashed_view& key) {
+    auto it = s.map.find(key);
+    if (it != s.map.end()) {
+      return it->second;
+    }
+
+    const std::size_t entry_size = sizeof(std::uint32_t) + key.str.size() + 1;
+    if (s.offset + entry_size > s.capacity) {
+      if (!new_page(s, entry_size)) {
+        return invalid_handle;
+      }
+    }
+
+    char* entry = s.page + s.offset;
+    const std::uint32_t size = (std::uint32_t)key.str.size();
+    std::memcpy(entry, &size, sizeof(size));
+    std::memcpy(entry + sizeof(size), key.str.data(), key.str.size());
+    entry[sizeof(size) + key.str.size()] = 0;
+
+    const handle h = (handle)((std::uint32_t)(s.page_index << offset_bits) | (std::uint32_t)s.offset);
+    s.offset += entry_size;
+    s.map.try_emplace(string_pool_detail::hashed_view{ std::string_view(entry + sizeof(size), size), key.hash }, h);
+    _size.fetch_add(1, std::memory_order_relaxed);
+    return h;
+  }
+
+  // Strings larger than a page get their own page, returns false when the pool is full.
+  inline bool new_page(shard& s, std::size_t entry_size) {
+    const std::size_t index = _page_count.fetch_add(1, std::memory_order_relaxed);
+    if (index >= maximum_page_count) {
+      return false;
+    }
+
+    const std::size_t capacity = fst::maximum(s.next_page_size, entry_size);
+    s.next_page_size = fst::minimum(s.next_page_size * 2, page_size);
+    s.page = new char[capacity];
+    s.page_index = index;
+    s.offset = 0;
+    s.capacity = capacity;
+    page_slot(index).store(s.page, std::memory_order_release);
+    _memory_size.fetch_add(capacity, std::memory_order_relaxed);
+    return true;
+  }
+};
+} // namespace fst.
@@ -0,0 +1,455 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+
+#pragma once
+#include "fst/assert.h"
+#include "fst/aligned_buffer.h"
+#include "fst/range.h"
+#include "fst/span.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fst {
+/// Chase-Lev work stealing deque.
+/// https://www.di.ens.fr/~zappa/readings/ppopp13.pdf
+///
+/// The owner thread pushes and pops at the bottom, any other thread steals from
+/// the top. The buffer grows when full, the previous ones are kept until
+/// destruction since a thief may still be reading them.
+template <typename _Tp>
+class work_stealing_deque {
+public:
+  using value_type = _Tp;
+  using size_type = std::size_t;
+
+  static_assert(
+      std::is_trivially_copyable<value_type>::value, "work_stealing_deque value_type must be trivially copyable");
+
+  static constexpr size_type default_capacity = 256;
+
+  inline explicit work_stealing_deque(size_type capacity = default_capacity) {
+    _buffers.push_back(std::make_unique<buffer>(math::round_to_power_of_two(std::max<size_type>(capacity, 2))));
+    _buffer.store(_buffers.back().get(), std::memory_order_relaxed);
+  }
+
+  work_stealing_deque(const work_stealing_deque&) = delete;
+  work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+  /// Owner only.
+  inline void push(value_type value) {
+    const std::int64_t b = _bottom.load(std::memory_order_relaxed);
+    const std::int64_t t = _top.load(std::memory_order_acquire);
+    buffer* buf = _buffer.load(std::memory_order_relaxed);
+
+    if (b - t > (std::int64_t)buf->mask) {
+      _buffers.push_back(buf->grow(b, t));
+      buf = _buffers.back().get();
+      _buffer.store(buf, std::memory_order_release);
+    }
+
+    buf->put(b, value);
+    _bottom.store(b + 1, std::memory_order_release);
+  }
+
+  /// Owner only, takes the most recently pushed value.
+  inline bool pop(value_type& value) {
+    const std::int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+    buffer* buf = _buffer.load(std::memory_order_relaxed);
+    _bottom.store(b, std::memory_order_seq_cst);
+    std::int64_t t = _top.load(std::memory_order_seq_cst);
+
+    if (t > b) {
+      _bottom.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+
+    value = buf->get(b);
+    if (t == b) {
+      // Last one, races with the thieves.
+      const bool is_taken
+          = _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      _bottom.store(b + 1, std::memory_order_relaxed);
+      return is_taken;
+    }
+
+    return true;
+  }
+
+  /// Any thread, takes the oldest value.
+  inline bool steal(value_type& value) {
+    std::int64_t t = _top.load(std::memory_order_seq_cst);
+    const std::int64_t b = _bottom.load(std::memory_order_seq_cst);
+    if (t >= b) {
+      return false;
+    }
+
+    value = _buffer.load(std::memory_order_acquire)->get(t);
+    return _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+  }
+
+  /// Only a hint while other threads are running.
+  inline bool empty() const noexcept {
+    return _top.load(std::memory_order_relaxed) >= _bottom.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct buffer {
+    inline explicit buffer(size_type size)
+        : mask(size - 1)
+        , data(new std::atomic<value_type>[size]) {}
+
+    inline value_type get(std::int64_t index) const noexcept {
+      return data[index & mask].load(std::memory_order_relaxed);
+    }
+
+    inline void put(std::int64_t index, value_type value) noexcept {
+      data[index & mask].store(value, std::memory_order_relaxed);
+    }
+
+    inline std::unique_ptr<buffer> grow(std::int64_t bottom, std::int64_t top) const {
+      std::unique_ptr<buffer> buf = std::make_unique<buffer>((mask + 1) * 2);
+      for (std::int64_t i = top; i < bottom; i++) {
+        buf->put(i, get(i));
+      }
+      return buf;
+    }
+
+    const size_type mask;
+    std::unique_ptr<std::atomic<value_type>[]> data;
+  };
+
+  // Thieves write _top, the owner writes _bottom.
+  alignas(aligned_memory::cache_line_size) std::atomic<std::int64_t> _top = 0;
+  alignas(aligned_memory::cache_line_size) std::atomic<std::int64_t> _bottom = 0;
+  std::atomic<buffer*> _buffer;
+  std::vector<std::unique_ptr<buffer>> _buffers;
+};
+
+/// Fixed number of worker threads with work stealing.
+///
+/// Every worker owns a work_stealing_deque. Tasks pushed from a worker go to
+/// its own deque and are run last in first out, tasks pushed from other threads
+/// go to a shared queue. An idle worker takes from its deque, then from the
+/// shared queue and then steals the oldest task of another worker.
+///
+/// parallel_for() and parallel_reduce() split a range or a span in chunks of
+/// grain elements, the calling thread works on them too. The first exception
+/// thrown by a chunk is rethrown to the caller after the running chunks return,
+/// the chunks that haven't started are skipped.
+///
+/// The destructor runs the tasks that are still queued before joining.
+class thread_pool {
+public:
+  using task_type = std::function<void()>;
+
+  inline explicit thread_pool(std::size_t thread_count = default_thread_count()) {
+    fst_assert(thread_count > 0, "thread_pool needs at least one thread.");
+
+    _queues.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; i++) {
+      _queues.push_back(std::make_unique<work_stealing_deque<task_type*>>());
+    }
+
+    _threads.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; i++) {
+      _threads.emplace_back(&thread_pool::worker_thread, this, i);
+    }
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  inline ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(_sleep_mutex);
+      _is_running.store(false, std::memory_order_relaxed);
+    }
+    _sleep_condition.notify_all();
+
+    for (std::thread& t : _threads) {
+      t.join();
+    }
+  }
+
+  inline void push(task_type task) {
+    task_type* t = new task_type(std::move(task));
+
+    if (_current_worker.pool == this) {
+      _queues[_current_worker.index]->push(t);
+    }
+    else {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      _tasks.push_back(t);
+    }
+
+    // Pairs with the sleeping count in sleep(), either a worker sees the task or we see it sleeping.
+    _task_count.fetch_add(1, std::memory_order_seq_cst);
+    if (_sleeping_count.load(std::memory_order_seq_cst)) {
+      { std::lock_guard<std::mutex> lock(_sleep_mutex); }
+      _sleep_condition.notify_one();
+    }
+  }
+
+  inline std::size_t thread_count() const noexcept { return _threads.size(); }
+
+  static inline std::size_t default_thread_count() noexcept {
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  }
+
+  /// Calls fct(fst::range<_Tp>) on consecutive chunks of at most grain values.
+  template <typename _Tp, typename _Fct>
+  inline void parallel_for(fst::range<_Tp> r, _Tp grain, _Fct&& fct) {
+    fst_assert(grain > 0, "parallel_for grain must be greater than 0.");
+    const std::size_t chunk_count = range_chunk_count(r, grain);
+    run_chunks(chunk_count, [&](std::size_t i) { fct(chunk(r, grain, i)); });
+  }
+
+  /// Calls fct(fst::span<_Tp>) on consecutive chunks of at most grain elements.
+  template <typename _Tp, typename _Fct>
+  inline void parallel_for(fst::span<_Tp> s, std::size_t grain, _Fct&& fct) {
+    fst_assert(grain > 0, "parallel_for grain must be greater than 0.");
+    run_chunks((s.size() + grain - 1) / grain, [&](std::size_t i) { fct(chunk(s, grain, i)); });
+  }
+
+  /// Reduces the map_fct(fst::range<_Tp>) of every chunk, in order, starting from init.
+  template <typename _Tp, typename _Result, typename _Map, typename _Reduce>
+  inline _Result parallel_reduce(fst::range<_Tp> r, _Tp grain, _Result init, _Map&& map_fct, _Reduce&& reduce_fct) {
+    fst_assert(grain > 0, "parallel_reduce grain must be greater than 0.");
+    const std::size_t chunk_count = range_chunk_count(r, grain);
+    std::vector<_Result> results(chunk_count, init);
+    run_chunks(chunk_count, [&](std::size_t i) { results[i] = map_fct(chunk(r, grain, i)); });
+    return reduce_results(std::move(init), results, reduce_fct);
+  }
+
+  /// Reduces the map_fct(fst::span<_Tp>) of every chunk, in order, starting from init.
+  template <typename _Tp, typename _Result, typename _Map, typename _Reduce>
+  inline _Result parallel_reduce(
+      fst::span<_Tp> s, std::size_t grain, _Result init, _Map&& map_fct, _Reduce&& reduce_fct) {
+    fst_assert(grain > 0, "parallel_reduce grain must be greater than 0.");
+    const std::size_t chunk_count = (s.size() + grain - 1) / grain;
+    std::vector<_Result> results(chunk_count, init);
+    run_chunks(chunk_count, [&](std::size_t i) { results[i] = map_fct(chunk(s, grain, i)); });
+    return reduce_results(std::move(init), results, reduce_fct);
+  }
+
+private:
+  static constexpr std::chrono::seconds maximum_idle_time = std::chrono::seconds(60);
+
+  // Zero initialized as a thread_local.
+  struct worker_info {
+    thread_pool* pool;
+    std::size_t index;
+  };
+
+  static inline thread_local worker_info _current_worker;
+
+  std::vector<std::thread> _threads;
+  std::vector<std::unique_ptr<work_stealing_deque<task_type*>>> _queues;
+
+  // Tasks pushed from outside the workers.
+  std::deque<task_type*> _tasks;
+  std::mutex _queue_mutex;
+
+  // Pushed and not yet taken, can briefly go below zero.
+  std::atomic<std::int64_t> _task_count = 0;
+  std::atomic<std::size_t> _sleeping_count = 0;
+  std::atomic<bool> _is_running = true;
+  std::mutex _sleep_mutex;
+  std::condition_variable _sleep_condition;
+
+  inline void worker_thread(std::size_t index) {
+    _current_worker = { this, index };
+
+    while (true) {
+      if (task_type* task = take(index)) {
+        (*task)();
+        delete task;
+        continue;
+      }
+
+      if (!_is_running.load(std::memory_order_relaxed) && _task_count.load(std::memory_order_acquire) <= 0) {
+        return;
+      }
+
+      sleep();
+    }
+  }
+
+  inline task_type* take(std::size_t index) {
+    task_type* task = nullptr;
+
+    if (!_queues[index]->pop(task)) {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      if (!_tasks.empty()) {
+        task = _tasks.front();
+        _tasks.pop_front();
+      }
+    }
+
+    for (std::size_t i = 1; !task && i < _queues.size(); i++) {
+      if (!_queues[(index + i) % _queues.size()]->steal(task)) {
+        task = nullptr;
+      }
+    }
+
+    if (task) {
+      _task_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return task;
+  }
+
+  inline void sleep() {
+    std::unique_lock<std::mutex> lock(_sleep_mutex);
+    _sleeping_count.fetch_add(1, std::memory_order_seq_cst);
+    while (_task_count.load(std::memory_order_seq_cst) <= 0 && _is_running.load(std::memory_order_relaxed)) {
+      _sleep_condition.wait_for(lock, maximum_idle_time);
+    }
+    _sleeping_count.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  struct chunk_job {
+    std::atomic<std::size_t> next = 0;
+    std::atomic<std::size_t> done = 0;
+    std::size_t count = 0;
+    void (*invoke)(void*, std::size_t) = nullptr;
+    void* fct = nullptr;
+    // The first exception thrown by a chunk, the ones left after it are skipped.
+    std::atomic<bool> has_failed = false;
+    std::exception_ptr exception;
+
+    inline void run() noexcept {
+      for (std::size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+           i = next.fetch_add(1, std::memory_order_relaxed)) {
+        if (!has_failed.load(std::memory_order_relaxed)) {
+          try {
+            invoke(fct, i);
+          } catch (...) {
+            if (!has_failed.exchange(true, std::memory_order_relaxed)) {
+              exception = std::current_exception();
+            }
+          }
+        }
+
+        done.fetch_add(1, std::memory_order_release);
+      }
+    }
+  };
+
+  /// Runs fct(chunk_index) for every chunk on the calling thread and up to thread_count() workers.
+  /// An exception thrown by fct is rethrown here once no chunk is running anymore.
+  template <typename _Fct>
+  inline void run_chunks(std::size_t chunk_count, _Fct&& fct) {
+    if (chunk_count == 0) {
+      return;
+    }
+
+    // fct stays on this stack, only claimed chunks call it and they are all done before returning.
+    // The job is shared since helpers can start after everything is done.
+    std::shared_ptr<chunk_job> job = std::make_shared<chunk_job>();
+    job->count = chunk_count;
+    job->fct = (void*)&fct;
+    job->invoke = [](void* f, std::size_t i) { (*static_cast<std::remove_reference_t<_Fct>*>(f))(i); };
+
+    const std::size_t helper_count = std::min(thread_count(), chunk_count - 1);
+    for (std::size_t i = 0; i < helper_count; i++) {
+      push([job]() { job->run(); });
+    }
+
+    job->run();
+
+    // Only waits for the chunks already being run by the helpers.
+    while (job->done.load(std::memory_order_acquire) != chunk_count) {
+      std::this_thread::yield();
+    }
+
+    if (job->exception) {
+      std::rethrow_exception(job->exception);
+    }
+  }
+
+  template <typename _Tp>
+  static inline std::size_t range_chunk_count(const fst::range<_Tp>& r, _Tp grain) {
+    if (!(r.length() > 0)) {
+      return 0;
+    }
+
+    if constexpr (std::is_floating_point_v<_Tp>) {
+      // Rounding can add a chunk starting at or past r.max.
+      std::size_t count = (std::size_t)std::ceil(r.length() / grain);
+      while (count > 1 && r.min + (_Tp)(count - 1) * grain >= r.max) {
+        count--;
+      }
+      return count;
+    }
+    else {
+      return (std::size_t)((r.length() + grain - 1) / grain);
+    }
+  }
+
+  template <typename _Tp>
+  static inline fst::range<_Tp> chunk(const fst::range<_Tp>& r, _Tp grain, std::size_t index) {
+    const _Tp first = r.min + (_Tp)index * grain;
+    return { first, std::min<_Tp>(first + grain, r.max) };
+  }
+
+  template <typename _Tp>
+  static inline fst::span<_Tp> chunk(const fst::span<_Tp>& s, std::size_t grain, std::size_t index) {
+    const std::size_t first = index * grain;
+    return fst::span<_Tp>(s.data() + first, std::min(grain, s.size() - first));
+  }
+
+  template <typename _Result, typename _Reduce>
+  static inline _Result reduce_results(_Result value, std::vector<_Result>& results, _Reduce& reduce_fct) {
+    for (_Result& r : results) {
+      value = reduce_fct(std::move(value), std::move(r));
+    }
+    return value;
+  }
+};
+} // namespace fst.
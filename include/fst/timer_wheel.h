@@ -0,0 +1,417 @@
+///
+/// BSD 3-Clause License
+///
+/// Copyright (c) 2021, Alexandre Arsenault
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without
+/// modification, are permitted provided that the following conditions are met:
+///
+/// * Redistributions of source code must retain the above copyright notice, this
+///   list of conditions and the following disclaimer.
+///
+/// * Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// * Neither the name of the copyright holder nor the names of its
+///   contributors may be used to endorse or promote products derived from
+///   this software without specific prior written permission.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+/// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+/// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+/// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+/// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+/// POSSIBILITY OF SUCH DAMAGE.
+///
+
+#pragma once
+#include "fst/assert.h"
+#include "fst/bitset.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace fst {
+/// Hierarchical timer wheel.
+///
+/// Timers are kept in 4 levels of 64 slots, level l slot covering 64^l ticks of
+/// resolution(). Insert, cancel and reschedule are O(1). advance() visits the level 0
+/// slots between the last and the current tick, skipping empty ones with the slot
+/// occupancy bits, and cascades the higher levels down when their slot comes up.
+///
+/// Each timer keeps its exact deadline, a timer never fires before it.
+/// Timers further than 64^4 ticks are parked in the last slot of the top level and
+/// re-evaluated every time it cascades.
+///
+/// @code
+///   fst::timer_wheel<int> wheel;
+///   auto id = wheel.insert(clock::now() + 10ms, 32);
+///   ...
+///   wheel.advance(clock::now(), [](timer_id id, int& value) {});
+///   std::this_thread::sleep_until(wheel.next_deadline());
+/// @endcode
+template <typename _Tp>
+class timer_wheel {
+public:
+  using value_type = _Tp;
+  using size_type = std::size_t;
+  using clock = std::chrono::steady_clock;
+  using time_point = clock::time_point;
+  using duration = clock::duration;
+
+  enum class timer_id : std::uint64_t {};
+  static constexpr timer_id invalid_id = (timer_id)std::numeric_limits<std::uint64_t>::max();
+
+  static constexpr size_type slot_bits = 6;
+  static constexpr size_type slot_count = 1 << slot_bits;
+  static constexpr size_type level_count = 4;
+  static constexpr duration default_resolution = std::chrono::microseconds(100);
+
+  inline explicit timer_wheel(duration resolution = default_resolution, time_point start = clock::now()) noexcept
+      : _start(start)
+      , _resolution(resolution) {
+    fst_assert(resolution.count() > 0, "timer_wheel resolution must be greater than 0.");
+    _heads.fill(npos);
+    _occupancy.fill(0);
+  }
+
+  timer_wheel(const timer_wheel&) = delete;
+  timer_wheel& operator=(const timer_wheel&) = delete;
+
+  [[nodiscard]] inline size_type size() const noexcept { return _size; }
+  [[nodiscard]] inline bool empty() const noexcept { return _size == 0; }
+  [[nodiscard]] inline duration resolution() const noexcept { return _resolution; }
+
+  template <typename... _Args>
+  inline timer_id emplace(time_point deadline, _Args&&... args) {
+    std::uint32_t index;
+    if (_free_head != npos) {
+      index = _free_head;
+      _free_head = _nodes[index].next;
+    }
+    else {
+      index = (std::uint32_t)_nodes.size();
+      _nodes.emplace_back();
+    }
+
+    node& n = _nodes[index];
+    n.value.emplace(std::forward<_Args>(args)...);
+    n.deadline = deadline;
+    link(index);
+    _size++;
+    return make_id(index, n.generation);
+  }
+
+  inline timer_id insert(time_point deadline, const value_type& value) { return emplace(deadline, value); }
+  inline timer_id insert(time_point deadline, value_type&& value) { return emplace(deadline, std::move(value)); }
+
+  /// Removes the timer, returns false if it already fired or was canceled.
+  /// Can be called from an advance() callback, including on itself.
+  inline bool cancel(timer_id id) {
+    const std::uint32_t index = find_index(id);
+    if (index == npos) {
+      return false;
+    }
+
+    if (_nodes[index].slot != pending_slot) {
+      unlink(index);
+    }
+
+    release(index);
+    return true;
+  }
+
+  /// Moves the timer to a new deadline. From an advance() callback this is how a
+  /// timer repeats itself, it keeps its id and value.
+  inline bool reschedule(timer_id id, time_point deadline) {
+    const std::uint32_t index = find_index(id);
+    if (index == npos) {
+      return false;
+    }
+
+    if (_nodes[index].slot != pending_slot) {
+      unlink(index);
+    }
+
+    _nodes[index].deadline = deadline;
+    link(index);
+    return true;
+  }
+
+  [[nodiscard]] inline bool contains(timer_id id) const noexcept { return find_index(id) != npos; }
+
+  /// Pointer to the value of a timer or nullptr if it's not in the wheel.
+  inline value_type* find(timer_id id) noexcept {
+    const std::uint32_t index = find_index(id);
+    return index == npos ? nullptr : &*_nodes[index].value;
+  }
+
+  inline time_point deadline(timer_id id) const noexcept {
+    const std::uint32_t index = find_index(id);
+    return index == npos ? time_point::max() : _nodes[index].deadline;
+  }
+
+  /// Calls fct(timer_id, value_type&) for every timer whose deadline is before or at now.
+  /// The timers are removed from the wheel once fct returns unless fct rescheduled them.
+  /// fct can insert, cancel or reschedule timers but can't call advance().
+  /// Returns the number of expired timers.
+  template <typename _Fct>
+  inline size_type advance(time_point now, _Fct&& fct) {
+    fst_assert(!_is_advancing, "timer_wheel::advance is not reentrant.");
+    _is_advancing = true;
+
+    const std::uint64_t target = tick_of(now);
+    collect(now);
+
+    while (_current_tick < target) {
+      std::uint64_t next = _current_tick + 1;
+
+      // Jumps to the next occupied level 0 slot or the next level boundary.
+      if (next & slot_mask) {
+        const std::uint64_t bits = _occupancy[0] & (~std::uint64_t(0) << (next & slot_mask));
+        next = bits ? ((_current_tick & ~std::uint64_t(slot_mask)) + bit::countr_zero(bits))
+                    : ((_current_tick | slot_mask) + 1);
+        next = std::min(next, target);
+      }
+
+      _current_tick = next;
+      if ((_current_tick & slot_mask) == 0) {
+        cascade();
+      }
+
+      collect(now);
+    }
+
+    // Fires outside of the slot walk so fct can modify the wheel.
+    size_type count = 0;
+    for (std::size_t i = 0; i < _expired.size(); i++) {
+      const timer_id id = _expired[i];
+      const std::uint32_t index = find_index(id);
+      if (index == npos || _nodes[index].slot != pending_slot) {
+        continue;
+      }
+
+      count++;
+      fct(id, *_nodes[index].value);
+
+      const std::uint32_t after_index = find_index(id);
+      if (after_index != npos && _nodes[after_index].slot == pending_slot) {
+        release(after_index);
+      }
+    }
+
+    _expired.clear();
+    _is_advancing = false;
+    return count;
+  }
+
+  /// Time at which advance() has work to do, time_point::max() when empty.
+  /// It's either the deadline of the earliest timer or the time a higher level
+  /// slot needs to cascade, whichever comes first.
+  inline time_point next_deadline() const noexcept {
+    if (_size == 0) {
+      return time_point::max();
+    }
+
+    time_point result = time_point::max();
+
+    if (_occupancy[0]) {
+      const size_type d = bit::countr_zero(rotate_right(_occupancy[0], _current_tick & slot_mask));
+      for (std::uint32_t i = _heads[(_current_tick + d) & slot_mask]; i != npos; i = _nodes[i].next) {
+        result = std::min(result, _nodes[i].deadline);
+      }
+    }
+
+    for (size_type l = 1; l < level_count; l++) {
+      if (!_occupancy[l]) {
+        continue;
+      }
+
+      const std::uint64_t level_tick = _current_tick >> (l * slot_bits);
+      const size_type d = bit::countr_zero(rotate_right(_occupancy[l], (level_tick + 1) & slot_mask)) + 1;
+      result = std::min(result, time_of((level_tick + d) << (l * slot_bits)));
+    }
+
+    return result;
+  }
+
+  inline void clear() noexcept {
+    for (std::uint32_t i = 0; i < (std::uint32_t)_nodes.size(); i++) {
+      if (_nodes[i].slot != free_slot) {
+        release(i);
+      }
+    }
+
+    _heads.fill(npos);
+    _occupancy.fill(0);
+  }
+
+private:
+  static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+  static constexpr std::uint64_t slot_mask = slot_count - 1;
+  static constexpr std::uint16_t free_slot = std::numeric_limits<std::uint16_t>::max();
+  static constexpr std::uint16_t pending_slot = free_slot - 1;
+
+  struct node {
+    std::optional<value_type> value;
+    time_point deadline;
+    std::uint32_t prev = npos;
+    std::uint32_t next = npos;
+    std::uint32_t generation = 0;
+    std::uint16_t slot = free_slot;
+  };
+
+  // A deque keeps the values in place while fct inserts new timers.
+  std::deque<node> _nodes;
+  std::array<std::uint32_t, level_count * slot_count> _heads;
+  std::array<std::uint64_t, level_count> _occupancy;
+  std::vector<timer_id> _expired;
+  time_point _start;
+  duration _resolution;
+  std::uint64_t _current_tick = 0;
+  std::uint32_t _free_head = npos;
+  size_type _size = 0;
+  bool _is_advancing = false;
+
+  static inline timer_id make_id(std::uint32_t index, std::uint32_t generation) noexcept {
+    return (timer_id)((std::uint64_t(generation) << 32) | index);
+  }
+
+  static inline std::uint64_t rotate_right(std::uint64_t value, std::uint64_t shift) noexcept {
+    shift &= slot_mask;
+    return shift ? ((value >> shift) | (value << (64 - shift))) : value;
+  }
+
+  inline std::uint32_t find_index(timer_id id) const noexcept {
+    const std::uint32_t index = (std::uint32_t)((std::uint64_t)id & 0xFFFFFFFF);
+    const std::uint32_t generation = (std::uint32_t)((std::uint64_t)id >> 32);
+    if (index >= _nodes.size() || _nodes[index].generation != generation || _nodes[index].slot == free_slot) {
+      return npos;
+    }
+    return index;
+  }
+
+  inline std::uint64_t tick_of(time_point t) const noexcept {
+    return t <= _start ? 0 : (std::uint64_t)((t - _start) / _resolution);
+  }
+
+  inline time_point time_of(std::uint64_t tick) const noexcept { return _start + _resolution * (std::int64_t)tick; }
+
+  inline void link(std::uint32_t index) noexcept {
+    node& n = _nodes[index];
+    const std::uint64_t tick = std::max(tick_of(n.deadline), _current_tick);
+    const std::uint64_t delta = tick - _current_tick;
+
+    size_type level = 0;
+    std::uint64_t slot = tick & slot_mask;
+
+    if (delta >= slot_count) {
+      level = 1;
+      while (level < level_count - 1 && delta >= (std::uint64_t(1) << ((level + 1) * slot_bits))) {
+        level++;
+      }
+
+      if (delta >= (std::uint64_t(1) << (level_count * slot_bits))) {
+        // Too far, parked in the top level slot that cascades last.
+        slot = ((_current_tick >> (level * slot_bits)) + slot_mask) & slot_mask;
+      }
+      else {
+        slot = (tick >> (level * slot_bits)) & slot_mask;
+      }
+    }
+
+    const std::uint16_t s = (std::uint16_t)(level * slot_count + slot);
+    n.slot = s;
+    n.prev = npos;
+    n.next = _heads[s];
+    if (n.next != npos) {
+      _nodes[n.next].prev = index;
+    }
+
+    _heads[s] = index;
+    _occupancy[level] |= std::uint64_t(1) << slot;
+  }
+
+  inline void unlink(std::uint32_t index) noexcept {
+    node& n = _nodes[index];
+    if (n.prev != npos) {
+      _nodes[n.prev].next = n.next;
+    }
+    else {
+      _heads[n.slot] = n.next;
+    }
+
+    if (n.next != npos) {
+      _nodes[n.next].prev = n.prev;
+    }
+
+    if (_heads[n.slot] == npos) {
+      _occupancy[n.slot / slot_count] &= ~(std::uint64_t(1) << (n.slot % slot_count));
+    }
+
+    n.prev = npos;
+    n.next = npos;
+  }
+
+  inline void release(std::uint32_t index) noexcept {
+    node& n = _nodes[index];
+    n.value.reset();
+    n.generation++;
+    n.slot = free_slot;
+    n.prev = npos;
+    n.next = _free_head;
+    _free_head = index;
+    _size--;
+  }
+
+  /// Moves the expired timers of the current level 0 slot to the pending list.
+  inline void collect(time_point now) {
+    const std::uint16_t s = (std::uint16_t)(_current_tick & slot_mask);
+    for (std::uint32_t i = _heads[s]; i != npos;) {
+      const std::uint32_t next = _nodes[i].next;
+      if (_nodes[i].deadline <= now) {
+        unlink(i);
+        _nodes[i].slot = pending_slot;
+        _expired.push_back(make_id(i, _nodes[i].generation));
+      }
+      i = next;
+    }
+  }
+
+  /// Relinks the higher level slots reached by the current tick.
+  inline void cascade() noexcept {
+    for (size_type l = 1; l < level_count; l++) {
+      const std::uint64_t level_tick = _current_tick >> (l * slot_bits);
+      const std::uint16_t s = (std::uint16_t)(l * slot_count + (level_tick & slot_mask));
+
+      std::uint32_t i = _heads[s];
+      _heads[s] = npos;
+      _occupancy[l] &= ~(std::uint64_t(1) << (level_tick & slot_mask));
+
+      while (i != npos) {
+        const std::uint32_t next = _nodes[i].next;
+        link(i);
+        i = next;
+      }
+
+      if (level_tick & slot_mask) {
+        break;
+      }
+    }
+  }
+};
+} // namespace fst.
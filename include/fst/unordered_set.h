@@ -33,12 +33,22 @@
 
 #pragma once
 #include "fst/assert.h"
+#include "fst/bitset.h"
 #include "fst/span.h"
 #include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
 #include <vector>
 
 namespace fst {
-template <typename _T>
+/// Sparse set of integers in [0, maximum_size()).
+///
+/// The values are kept in a dense array and a packed bitset tracks membership.
+/// The sparse index array holds the position of each value in the dense array so erase() is O(1).
+/// clear() only touches the bits of the contained values.
+/// All three arrays are allocated with _Allocator, rebound to their element type.
+template <typename _T, typename _Allocator = std::allocator<_T>>
 class unordered_set {
 public:
   using value_type = _T;
@@ -48,9 +58,33 @@ public:
   using const_iterator = const_pointer;
   using size_type = std::size_t;
   using difference_type = std::ptrdiff_t;
+  using allocator_type = _Allocator;
 
   static_assert(std::is_integral<value_type>::value, "Integral type required.");
 
+private:
+  using index_type = std::uint32_t;
+
+  template <typename _Up>
+  using rebind_alloc = typename std::allocator_traits<allocator_type>::template rebind_alloc<_Up>;
+
+public:
+  using bitset_type = fst::basic_bitset<rebind_alloc<std::uint64_t>>;
+
+  unordered_set() = default;
+
+  inline explicit unordered_set(const allocator_type& alloc)
+      : _content(alloc)
+      , _index(rebind_alloc<index_type>(alloc))
+      , _bits(rebind_alloc<std::uint64_t>(alloc)) {}
+
+  inline explicit unordered_set(size_type __size, const allocator_type& alloc = allocator_type())
+      : unordered_set(alloc) {
+    resize(__size);
+  }
+
+  inline allocator_type get_allocator() const noexcept { return _content.get_allocator(); }
+
   inline size_type size() const { return _content_size; }
 
   inline size_type maximum_size() const { return _maximum_size; }
@@ -58,73 +92,131 @@ public:
   inline bool empty() const noexcept { return _content_size == 0; }
 
   inline void resize(size_type __size) {
-    fst_assert(_maximum_size >= _content_size,
-        "unordered_set::resize Can't downsize when content size is greather than size.");
+    fst_assert(
+        __size >= _content_size, "unordered_set::resize Can't downsize when content size is greather than size.");
 
     _content.resize(__size);
-    _is_in_content.resize(__size, false);
+    _index.resize(__size);
+    _bits.resize(__size);
     _maximum_size = __size;
   }
 
   inline void insert(value_type value) {
-    fst_assert(value < _maximum_size, "unordered_set::insert Out of bound value.");
-    if (_is_in_content[value]) {
+    fst_assert((size_type)value < _maximum_size, "unordered_set::insert Out of bound value.");
+    if (contains(value)) {
       return;
     }
 
-    _content[_content_size] = value;
-    _content_size++;
-    _is_in_content[value] = true;
+    _bits.set((size_type)value);
+    _index[(size_type)value] = (index_type)_content_size;
+    _content[_content_size++] = value;
   }
 
-  void erase(value_type value) {
-    fst_assert(value < _maximum_size, "unordered_set::erase Out of bound value.");
-    if (!_is_in_content[value]) {
+  inline void erase(value_type value) {
+    fst_assert((size_type)value < _maximum_size, "unordered_set::erase Out of bound value.");
+    if (!contains(value)) {
       return;
     }
 
-    _is_in_content[value] = false;
+    _bits.reset((size_type)value);
 
-    size_type f_index = std::numeric_limits<size_type>::max();
+    // The last value takes the place of the erased one.
+    const size_type index = _index[(size_type)value];
+    const value_type last = _content[--_content_size];
+    _content[index] = last;
+    _index[(size_type)last] = (index_type)index;
+  }
+
+  /// Erases all the values satisfying pred while compacting the dense array in a single pass.
+  template <class _Predicate>
+  inline void erase_if(_Predicate pred) {
+    size_type count = 0;
     for (size_type i = 0; i < _content_size; i++) {
-      if (_content[i] == value) {
-        f_index = i;
-        break;
+      const value_type v = _content[i];
+      if (pred(v)) {
+        _bits.reset((size_type)v);
+      }
+      else {
+        _index[(size_type)v] = (index_type)count;
+        _content[count++] = v;
       }
     }
 
-    fst_assert(f_index != std::numeric_limits<size_type>::max(), "unordered_set::erase Could not find value.");
-
-    if (f_index != _content_size) {
-      _content[f_index] = std::move(_content[_content_size - 1]);
-    }
-
-    _content_size--;
+    _content_size = count;
   }
 
   inline bool contains(value_type value) const noexcept {
-    fst_assert(value < _maximum_size, "unordered_set::contains Out of bound value.");
-    return _is_in_content[value];
+    fst_assert((size_type)value < _maximum_size, "unordered_set::contains Out of bound value.");
+    return _bits.test((size_type)value);
   }
 
   void clear() noexcept {
-    std::fill(_is_in_content.begin(), _is_in_content.end(), false);
+    if (_content_size > _bits.word_count()) {
+      _bits.reset();
+    }
+    else {
+      for (size_type i = 0; i < _content_size; i++) {
+        _bits.reset((size_type)_content[i]);
+      }
+    }
+
     _content_size = 0;
   }
 
+  //
+  // Set algebra.
+  //
+
+  /// Union.
+  inline void insert(const unordered_set& s) {
+    for (value_type v : s) {
+      insert(v);
+    }
+  }
+
+  /// Keeps the values that are also in s.
+  inline void intersect(const unordered_set& s) {
+    erase_if([&s](value_type v) { return (size_type)v >= s.maximum_size() || !s.contains(v); });
+  }
+
+  /// Removes the values of s.
+  inline void subtract(const unordered_set& s) {
+    if (s.size() < size()) {
+      for (value_type v : s) {
+        if ((size_type)v < _maximum_size) {
+          erase(v);
+        }
+      }
+    }
+    else {
+      erase_if([&s](value_type v) { return (size_type)v < s.maximum_size() && s.contains(v); });
+    }
+  }
+
+  /// Number of values in both sets, computed with popcount on the bitsets.
+  inline size_type intersection_size(const unordered_set& s) const noexcept { return _bits.intersection_count(s._bits); }
+
+  /// Membership bitset, bit i is set when value i is in the set.
+  inline const bitset_type& bits() const noexcept { return _bits; }
+
   inline fst::span<const value_type> content() const {
-    return fst::span<const value_type>(&_content[0], _content_size);
+    return fst::span<const value_type>(_content.data(), _content_size);
   }
 
   inline const_reference operator[](size_type index) const { return _content[index]; }
 
-  inline const_iterator begin() const noexcept { return _content.begin(); }
-  inline const_iterator end() const noexcept { return _content.begin() + _content_size; }
+  inline const_iterator begin() const noexcept { return _content.data(); }
+  inline const_iterator end() const noexcept { return _content.data() + _content_size; }
 
 private:
-  std::vector<value_type> _content;
-  std::vector<bool> _is_in_content;
+  std::vector<value_type, allocator_type> _content;
+  std::vector<index_type, rebind_alloc<index_type>> _index;
+  bitset_type _bits;
   size_type _maximum_size = 0;
   size_type _content_size = 0;
 };
+
+/// unordered_set allocating from a std::pmr::memory_resource.
+template <typename _T>
+using pmr_unordered_set = unordered_set<_T, std::pmr::polymorphic_allocator<_T>>;
 } // namespace fst.
@@ -7,6 +7,8 @@
 
 #include "test_types.h"
 
+#include <vector>
+
 namespace helper {
 inline bool is_aligned(const void* ptr, std::uintptr_t alignment) noexcept {
   auto iptr = reinterpret_cast<std::uintptr_t>(ptr);
@@ -194,4 +196,35 @@ TEST(aligned_buffer, constructor) {
   //  EXPECT_EQ(a[0], 4);
   //  EXPECT_EQ(a[1], 5);
 }
+
+TEST(aligned_buffer, dynamic) {
+  fst::dynamic_aligned_buffer<float> buffer(1000);
+  EXPECT_EQ(buffer.size(), 1000);
+  EXPECT_TRUE(helper::is_aligned(buffer.data(), 64));
+  EXPECT_EQ(buffer[999], 0.0f);
+
+  buffer[10] = 2.0f;
+  fst::dynamic_aligned_buffer<float> copy = buffer;
+  EXPECT_EQ(copy[10], 2.0f);
+  EXPECT_TRUE(helper::is_aligned(copy.data(), 64));
+
+  fst::dynamic_aligned_buffer<float> moved = std::move(buffer);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(moved[10], 2.0f);
+
+  // Huge page sized buffers are aligned on the huge page size.
+  moved.reset(fst::aligned_memory::huge_page_size / sizeof(float) + 1);
+  EXPECT_TRUE(helper::is_aligned(moved.data(), fst::aligned_memory::huge_page_size));
+}
+
+TEST(aligned_buffer, allocator) {
+  std::vector<double, fst::aligned_allocator<double, 32>> v;
+  for (int i = 0; i < 100; i++) {
+    v.push_back(i);
+    EXPECT_TRUE(helper::is_aligned(v.data(), 32));
+  }
+
+  std::vector<std::uint8_t, fst::aligned_allocator<std::uint8_t>> bytes(3);
+  EXPECT_TRUE(helper::is_aligned(bytes.data(), 64));
+}
 } // namespace
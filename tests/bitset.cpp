@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include "fst/bitset.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+TEST(bitset, fixed) {
+  fst::fixed_bitset<130> b;
+  EXPECT_TRUE(b.none());
+  EXPECT_EQ(b.find_first(), 130);
+
+  b.set(0);
+  b.set(64);
+  b.set(129);
+  EXPECT_EQ(b.count(), 3);
+  EXPECT_TRUE(b.test(64));
+  EXPECT_FALSE(b.test(63));
+
+  std::vector<std::size_t> indices;
+  b.for_each([&](std::size_t i) { indices.push_back(i); });
+  EXPECT_EQ(indices, std::vector<std::size_t>({ 0, 64, 129 }));
+
+  EXPECT_EQ(b.find_next(1), 64);
+  EXPECT_EQ(b.find_next(65), 129);
+  EXPECT_EQ(b.find_next(130), 130);
+
+  b.reset(64);
+  EXPECT_EQ(b.count(), 2);
+
+  fst::fixed_bitset<130> all;
+  all.set();
+  EXPECT_EQ(all.count(), 130);
+  EXPECT_EQ((~all).count(), 0);
+  EXPECT_EQ((all - b).count(), 128);
+  EXPECT_EQ((all & b), b);
+  EXPECT_EQ((all ^ b).count(), 128);
+  EXPECT_EQ(all.intersection_count(b), 2);
+  EXPECT_TRUE(b.is_subset_of(all));
+  EXPECT_FALSE(all.is_subset_of(b));
+}
+
+TEST(bitset, runtime) {
+  fst::bitset b(200);
+  EXPECT_EQ(b.size(), 200);
+  EXPECT_TRUE(b.none());
+
+  b.set(3);
+  b.set(70);
+  b.set(199);
+  EXPECT_EQ(b.count(), 3);
+  EXPECT_EQ(b.find_first(), 3);
+  EXPECT_EQ(b.find_next(4), 70);
+  EXPECT_EQ(b.find_next(71), 199);
+  EXPECT_EQ(b.find_next(200), 200);
+
+  std::vector<std::size_t> indices;
+  b.for_each([&](std::size_t i) { indices.push_back(i); });
+  EXPECT_EQ(indices, std::vector<std::size_t>({ 3, 70, 199 }));
+
+  fst::bitset all(200, true);
+  EXPECT_EQ(all.count(), 200);
+  EXPECT_EQ((~all).count(), 0);
+  EXPECT_EQ((all - b).count(), 197);
+  EXPECT_EQ((all & b), b);
+  EXPECT_EQ((all ^ b).count(), 197);
+  EXPECT_EQ((all | b), all);
+  EXPECT_TRUE(b.is_subset_of(all));
+  EXPECT_FALSE(all.is_subset_of(b));
+  EXPECT_TRUE(b.intersects(all));
+
+  b.resize(300, true);
+  EXPECT_EQ(b.count(), 103);
+  EXPECT_TRUE(b.test(200));
+  EXPECT_FALSE(b.test(198));
+  b.resize(71);
+  EXPECT_EQ(b.count(), 2);
+}
+
+TEST(bitset, rank_select) {
+  std::mt19937 gen(12);
+  fst::bitset b(5000);
+  std::vector<std::size_t> indices;
+  for (std::size_t i = 0; i < b.size(); i++) {
+    if (gen() % 3 == 0) {
+      b.set(i);
+      indices.push_back(i);
+    }
+  }
+
+  fst::bitset_rank_index index(b);
+  EXPECT_EQ(index.count(), indices.size());
+
+  std::size_t rank = 0;
+  for (std::size_t i = 0; i <= b.size(); i++) {
+    EXPECT_EQ(b.rank(i), rank);
+    EXPECT_EQ(index.rank(i), rank);
+    if (i < b.size() && b.test(i)) {
+      rank++;
+    }
+  }
+
+  for (std::size_t k = 0; k < indices.size(); k++) {
+    EXPECT_EQ(b.select(k), indices[k]);
+    EXPECT_EQ(index.select(k), indices[k]);
+  }
+
+  EXPECT_EQ(b.select(indices.size()), fst::bitset::npos);
+  EXPECT_EQ(index.select(indices.size()), fst::bitset_rank_index::npos);
+}
+} // namespace
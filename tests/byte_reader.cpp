@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include "fst/byte_reader.h"
+#include "fst/byte_vector.h"
+
+#include <limits>
+
+namespace {
+TEST(byte_reader, read) {
+  fst::byte_vector bv;
+  bv.push_back(std::uint8_t(7));
+  bv.push_back(std::int32_t(-32));
+  bv.push_back<std::uint16_t, false>(std::uint16_t(0x1234));
+  bv.push_back(2.5f);
+
+  fst::byte_reader reader(bv);
+  EXPECT_EQ(reader.size(), bv.size());
+  EXPECT_EQ(reader.read<std::uint8_t>(), 7);
+
+  // Unaligned read.
+  EXPECT_EQ(reader.peek<std::int32_t>(), -32);
+  EXPECT_EQ(reader.read<std::int32_t>(), -32);
+  EXPECT_EQ((reader.read<std::uint16_t, false>()), 0x1234);
+  EXPECT_EQ(reader.read<float>(), 2.5f);
+  EXPECT_TRUE(reader.empty());
+  EXPECT_TRUE(reader.is_valid());
+
+  // Reading past the end sets the error state.
+  EXPECT_EQ(reader.read<std::uint32_t>(), 0);
+  EXPECT_TRUE(reader.has_error());
+  EXPECT_FALSE(reader.seek(0));
+
+  reader.clear_error();
+  EXPECT_TRUE(reader.seek(1));
+  ASSERT_TRUE(reader.require(sizeof(std::int32_t) + sizeof(std::uint16_t)));
+  EXPECT_EQ(reader.read_unchecked<std::int32_t>(), -32);
+  EXPECT_EQ((reader.read_unchecked<std::uint16_t, false>()), 0x1234);
+  EXPECT_FALSE(reader.require(5));
+
+  // count * sizeof(T) would wrap around to a small size.
+  reader.clear_error();
+  EXPECT_TRUE(reader.seek(0));
+  std::uint32_t buffer[2] = {};
+  EXPECT_FALSE(reader.read(buffer, std::numeric_limits<std::size_t>::max() / 2 + 2));
+  EXPECT_TRUE(reader.has_error());
+  EXPECT_EQ(reader.position(), 0);
+}
+
+TEST(byte_reader, varint) {
+  const std::uint8_t data[] = { 0x01, 0xAC, 0x02, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x03 };
+  fst::byte_reader reader(data, sizeof(data));
+  EXPECT_EQ(reader.read_varint(), 1);
+  EXPECT_EQ(reader.read_varint(), 300);
+  EXPECT_EQ(reader.read_varint(), std::numeric_limits<std::uint64_t>::max());
+  EXPECT_EQ(reader.read_signed_varint(), -2);
+  EXPECT_TRUE(reader.empty());
+  EXPECT_TRUE(reader.is_valid());
+
+  // Truncated varint.
+  const std::uint8_t truncated[] = { 0x80, 0x80 };
+  fst::byte_reader t_reader(truncated, sizeof(truncated));
+  EXPECT_EQ(t_reader.read_varint(), 0);
+  EXPECT_TRUE(t_reader.has_error());
+}
+
+TEST(byte_reader, strings) {
+  fst::byte_vector bv;
+  bv.push_back(std::uint16_t(5));
+  bv.push_back("Hello");
+  bv.push_back(std::uint8_t(3));
+  bv.push_back("abc");
+  bv.push_back(std::uint32_t(100));
+  bv.push_back("abc");
+
+  fst::byte_reader reader(bv);
+  EXPECT_EQ(reader.read_prefixed_string<std::uint16_t>(), "Hello");
+  EXPECT_EQ(reader.read_varint_prefixed_string(), "abc");
+  EXPECT_EQ(reader.read_prefixed_string(), "");
+  EXPECT_TRUE(reader.has_error());
+}
+
+TEST(byte_reader, pcm) {
+  fst::byte_vector bv;
+  bv.push_back<float, fst::byte_vector::convert_options::pcm_24_bit>(0.5f);
+  bv.push_back<float, fst::byte_vector::convert_options::pcm_16_bit>(-0.5f);
+
+  fst::byte_reader reader(bv);
+  EXPECT_FLOAT_EQ((reader.read<float, fst::byte_reader::convert_options::pcm_24_bit>()), 0.5f);
+  EXPECT_FLOAT_EQ((reader.read<float, fst::byte_reader::convert_options::pcm_16_bit>()), -0.5f);
+  EXPECT_TRUE(reader.empty());
+}
+} // namespace
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "fst/byte_searcher.h"
+#include "fst/byte_vector.h"
+#include "fst/byte_view.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+namespace {
+std::ptrdiff_t reference_find(std::string_view data, std::string_view needle, std::size_t offset) {
+  std::size_t index = data.find(needle, offset);
+  return index == std::string_view::npos ? -1 : (std::ptrdiff_t)index;
+}
+
+TEST(byte_searcher, find) {
+  std::string data(5000, 'a');
+  data += "fmt ";
+  data += std::string(100, 'b');
+  data += "data";
+  data += std::string(37, 'c');
+
+  fst::byte_searcher fmt("fmt ");
+  EXPECT_EQ(fmt.find(data.data(), data.size()), 5000);
+  EXPECT_EQ(fmt.find(data.data(), data.size(), 5001), -1);
+
+  fst::byte_view view((const std::uint8_t*)data.data(), data.size());
+  EXPECT_EQ(view.find("data", 4), 5104);
+  EXPECT_EQ(view.find(fst::byte_searcher("LIST")), -1);
+  EXPECT_EQ(view.find("c", 1), 5108);
+  EXPECT_EQ(view.find(5109, "c", 1), 5109);
+
+  fst::byte_vector bv(data);
+  EXPECT_EQ(bv.find("data", 4), 5104);
+  EXPECT_EQ(bv.find(fmt), 5000);
+}
+
+TEST(byte_searcher, find_all) {
+  std::string data = "abcabcabcab";
+  fst::byte_view view((const std::uint8_t*)data.data(), data.size());
+
+  std::vector<std::size_t> indexes = view.find_all("abc", 3);
+  EXPECT_EQ(indexes, std::vector<std::size_t>({ 0, 3, 6 }));
+
+  // Overlapping matches.
+  indexes = view.find_all(fst::byte_searcher("abcab"));
+  EXPECT_EQ(indexes, std::vector<std::size_t>({ 0, 3, 6 }));
+
+  EXPECT_TRUE(view.find_all(fst::byte_searcher("")).empty());
+}
+
+TEST(byte_searcher, random) {
+  std::mt19937 gen(12);
+  std::uniform_int_distribution<int> dist('a', 'c');
+
+  std::string data(4096, 'a');
+  std::generate(data.begin(), data.end(), [&]() { return (char)dist(gen); });
+
+  // Covers the memchr, simd filter and horspool paths.
+  for (std::size_t k : { 1, 2, 3, 5, 8, 16, 31, 32, 33, 40, 64 }) {
+    for (std::size_t n = 0; n < 20; n++) {
+      std::size_t pos = std::uniform_int_distribution<std::size_t>(0, data.size() - k)(gen);
+      std::string needle = data.substr(pos, k);
+      fst::byte_searcher searcher(needle);
+
+      for (std::size_t offset : { std::size_t(0), pos / 2, pos }) {
+        EXPECT_EQ(searcher.find(data.data(), data.size(), offset), reference_find(data, needle, offset));
+        EXPECT_EQ(fst::find_bytes(data.data(), data.size(), needle.data(), needle.size(), offset),
+            reference_find(data, needle, offset));
+      }
+    }
+  }
+}
+} // namespace
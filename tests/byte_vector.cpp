@@ -125,4 +125,75 @@ TEST(byte_vector, file_open) {
     EXPECT_EQ(bv[3], 't');
   }
 }
+
+TEST(byte_vector, small_buffer) {
+  using vector_type = fst::small_byte_vector<16>;
+  vector_type bv;
+  bv.push_back(std::int32_t(32));
+  bv.push_back(std::int32_t(64));
+  EXPECT_EQ(bv.size(), 2 * sizeof(std::int32_t));
+  EXPECT_EQ(bv.as<std::int32_t>(0), 32);
+  EXPECT_EQ(bv.as<std::int32_t>(sizeof(std::int32_t)), 64);
+  EXPECT_EQ(bv.as<std::int32_t>(bv.begin() + sizeof(std::int32_t)), 64);
+
+  // Grow past the inline storage.
+  for (std::int32_t i = 0; i < 32; i++) {
+    bv.push_back(i);
+  }
+
+  EXPECT_EQ(bv.size(), 34 * sizeof(std::int32_t));
+  EXPECT_EQ(bv.as<std::int32_t>(0), 32);
+  for (std::int32_t i = 0; i < 32; i++) {
+    EXPECT_EQ(bv.as<std::int32_t>(2 * sizeof(std::int32_t), i), i);
+  }
+
+  vector_type copy = bv;
+  EXPECT_EQ(copy.size(), bv.size());
+  EXPECT_EQ(copy.as<std::int32_t>(2 * sizeof(std::int32_t), 31), 31);
+
+  vector_type moved = std::move(copy);
+  EXPECT_EQ(moved.size(), bv.size());
+  EXPECT_EQ(copy.size(), 0);
+
+  // Grown bytes are zeroed like with the std::vector buffer.
+  moved.resize(200);
+  EXPECT_EQ(std::count(moved.begin() + 34 * sizeof(std::int32_t), moved.end(), 0), 200 - 34 * sizeof(std::int32_t));
+
+  // Small content stays inline when moved.
+  vector_type small_bv("abc");
+  vector_type small_moved = std::move(small_bv);
+  EXPECT_EQ(small_moved.size(), 3);
+  EXPECT_EQ(small_moved[2], 'c');
+
+  fst::byte_vector regular;
+  regular.push_back(small_moved);
+  EXPECT_EQ(regular.size(), 3);
+  EXPECT_EQ(regular[0], 'a');
+}
+
+TEST(byte_vector, pmr_buffer) {
+  std::array<std::uint8_t, 1024> storage;
+  std::pmr::monotonic_buffer_resource arena(storage.data(), storage.size(), std::pmr::null_memory_resource());
+
+  fst::pmr_byte_vector bv(&arena);
+  bv.push_back(std::int32_t(32));
+  bv.push_back(std::int32_t(64));
+
+  EXPECT_EQ(bv.size(), 2 * sizeof(std::int32_t));
+  EXPECT_EQ(bv.as<std::int32_t>(0), 32);
+  EXPECT_EQ(bv.as<std::int32_t>(sizeof(std::int32_t)), 64);
+  EXPECT_GE(bv.data(), storage.data());
+  EXPECT_LT(bv.data(), storage.data() + storage.size());
+}
+
+TEST(byte_vector, aligned_buffer) {
+  fst::aligned_byte_vector bv;
+  for (std::int32_t i = 0; i < 100; i++) {
+    bv.push_back(i);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(bv.data()) % 64, 0);
+  }
+
+  EXPECT_EQ(bv.size(), 100 * sizeof(std::int32_t));
+  EXPECT_EQ(bv.as<std::int32_t>(99 * sizeof(std::int32_t)), 99);
+}
 } // namespace
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include "fst/event_manager.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+using namespace std::chrono_literals;
+
+template <typename _Fct>
+bool wait_for(_Fct&& fct, std::chrono::milliseconds timeout = 2000ms) {
+  const auto end = std::chrono::steady_clock::now() + timeout;
+  while (!fct()) {
+    if (std::chrono::steady_clock::now() > end) {
+      return false;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+
+TEST(event_manager, events) {
+  fst::event_manager em;
+  em.init(1);
+
+  std::atomic<int> once = 0;
+  std::atomic<int> recurrent = 0;
+  fst::event_manager::event_id once_id = em.add_event([&]() { once++; });
+  fst::event_manager::event_id recurrent_id = em.add_recurrent_event([&]() { recurrent++; }, 2);
+
+  EXPECT_TRUE(wait_for([&]() { return once == 1 && recurrent >= 3; }));
+  EXPECT_FALSE(em.is_connected(once_id));
+  EXPECT_TRUE(em.is_connected(recurrent_id));
+
+  EXPECT_TRUE(em.remove_event(recurrent_id));
+  EXPECT_FALSE(em.remove_event(recurrent_id));
+  EXPECT_FALSE(em.is_connected(recurrent_id));
+  EXPECT_EQ(once, 1);
+}
+
+TEST(event_manager, deadlines) {
+  fst::event_manager em;
+  em.init();
+
+  // Many timers, far more than the previous 64 events limit.
+  std::atomic<int> count = 0;
+  for (int i = 0; i < 1000; i++) {
+    em.add_event([&]() { count++; }, std::chrono::microseconds(i * 10));
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  std::atomic<bool> fired = false;
+  std::chrono::steady_clock::time_point fired_time;
+  em.add_event(
+      [&]() {
+        fired_time = std::chrono::steady_clock::now();
+        fired = true;
+      },
+      20ms);
+
+  EXPECT_TRUE(wait_for([&]() { return fired && count == 1000; }));
+  EXPECT_GE(fired_time - start, 20ms);
+
+  fst::event_manager::disconnector d(em, em.add_recurrent_event([]() {}, 1ms));
+  EXPECT_TRUE(d.is_connected());
+  d.disconnect();
+  EXPECT_FALSE(d.is_valid());
+}
+
+TEST(event_manager, wake_up) {
+  fst::event_manager em;
+  em.init();
+
+  // Parked until a far deadline, an earlier event from another thread wakes it up.
+  em.add_event([]() {}, std::chrono::hours(1));
+  std::this_thread::sleep_for(5ms);
+
+  std::atomic<int> count = 0;
+  std::vector<std::thread> producers;
+  for (int t = 0; t < 4; t++) {
+    producers.emplace_back([&]() {
+      for (int i = 0; i < 100; i++) {
+        em.add_event([&]() { count++; });
+      }
+    });
+  }
+
+  for (std::thread& t : producers) {
+    t.join();
+  }
+
+  // Events added while it's awake are drained before it parks again.
+  EXPECT_TRUE(wait_for([&]() { return count == 400; }));
+}
+
+TEST(event_manager, reentrant) {
+  fst::event_manager em;
+  em.init(1);
+
+  // A callback adding an event and removing itself.
+  std::atomic<int> count = 0;
+  std::atomic<bool> added_fired = false;
+  fst::event_manager::event_id id = fst::event_manager::invalid_id;
+  std::atomic<bool> has_id = false;
+  id = em.add_recurrent_event(
+      [&]() {
+        if (!has_id || count++) {
+          return;
+        }
+
+        em.add_event([&]() { added_fired = true; });
+        em.remove_event(id);
+      },
+      1ms);
+  has_id = true;
+
+  EXPECT_TRUE(wait_for([&]() { return added_fired.load(); }));
+  EXPECT_FALSE(em.is_connected(id));
+}
+
+TEST(event_manager, workers) {
+  fst::event_manager em;
+  em.init(1, 4);
+
+  std::atomic<int> count = 0;
+  for (int i = 0; i < 100; i++) {
+    em.add_event([&]() { count++; }, std::chrono::microseconds(i * 10));
+  }
+
+  EXPECT_TRUE(wait_for([&]() { return count == 100; }));
+}
+
+TEST(event_manager, shared_workers) {
+  fst::thread_pool pool(2);
+  std::atomic<int> count = 0;
+  {
+    fst::event_manager em;
+    em.init(1, pool);
+    for (int i = 0; i < 100; i++) {
+      em.add_event([&]() { count++; });
+    }
+
+    EXPECT_TRUE(wait_for([&]() { return count == 100; }));
+  }
+
+  pool.push([&]() { count++; });
+  EXPECT_TRUE(wait_for([&]() { return count == 101; }));
+}
+
+TEST(event_manager, pending) {
+  // Not started, the events stay in the queue.
+  fst::event_manager em;
+
+  std::atomic<int> count = 0;
+  fst::event_manager::event_id removed_id = em.add_event([&]() { count += 10; });
+  fst::event_manager::event_id id = em.add_event([&]() { count++; });
+  EXPECT_NE(removed_id, id);
+  EXPECT_TRUE(em.is_connected(removed_id));
+  EXPECT_TRUE(em.is_connected(id));
+
+  EXPECT_TRUE(em.remove_event(removed_id));
+  EXPECT_FALSE(em.remove_event(removed_id));
+  EXPECT_FALSE(em.is_connected(removed_id));
+  EXPECT_TRUE(em.is_connected(id));
+
+  em.init(1);
+  EXPECT_TRUE(wait_for([&]() { return count == 1; }));
+  EXPECT_TRUE(wait_for([&]() { return !em.is_connected(id); }));
+  EXPECT_EQ(count, 1);
+}
+
+TEST(event_manager, disconnect_waits) {
+  // On the event thread and on workers, recurrent and one shot.
+  for (std::size_t worker_count : { 0, 2 }) {
+    for (bool is_recurrent : { true, false }) {
+      fst::event_manager em;
+      em.init(1, worker_count);
+
+      struct state {
+        std::atomic<bool> entered = false;
+        std::atomic<bool> returned = false;
+        std::atomic<int> count = 0;
+      };
+
+      auto s = std::make_unique<state>();
+      auto callback = [s = s.get()]() {
+        s->count++;
+        s->entered = true;
+        std::this_thread::sleep_for(20ms);
+        s->returned = true;
+      };
+
+      {
+        fst::event_manager::disconnector d(
+            em, is_recurrent ? em.add_recurrent_event(callback, 1ms) : em.add_event(callback));
+        EXPECT_TRUE(wait_for([&]() { return s->entered.load(); }));
+      }
+
+      EXPECT_TRUE(s->returned);
+      const int count = s->count;
+      std::this_thread::sleep_for(10ms);
+      EXPECT_EQ(s->count, count);
+
+      // A callback using it after the disconnector would be a use after free.
+      s.reset();
+    }
+  }
+}
+} // namespace
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include "fst/fixed_unordered_set.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+
+namespace {
+TEST(fixed_unordered_set, insert_erase) {
+  fst::fixed_unordered_set<int, 100> set;
+  EXPECT_TRUE(set.empty());
+
+  set.insert(5);
+  set.insert(7);
+  set.insert(5);
+  set.insert(99);
+  EXPECT_EQ(set.size(), 3);
+  EXPECT_TRUE(set.contains(7));
+
+  set.erase(5);
+  EXPECT_EQ(set.size(), 2);
+  EXPECT_FALSE(set.contains(5));
+  EXPECT_TRUE(set.contains(7));
+  EXPECT_TRUE(set.contains(99));
+
+  set.erase(5);
+  EXPECT_EQ(set.size(), 2);
+
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_FALSE(set.contains(7));
+
+  fst::enum_unordered_set<std::size_t, std::integral_constant<std::size_t, 0>, 8> eset;
+  eset.insert(std::size_t(3));
+  EXPECT_TRUE(eset.contains(std::size_t(3)));
+
+  fst::lock_free_fixed_unordered_set<int, 16> lset;
+  lset.insert(2);
+  lset.insert(4);
+  lset.erase(2);
+  EXPECT_EQ(lset.get_content().size(), 1);
+}
+
+TEST(fixed_unordered_set, random) {
+  fst::fixed_unordered_set<std::uint16_t, 1000> set;
+  std::set<std::uint16_t> ref;
+  std::mt19937 gen(35);
+  std::uniform_int_distribution<int> dist(0, 999);
+
+  for (int i = 0; i < 20000; i++) {
+    const std::uint16_t v = (std::uint16_t)dist(gen);
+    if (i % 2) {
+      set.erase(v);
+      ref.erase(v);
+    }
+    else {
+      set.insert(v);
+      ref.insert(v);
+    }
+  }
+
+  ASSERT_EQ(set.size(), ref.size());
+  EXPECT_EQ(set.bits().count(), ref.size());
+  std::set<std::uint16_t> content(set.begin(), set.end());
+  EXPECT_EQ(content, ref);
+}
+
+TEST(fixed_unordered_set, algebra) {
+  fst::fixed_unordered_set<int, 300> a;
+  fst::fixed_unordered_set<int, 300> b;
+  for (int i = 0; i < 300; i += 2) {
+    a.insert(i);
+  }
+  for (int i = 0; i < 300; i += 5) {
+    b.insert(i);
+  }
+
+  EXPECT_EQ(a.intersection_size(b), 30);
+  EXPECT_TRUE(a.intersects(b));
+
+  fst::fixed_unordered_set<int, 300> u = a;
+  u.insert(b);
+  EXPECT_EQ(u.size(), 150 + 60 - 30);
+  EXPECT_TRUE(a.is_subset_of(u));
+  EXPECT_TRUE(b.is_subset_of(u));
+
+  fst::fixed_unordered_set<int, 300> i = a;
+  i.intersect(b);
+  EXPECT_EQ(i.size(), 30);
+  for (int v : i) {
+    EXPECT_EQ(v % 10, 0);
+  }
+
+  fst::fixed_unordered_set<int, 300> d = a;
+  d.subtract(b);
+  EXPECT_EQ(d.size(), 120);
+  EXPECT_FALSE(d.intersects(b));
+
+  d.erase_if([](int v) { return v < 100; });
+  EXPECT_TRUE(std::all_of(d.begin(), d.end(), [](int v) { return v >= 100; }));
+  EXPECT_FALSE(d.contains(2));
+  EXPECT_TRUE(d.contains(102));
+  d.erase(102);
+  EXPECT_FALSE(d.contains(102));
+
+  fst::fixed_unordered_set<int, 300> e = { 1, 2, 3 };
+  fst::fixed_unordered_set<int, 300> f = { 3, 2, 1 };
+  EXPECT_EQ(e, f);
+}
+} // namespace
@@ -2,6 +2,9 @@
 
 #include "fst/fixed_vector.h"
 
+#include <string>
+#include <vector>
+
 namespace {
 TEST(fixed_vector, constructor) {
   fst::fixed_vector<float, 2> a;
@@ -63,4 +66,74 @@ TEST(fixed_vector, push) {
   EXPECT_EQ(d[0], pair_type(3, 4));
   EXPECT_EQ(d[1], pair_type(5, 6));
 }
+
+TEST(fixed_vector, range_trivial) {
+  fst::stack_fixed_vector<int, 32> a;
+  a.assign({ 0, 1, 2, 3, 4, 5, 6, 7 });
+  EXPECT_EQ(a.size(), 8);
+
+  a.erase(a.begin() + 2, a.begin() + 5);
+  EXPECT_EQ(std::vector<int>(a.begin(), a.end()), std::vector<int>({ 0, 1, 5, 6, 7 }));
+
+  a.erase((std::size_t)0);
+  EXPECT_EQ(std::vector<int>(a.begin(), a.end()), std::vector<int>({ 1, 5, 6, 7 }));
+
+  const int values[] = { 20, 21, 22 };
+  a.insert(a.begin() + 1, std::begin(values), std::end(values));
+  EXPECT_EQ(std::vector<int>(a.begin(), a.end()), std::vector<int>({ 1, 20, 21, 22, 5, 6, 7 }));
+
+  a.insert(a.end(), 2, 9);
+  a.insert(a.begin(), a[3]);
+  EXPECT_EQ(std::vector<int>(a.begin(), a.end()), std::vector<int>({ 22, 1, 20, 21, 22, 5, 6, 7, 9, 9 }));
+
+  a.append(fst::span<const int>(values, 2));
+  EXPECT_EQ(a.size(), 12);
+  EXPECT_EQ(a.back(), 21);
+
+  EXPECT_EQ(a.erase_if([](int v) { return v >= 20; }), 6);
+  EXPECT_EQ(std::vector<int>(a.begin(), a.end()), std::vector<int>({ 1, 5, 6, 7, 9, 9 }));
+
+  a.assign(3, 4);
+  EXPECT_EQ(std::vector<int>(a.begin(), a.end()), std::vector<int>({ 4, 4, 4 }));
+
+  a.resize(5, 8);
+  EXPECT_EQ(std::vector<int>(a.begin(), a.end()), std::vector<int>({ 4, 4, 4, 8, 8 }));
+}
+
+TEST(fixed_vector, range_non_trivial) {
+  using vector_type = fst::heap_fixed_vector<std::string, 32>;
+  auto to_vector = [](const vector_type& v) { return std::vector<std::string>(v.begin(), v.end()); };
+
+  vector_type a;
+  a.assign({ "a", "b", "c", "d" });
+
+  // Insert fewer elements than the tail.
+  const std::string values[] = { "x", "y", "z" };
+  a.insert(a.begin() + 1, values, values + 2);
+  EXPECT_EQ(to_vector(a), std::vector<std::string>({ "a", "x", "y", "b", "c", "d" }));
+
+  // More elements than the tail.
+  a.insert(a.begin() + 5, std::begin(values), std::end(values));
+  EXPECT_EQ(to_vector(a), std::vector<std::string>({ "a", "x", "y", "b", "c", "x", "y", "z", "d" }));
+
+  a.insert(a.begin(), std::string("first"));
+  a.insert(a.end() - 1, 2, std::string("n"));
+  EXPECT_EQ(to_vector(a), std::vector<std::string>({ "first", "a", "x", "y", "b", "c", "x", "y", "z", "n", "n", "d" }));
+
+  a.erase(a.begin() + 1, a.begin() + 4);
+  EXPECT_EQ(to_vector(a), std::vector<std::string>({ "first", "b", "c", "x", "y", "z", "n", "n", "d" }));
+
+  EXPECT_EQ(a.erase_if([](const std::string& s) { return s.size() == 1 && s[0] > 'm'; }), 5);
+  EXPECT_EQ(to_vector(a), std::vector<std::string>({ "first", "b", "c", "d" }));
+
+  a.assign(values, values + 2);
+  EXPECT_EQ(to_vector(a), std::vector<std::string>({ "x", "y" }));
+
+  a.assign(3, "k");
+  EXPECT_EQ(to_vector(a), std::vector<std::string>({ "k", "k", "k" }));
+
+  a.append(fst::span<const std::string>(values, 3));
+  EXPECT_EQ(a.size(), 6);
+  EXPECT_EQ(a.back(), "z");
+}
 } // namespace
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include "fst/flat_map.h"
+
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace {
+TEST(flat_map, small_string_keys) {
+  using key_type = fst::small_string<15>;
+  fst::flat_map<key_type, int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.contains("abc"));
+  EXPECT_EQ(map.find("abc"), map.end());
+
+  map["abc"] = 1;
+  map["def"] = 2;
+  EXPECT_TRUE(map.insert({ "ghi", 3 }).second);
+  EXPECT_FALSE(map.insert({ "ghi", 4 }).second);
+  EXPECT_EQ(map.size(), 3);
+
+  // Transparent lookups.
+  EXPECT_TRUE(map.contains(std::string_view("abc")));
+  EXPECT_EQ(map.at(std::string_view("def")), 2);
+  EXPECT_EQ(map.find(std::string_view("ghi"))->second, 3);
+  EXPECT_EQ(map.count("jkl"), 0);
+  EXPECT_THROW(map.at("jkl"), std::out_of_range);
+
+  EXPECT_TRUE(map.try_emplace(std::string_view("jkl"), 5).second);
+  EXPECT_EQ(map["jkl"], 5);
+
+  map.insert_or_assign("abc", 10);
+  EXPECT_EQ(map["abc"], 10);
+
+  EXPECT_EQ(map.erase("def"), 1);
+  EXPECT_EQ(map.erase("def"), 0);
+  EXPECT_EQ(map.size(), 3);
+
+  int sum = 0;
+  for (const auto& it : map) {
+    sum += it.second;
+  }
+  EXPECT_EQ(sum, 10 + 3 + 5);
+}
+
+TEST(flat_map, random) {
+  // Compare against std::map with many inserts and erases to exercise the tombstones and rehashes.
+  fst::flat_map<int, int> map;
+  std::map<int, int> ref;
+  std::mt19937 gen(32);
+  std::uniform_int_distribution<int> dist(0, 2000);
+
+  for (int i = 0; i < 50000; i++) {
+    const int key = dist(gen);
+    if (i % 3 == 0) {
+      EXPECT_EQ(map.erase(key), ref.erase(key));
+    }
+    else {
+      map[key] = i;
+      ref[key] = i;
+    }
+  }
+
+  EXPECT_EQ(map.size(), ref.size());
+  for (const auto& it : ref) {
+    auto m = map.find(it.first);
+    ASSERT_NE(m, map.end());
+    EXPECT_EQ(m->second, it.second);
+  }
+
+  std::size_t count = 0;
+  for (auto it = map.begin(); it != map.end(); ++it) {
+    EXPECT_EQ(ref.at(it->first), it->second);
+    count++;
+  }
+  EXPECT_EQ(count, ref.size());
+
+  // Erase while iterating.
+  for (auto it = map.begin(); it != map.end();) {
+    it = it->first % 2 ? map.erase(it) : std::next(it);
+  }
+
+  for (const auto& it : map) {
+    EXPECT_EQ(it.first % 2, 0);
+  }
+}
+
+TEST(flat_map, copy_move) {
+  fst::flat_map<std::string, std::unique_ptr<int>> map;
+  for (int i = 0; i < 100; i++) {
+    map.try_emplace(std::to_string(i), std::make_unique<int>(i));
+  }
+
+  fst::flat_map<std::string, std::unique_ptr<int>> moved = std::move(map);
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(moved.size(), 100);
+  EXPECT_EQ(*moved.at("42"), 42);
+
+  fst::flat_map<std::string, int> a = { { "a", 1 }, { "b", 2 } };
+  fst::flat_map<std::string, int> b = a;
+  b["c"] = 3;
+  EXPECT_EQ(a.size(), 2);
+  EXPECT_EQ(b.size(), 3);
+
+  a = b;
+  EXPECT_EQ(a.at("c"), 3);
+
+  a.clear();
+  EXPECT_TRUE(a.empty());
+  EXPECT_FALSE(a.contains("a"));
+  a.reserve(1000);
+  EXPECT_GE(a.capacity(), 1000);
+}
+} // namespace
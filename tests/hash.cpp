@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include "fst/hash.h"
+
+#include <string>
+#include <unordered_set>
+
+namespace {
+TEST(hash, strings) {
+  const char* str = "the quick brown fox jumps over the lazy dog, the quick brown fox jumps over the lazy dog";
+  for (std::size_t size = 0; size < std::strlen(str); size++) {
+    std::string_view view(str, size);
+    std::string s(view);
+    const std::size_t h = fst::hash<std::string_view>{}(view);
+    EXPECT_EQ(h, fst::hash<std::string>{}(s));
+
+    if (size <= 127) {
+      EXPECT_EQ(h, fst::hash<fst::small_string<127>>{}(fst::small_string<127>(view)));
+    }
+
+    char buffer[256];
+    std::memcpy(buffer, s.data(), s.size());
+    fst::unmanaged_string ustr(fst::span<char>(buffer, sizeof(buffer)), s.size());
+    EXPECT_EQ(h, fst::hash<fst::unmanaged_string>{}(ustr));
+  }
+
+  EXPECT_EQ(fst::hash_bytes("abc", 3), fst::hash_bytes("abc", 3));
+  EXPECT_NE(fst::hash_bytes("abc", 3), fst::hash_bytes("abd", 3));
+  EXPECT_NE(fst::hash_bytes("abc", 3, 1), fst::hash_bytes("abc", 3, 2));
+}
+
+TEST(hash, distribution) {
+  // Every size path, no collisions expected on 64 bits.
+  std::unordered_set<std::uint64_t> hashes;
+  std::string s;
+  for (int i = 0; i < 2000; i++) {
+    s = "key_" + std::to_string(i);
+    s.resize(i % 100 + s.size(), 'x');
+    hashes.insert(fst::hash_bytes(s.data(), s.size()));
+  }
+  EXPECT_EQ(hashes.size(), 2000);
+
+  // Lower bits used for the slot metadata must vary too.
+  std::unordered_set<std::uint64_t> low_bits;
+  for (int i = 0; i < 1000; i++) {
+    low_bits.insert(fst::hash<int>{}(i) & 0x7F);
+  }
+  EXPECT_EQ(low_bits.size(), 128);
+}
+} // namespace
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include "fst/inplace_function.h"
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace {
+struct counted {
+  static inline int count = 0;
+
+  counted() noexcept { count++; }
+  counted(const counted&) noexcept { count++; }
+  counted(counted&&) noexcept { count++; }
+  ~counted() { count--; }
+
+  int operator()(int a) const { return a * 2; }
+};
+
+TEST(inplace_function, call) {
+  fst::inplace_function<int(int, int)> add = [](int a, int b) { return a + b; };
+  EXPECT_TRUE(add);
+  EXPECT_EQ(add(1, 2), 3);
+
+  std::string str = "abc";
+  fst::inplace_function<void(const std::string&)> append = [&str](const std::string& s) { str += s; };
+  append("def");
+  EXPECT_EQ(str, "abcdef");
+
+  fst::inplace_function<void()> empty;
+  EXPECT_FALSE(empty);
+  EXPECT_TRUE(empty == nullptr);
+
+  // Mutable state is kept between calls.
+  fst::inplace_function<int()> counter = [i = 0]() mutable { return ++i; };
+  counter();
+  EXPECT_EQ(counter(), 2);
+}
+
+TEST(inplace_function, null) {
+  int (*null_fct)(int) = nullptr;
+  fst::inplace_function<int(int)> f = null_fct;
+  EXPECT_FALSE(f);
+
+  int (counted::*null_method)(int) const = nullptr;
+  fst::inplace_function<int(const counted&, int)> m = null_method;
+  EXPECT_FALSE(m);
+
+  fst::inplace_function<int(int)> empty_std = std::function<int(int)>();
+  EXPECT_FALSE(empty_std);
+
+  fst::inplace_function<int(int)> empty_inplace = fst::inplace_function<int(int), 16>();
+  EXPECT_FALSE(empty_inplace);
+
+  f = +[](int a) { return a + 1; };
+  EXPECT_TRUE(f);
+  EXPECT_EQ(f(1), 2);
+
+  m = &counted::operator();
+  EXPECT_TRUE(m);
+  EXPECT_EQ(m(counted(), 2), 4);
+
+  f = std::function<int(int)>([](int a) { return a * 3; });
+  EXPECT_TRUE(f);
+  EXPECT_EQ(f(2), 6);
+
+  f = null_fct;
+  EXPECT_FALSE(f);
+}
+
+TEST(inplace_function, copy_move) {
+  {
+    fst::inplace_function<int(int)> f = counted();
+    EXPECT_EQ(counted::count, 1);
+
+    fst::inplace_function<int(int)> copy = f;
+    EXPECT_EQ(counted::count, 2);
+    EXPECT_EQ(copy(4), 8);
+
+    fst::inplace_function<int(int)> moved = std::move(f);
+    EXPECT_EQ(counted::count, 2);
+    EXPECT_FALSE(f);
+    EXPECT_EQ(moved(5), 10);
+
+    moved = [](int a) { return a; };
+    EXPECT_EQ(counted::count, 1);
+    EXPECT_EQ(moved(5), 5);
+
+    copy.swap(moved);
+    EXPECT_EQ(copy(5), 5);
+    EXPECT_EQ(moved(5), 10);
+
+    moved = nullptr;
+    EXPECT_EQ(counted::count, 0);
+  }
+
+  EXPECT_EQ(counted::count, 0);
+}
+
+TEST(inplace_function, capacity) {
+  using function_type = fst::inplace_function<void(), 16>;
+  std::array<char, 16> small = {};
+  std::array<char, 17> large = {};
+  auto small_fct = [small]() { (void)small; };
+  auto large_fct = [large]() { (void)large; };
+
+  EXPECT_TRUE(function_type::can_store<decltype(small_fct)>);
+  EXPECT_FALSE(function_type::can_store<decltype(large_fct)>);
+  EXPECT_FALSE((std::is_convertible_v<std::unique_ptr<int>, function_type>));
+}
+} // namespace
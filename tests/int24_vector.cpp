@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include "fst/int24_vector.h"
+
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+std::vector<std::int32_t> make_samples(std::size_t count) {
+  std::mt19937 gen(24);
+  std::uniform_int_distribution<std::int32_t> dist(-8388608, 8388607);
+  std::vector<std::int32_t> samples(count);
+  for (std::int32_t& s : samples) {
+    s = dist(gen);
+  }
+
+  if (count > 2) {
+    samples[0] = -8388608;
+    samples[1] = 8388607;
+  }
+  return samples;
+}
+
+TEST(int24_vector, widen_narrow) {
+  // Odd sizes exercise the scalar tails.
+  for (std::size_t count : { 0, 1, 3, 4, 5, 8, 11, 16, 17, 100, 1001 }) {
+    std::vector<std::int32_t> samples = make_samples(count);
+
+    std::vector<fst::int24_t> reference(count);
+    for (std::size_t i = 0; i < count; i++) {
+      reference[i] = samples[i];
+    }
+
+    std::vector<std::uint8_t> packed(count * 3 + 1, 0xAB);
+    fst::int24_narrow(samples.data(), packed.data(), count);
+    EXPECT_EQ(std::memcmp(packed.data(), reference.data(), count * 3), 0);
+
+    // Must not write past the end.
+    EXPECT_EQ(packed.back(), 0xAB);
+
+    std::vector<std::int32_t> widened(count);
+    fst::int24_widen(packed.data(), widened.data(), count);
+    EXPECT_EQ(widened, samples);
+
+    std::vector<float> floats(count);
+    fst::int24_widen(packed.data(), floats.data(), count);
+
+    std::vector<std::uint8_t> packed_from_float(count * 3);
+    fst::int24_narrow(floats.data(), packed_from_float.data(), count);
+    EXPECT_EQ(std::memcmp(packed.data(), packed_from_float.data(), count * 3), 0);
+
+    for (std::size_t i = 0; i < count; i++) {
+      EXPECT_FLOAT_EQ(floats[i], (float)samples[i] / 8388608.0f);
+    }
+  }
+}
+
+TEST(int24_vector, saturate) {
+  const float values[] = { 2.0f, -2.0f, 1.0f, -1.0f, 0.5f };
+  fst::int24_vector vec(fst::span<const float>(values, 5));
+  ASSERT_EQ(vec.size(), 5);
+  EXPECT_EQ(vec[0], 8388607);
+  EXPECT_EQ(vec[1], -8388608);
+  EXPECT_EQ(vec[2], 8388607);
+  EXPECT_EQ(vec[3], -8388608);
+  EXPECT_EQ(vec[4], 4194304);
+}
+
+TEST(int24_vector, non_finite) {
+  // Same results from the simd kernels and from the scalar tail, whatever the position.
+  constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+  constexpr float inf = std::numeric_limits<float>::infinity();
+
+  for (std::size_t size = 3; size <= 40; size++) {
+    std::vector<float> values(size, 0.25f);
+    values[size - 3] = nan;
+    values[size - 2] = inf;
+    values[size - 1] = -inf;
+    values[0] = nan;
+
+    std::vector<std::uint8_t> packed(size * 3);
+    fst::int24_narrow(values.data(), packed.data(), size);
+    std::vector<std::int32_t> samples(size);
+    fst::int24_widen(packed.data(), samples.data(), size);
+
+    EXPECT_EQ(samples[0], 0);
+    EXPECT_EQ(samples[size - 3], 0);
+    EXPECT_EQ(samples[size - 2], 8388607);
+    EXPECT_EQ(samples[size - 1], -8388608);
+    for (std::size_t i = 1; i + 3 < size; i++) {
+      EXPECT_EQ(samples[i], 2097152);
+    }
+  }
+}
+
+TEST(int24_vector, elements) {
+  fst::int24_vector vec = { 1, -2, 3 };
+  EXPECT_EQ(vec.size(), 3);
+  EXPECT_EQ(vec.size_bytes(), 9);
+
+  vec[1] = -200;
+  vec[2] += 10;
+  vec.push_back(-8388608);
+  EXPECT_EQ(vec[0], 1);
+  EXPECT_EQ(vec[1], -200);
+  EXPECT_EQ(vec[2], 13);
+  EXPECT_EQ(vec[3], -8388608);
+
+  fst::int24_t i24 = vec[1];
+  EXPECT_EQ(i24, -200);
+
+  std::int32_t sum = 0;
+  for (std::int32_t v : static_cast<const fst::int24_vector&>(vec)) {
+    sum += v;
+  }
+  EXPECT_EQ(sum, 1 - 200 + 13 - 8388608);
+
+  fst::const_int24_span s = vec.span();
+  EXPECT_EQ(s.size(), 4);
+  EXPECT_EQ(s[2], 13);
+  EXPECT_EQ(s.end() - s.begin(), 4);
+
+  // Views over existing int24_t arrays.
+  fst::int24_t raw[2] = { 5, -6 };
+  fst::int24_span raw_span(raw, 2);
+  raw_span[0] = 7;
+  EXPECT_EQ(raw[0], 7);
+  EXPECT_EQ(raw_span[1], -6);
+}
+} // namespace
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include "fst/listener.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+struct test_listener {
+  std::atomic<int> value = 0;
+
+  void on_change(int v) { value += v; }
+};
+
+TEST(listener, add_remove) {
+  fst::listener_manager<test_listener> manager;
+  test_listener a;
+  test_listener b;
+  EXPECT_TRUE(manager.empty());
+
+  manager.add(&a);
+  manager.add(&b);
+  manager.add(&a);
+  EXPECT_EQ(manager.size(), 2);
+  EXPECT_TRUE(manager.contains(&a));
+
+  manager.notify(&test_listener::on_change, 2);
+  EXPECT_EQ(a.value, 2);
+  EXPECT_EQ(b.value, 2);
+
+  manager.remove(&a);
+  EXPECT_FALSE(manager.contains(&a));
+  manager.notify([](test_listener* l) { l->on_change(1); });
+  EXPECT_EQ(a.value, 2);
+  EXPECT_EQ(b.value, 3);
+
+  manager.remove(&b);
+  EXPECT_TRUE(manager.empty());
+  EXPECT_EQ(manager.size(), 0);
+  manager.notify(&test_listener::on_change, 1);
+  EXPECT_EQ(b.value, 3);
+}
+
+TEST(listener, remove_while_notifying) {
+  fst::listener_manager<test_listener> manager;
+  test_listener a;
+  test_listener b;
+  manager.add(&a);
+  manager.add(&b);
+
+  // The snapshot being iterated isn't changed.
+  int count = 0;
+  manager.notify([&](test_listener* l) {
+    manager.remove(&a);
+    manager.remove(&b);
+    l->on_change(1);
+    count++;
+  });
+
+  EXPECT_EQ(count, 2);
+  EXPECT_TRUE(manager.empty());
+
+  auto snapshot = manager.get();
+  manager.add(&a);
+  EXPECT_TRUE(snapshot.empty());
+  EXPECT_EQ(manager.get().size(), 1);
+}
+
+TEST(listener, threads) {
+  fst::listener_manager<test_listener> manager;
+  std::vector<test_listener> listeners(8);
+  manager.add(&listeners[0]);
+
+  std::atomic<bool> is_running = true;
+  std::vector<std::thread> notifiers;
+  for (int i = 0; i < 3; i++) {
+    notifiers.emplace_back([&]() {
+      while (is_running) {
+        manager.notify(&test_listener::on_change, 1);
+      }
+    });
+  }
+
+  for (int i = 0; i < 2000; i++) {
+    test_listener* l = &listeners[1 + i % 7];
+    manager.add(l);
+    manager.remove(l);
+  }
+
+  // The writes can be done before any notifier got to run.
+  const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (listeners[0].value == 0 && std::chrono::steady_clock::now() < end) {
+    std::this_thread::yield();
+  }
+
+  is_running = false;
+  for (std::thread& t : notifiers) {
+    t.join();
+  }
+
+  EXPECT_EQ(manager.size(), 1);
+  EXPECT_GT(listeners[0].value, 0);
+}
+
+TEST(listener, held_snapshot) {
+  constexpr std::size_t notifier_count = 3;
+  fst::listener_manager<test_listener> manager;
+  std::vector<test_listener> listeners(8);
+  manager.add(&listeners[0]);
+
+  // Only the generation read by a snapshot is kept, not every list replaced while it's held.
+  auto snapshot = manager.get();
+
+  std::atomic<bool> is_running = true;
+  std::vector<std::thread> notifiers;
+  for (std::size_t i = 0; i < notifier_count; i++) {
+    notifiers.emplace_back([&]() {
+      while (is_running) {
+        manager.notify(&test_listener::on_change, 1);
+      }
+    });
+  }
+
+  for (int i = 0; i < 2000; i++) {
+    test_listener* l = &listeners[1 + i % 7];
+    manager.add(l);
+    manager.remove(l);
+    EXPECT_LE(manager.retired_count(), notifier_count + 1);
+  }
+
+  is_running = false;
+  for (std::thread& t : notifiers) {
+    t.join();
+  }
+
+  // The lists the notifiers were reading when they stopped are freed by the next write.
+  manager.add(&listeners[1]);
+  manager.remove(&listeners[1]);
+  ASSERT_EQ(snapshot.size(), 1);
+  EXPECT_EQ(snapshot[0], &listeners[0]);
+  EXPECT_EQ(manager.retired_count(), 1);
+
+  // Freed by the next write once the snapshot is gone.
+  { auto released = std::move(snapshot); }
+  manager.add(&listeners[1]);
+  EXPECT_EQ(manager.retired_count(), 0);
+}
+} // namespace
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include "fst/listener_dispatcher.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+using namespace std::chrono_literals;
+
+struct parameter_listener {
+  using dispatcher_type = fst::coalescing_listener_dispatcher<parameter_listener, int, float>;
+
+  std::mutex mutex;
+  std::vector<std::vector<dispatcher_type::value_type>> batches;
+  std::atomic<int> batch_count = 0;
+
+  void on_parameters(dispatcher_type::batch_type batch) {
+    std::lock_guard<std::mutex> lock(mutex);
+    batches.emplace_back(batch.begin(), batch.end());
+    batch_count++;
+  }
+};
+
+using dispatcher_type = parameter_listener::dispatcher_type;
+using batch_vector = std::vector<dispatcher_type::value_type>;
+
+TEST(listener_dispatcher, coalesce) {
+  fst::listener_manager<parameter_listener> listeners;
+  parameter_listener a;
+  parameter_listener b;
+  listeners.add(&a);
+  listeners.add(&b);
+
+  dispatcher_type dispatcher(listeners, &parameter_listener::on_parameters);
+  dispatcher.flush();
+  EXPECT_TRUE(a.batches.empty());
+
+  for (int i = 0; i < 5; i++) {
+    dispatcher.post(1, (float)i);
+  }
+  dispatcher.post(2, 10.0f);
+  dispatcher.post(1, 5.0f);
+  dispatcher.flush();
+
+  // One call per listener, the last value of each key in order of first post.
+  ASSERT_EQ(a.batches.size(), 1);
+  EXPECT_EQ(a.batches[0], batch_vector({ { 1, 5.0f }, { 2, 10.0f } }));
+  EXPECT_EQ(b.batches, a.batches);
+
+  dispatcher.post(2, 3.0f);
+  dispatcher.flush();
+  ASSERT_EQ(a.batches.size(), 2);
+  EXPECT_EQ(a.batches[1], batch_vector({ { 2, 3.0f } }));
+}
+
+TEST(listener_dispatcher, event_manager) {
+  fst::listener_manager<parameter_listener> listeners;
+  parameter_listener a;
+  listeners.add(&a);
+
+  // Last value received for each key.
+  auto last_values = [&a]() {
+    std::lock_guard<std::mutex> lock(a.mutex);
+    std::vector<float> last(4, -1.0f);
+    for (const batch_vector& batch : a.batches) {
+      EXPECT_LE(batch.size(), 4);
+      for (const auto& n : batch) {
+        last[n.first] = n.second;
+      }
+    }
+    return last;
+  };
+
+  fst::event_manager em;
+  em.init(1);
+
+  dispatcher_type dispatcher(listeners, &parameter_listener::on_parameters);
+  dispatcher.connect(em);
+
+  std::thread producer([&]() {
+    for (int i = 0; i < 1000; i++) {
+      dispatcher.post(i % 4, (float)i);
+    }
+  });
+  producer.join();
+
+  const std::vector<float> expected = { 996.0f, 997.0f, 998.0f, 999.0f };
+  const auto end = std::chrono::steady_clock::now() + 2s;
+  while (last_values() != expected && std::chrono::steady_clock::now() < end) {
+    std::this_thread::sleep_for(1ms);
+  }
+
+  EXPECT_EQ(last_values(), expected);
+  dispatcher.disconnect();
+}
+} // namespace
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include "fst/memory_resource.h"
+#include "fst/byte_vector.h"
+#include "fst/small_vector.h"
+#include "fst/unordered_set.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+inline bool is_aligned(const void* ptr, std::uintptr_t alignment) noexcept {
+  return (reinterpret_cast<std::uintptr_t>(ptr) % alignment) == 0;
+}
+
+TEST(memory_resource, monotonic_arena) {
+  for (auto backing : { fst::monotonic_arena::backing::upstream, fst::monotonic_arena::backing::mmap }) {
+    fst::monotonic_arena arena(1024, backing);
+    EXPECT_EQ(arena.block_count(), 0);
+
+    void* a = arena.allocate(10, 1);
+    void* b = arena.allocate(16, 16);
+    EXPECT_TRUE(is_aligned(b, 16));
+    EXPECT_GE(static_cast<char*>(b), static_cast<char*>(a) + 10);
+    EXPECT_EQ(arena.block_count(), 1);
+
+    // Larger than a block.
+    void* c = arena.allocate(10000, 64);
+    EXPECT_TRUE(is_aligned(c, 64));
+    EXPECT_EQ(arena.block_count(), 2);
+
+    // Blocks are kept and reused after a reset.
+    arena.reset();
+    EXPECT_EQ(arena.allocate(10, 1), a);
+    EXPECT_NE(arena.allocate(10000, 64), nullptr);
+    EXPECT_EQ(arena.block_count(), 2);
+
+    arena.release();
+    EXPECT_EQ(arena.block_count(), 0);
+  }
+}
+
+TEST(memory_resource, pool_allocator) {
+  fst::pool_allocator pool(24, 4);
+  EXPECT_EQ(pool.chunk_size() % alignof(std::max_align_t), 0);
+
+  std::vector<void*> chunks;
+  for (int i = 0; i < 10; i++) {
+    chunks.push_back(pool.allocate(24));
+  }
+
+  // Freed chunks are reused first.
+  void* last = chunks.back();
+  pool.deallocate(last, 24);
+  EXPECT_EQ(pool.allocate(24), last);
+
+  // Larger allocations go upstream.
+  void* big = pool.allocate(1000);
+  pool.deallocate(big, 1000);
+
+  for (void* c : chunks) {
+    pool.deallocate(c, 24);
+  }
+}
+
+TEST(memory_resource, containers) {
+  fst::monotonic_arena arena(4096);
+
+  fst::pmr_byte_vector bv(&arena);
+  bv.push_back(std::int32_t(32));
+  EXPECT_EQ(bv.as<std::int32_t>(0), 32);
+
+  fst::pmr_small_vector<int, 2> sv(&arena);
+  for (int i = 0; i < 100; i++) {
+    sv.push_back(i);
+  }
+  EXPECT_FALSE(sv.is_inline());
+  EXPECT_EQ(sv.get_allocator().resource(), &arena);
+
+  // Moving to a vector using another resource moves the elements.
+  fst::pmr_small_vector<int, 2> other;
+  other = std::move(sv);
+  EXPECT_EQ(other.size(), 100);
+  EXPECT_EQ(other[99], 99);
+  EXPECT_NE(other.get_allocator().resource(), &arena);
+
+  fst::pmr_unordered_set<int> set(1000, &arena);
+  set.insert(10);
+  set.insert(999);
+  EXPECT_EQ(set.size(), 2);
+  EXPECT_TRUE(set.contains(999));
+  EXPECT_EQ(set.bits().get_allocator().resource(), &arena);
+  EXPECT_GT(arena.block_count(), 0);
+}
+} // namespace
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include "fst/mpsc_queue.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+TEST(mpsc_queue, bounded) {
+  fst::bounded_mpsc_queue<std::string> queue(5);
+  EXPECT_EQ(queue.capacity(), 8);
+  EXPECT_TRUE(queue.empty());
+
+  for (int i = 0; i < 8; i++) {
+    EXPECT_TRUE(queue.try_push(std::to_string(i)));
+  }
+
+  EXPECT_FALSE(queue.try_push("full"));
+  EXPECT_FALSE(queue.empty());
+
+  std::string value;
+  for (int i = 0; i < 8; i++) {
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(value, std::to_string(i));
+  }
+
+  EXPECT_FALSE(queue.try_pop(value));
+  EXPECT_TRUE(queue.empty());
+
+  // Wraps around and destroys what's left.
+  EXPECT_TRUE(queue.try_emplace(3, 'a'));
+  EXPECT_TRUE(queue.try_pop(value));
+  EXPECT_EQ(value, "aaa");
+  EXPECT_TRUE(queue.try_push("left"));
+}
+
+TEST(mpsc_queue, unbounded) {
+  fst::mpsc_queue<std::unique_ptr<int>> queue(4);
+  queue.reserve(10);
+  EXPECT_TRUE(queue.empty());
+
+  for (int i = 0; i < 100; i++) {
+    queue.push(std::make_unique<int>(i));
+  }
+
+  std::unique_ptr<int> value;
+  for (int i = 0; i < 50; i++) {
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(*value, i);
+  }
+
+  // Recycled nodes.
+  queue.emplace(new int(100));
+  for (int i = 50; i <= 100; i++) {
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(*value, i);
+  }
+
+  EXPECT_FALSE(queue.try_pop(value));
+  EXPECT_TRUE(queue.empty());
+  queue.push(std::make_unique<int>(0));
+}
+
+template <typename _Queue, typename _Push>
+void multiple_producers(_Queue& queue, _Push&& push) {
+  constexpr int producer_count = 4;
+  constexpr int count = 10000;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < producer_count; p++) {
+    producers.emplace_back([&, p]() {
+      for (int i = 0; i < count; i++) {
+        push(queue, p * count + i);
+      }
+    });
+  }
+
+  // Each producer's values come out in order.
+  std::vector<int> last(producer_count, -1);
+  int value;
+  for (int received = 0; received < producer_count * count;) {
+    if (!queue.try_pop(value)) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    const int p = value / count;
+    EXPECT_GT(value % count, last[p]);
+    last[p] = value % count;
+    received++;
+  }
+
+  for (std::thread& t : producers) {
+    t.join();
+  }
+
+  EXPECT_FALSE(queue.try_pop(value));
+}
+
+TEST(mpsc_queue, bounded_multiple_producers) {
+  fst::bounded_mpsc_queue<int> queue(64);
+  multiple_producers(queue, [](auto& q, int value) {
+    while (!q.try_push(value)) {
+      std::this_thread::yield();
+    }
+  });
+}
+
+TEST(mpsc_queue, unbounded_multiple_producers) {
+  fst::mpsc_queue<int> queue;
+  multiple_producers(queue, [](auto& q, int value) { q.push(value); });
+}
+} // namespace
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include "fst/riff.h"
+#include "fst/byte_vector.h"
+
+namespace {
+fst::byte_vector make_wave(std::uint16_t channel_count, std::uint16_t bits_per_sample, const std::vector<float>& samples) {
+  using convert_options = fst::byte_vector::convert_options;
+
+  fst::byte_vector data;
+  for (float s : samples) {
+    switch (bits_per_sample) {
+    case 16:
+      data.push_back<float, convert_options::pcm_16_bit>(s);
+      break;
+    case 24:
+      data.push_back<float, convert_options::pcm_24_bit>(s);
+      break;
+    }
+  }
+
+  const std::uint16_t block_align = channel_count * bits_per_sample / 8;
+
+  fst::byte_vector bv;
+  bv.push_back("RIFF");
+  bv.push_back(std::uint32_t(0));
+  bv.push_back("WAVE");
+
+  bv.push_back("fmt ");
+  bv.push_back(std::uint32_t(16));
+  bv.push_back(std::uint16_t(1));
+  bv.push_back(channel_count);
+  bv.push_back(std::uint32_t(44100));
+  bv.push_back(std::uint32_t(44100 * block_align));
+  bv.push_back(block_align);
+  bv.push_back(bits_per_sample);
+
+  // Odd sized chunk with its pad byte.
+  bv.push_back("LIST");
+  bv.push_back(std::uint32_t(5));
+  bv.push_back("INFOa");
+  bv.push_back(std::uint8_t(0));
+
+  bv.push_back("data");
+  bv.push_back(std::uint32_t(data.size()));
+  bv.push_back(data);
+
+  bv.as_ref<std::uint32_t>(4) = std::uint32_t(bv.size() - 8);
+  return bv;
+}
+
+TEST(riff, index) {
+  fst::byte_vector bv = make_wave(2, 16, { 0.5f, -0.5f, 0.25f, -0.25f });
+  fst::riff_index index((fst::byte_view(bv)));
+
+  ASSERT_TRUE(index.is_valid());
+  EXPECT_EQ(index.form_type(), fst::make_four_cc("WAVE"));
+  ASSERT_EQ(index.size(), 3);
+  EXPECT_EQ(index.chunks()[0].name(), "fmt ");
+  EXPECT_EQ(index.chunks()[1].name(), "LIST");
+  EXPECT_EQ(index.chunks()[1].size, 5);
+  EXPECT_EQ(index.chunks()[2].name(), "data");
+  EXPECT_EQ(index.chunks()[2].offset, 12 + 8 + 16 + 8 + 6 + 8);
+  EXPECT_EQ(index.content(fst::make_four_cc("data")).size(), 8);
+  EXPECT_EQ(index.find(fst::make_four_cc("cue ")), nullptr);
+
+  fst::riff_index invalid((fst::byte_view(bv).subspan(4)));
+  EXPECT_FALSE(invalid.is_valid());
+  EXPECT_TRUE(invalid.empty());
+}
+
+TEST(riff, wave_file) {
+  fst::byte_vector bv = make_wave(2, 24, { 0.5f, -0.5f, 0.25f, -0.25f });
+  fst::wave_file file((fst::byte_view(bv)));
+
+  ASSERT_TRUE(file.is_valid());
+  EXPECT_EQ(file.get_format().channel_count, 2);
+  EXPECT_EQ(file.get_format().sample_rate, 44100);
+  EXPECT_EQ(file.get_format().bits_per_sample, 24);
+  EXPECT_EQ(file.frame_count(), 2);
+
+  fst::verified_value<fst::wave_file::convert_options> opts = file.pcm_convert_options();
+  ASSERT_TRUE(opts.is_valid());
+  EXPECT_EQ(opts.get(), fst::wave_file::convert_options::pcm_24_bit);
+
+  fst::byte_view samples = file.samples();
+  EXPECT_FLOAT_EQ((samples.as<float, fst::byte_view::convert_options::pcm_24_bit>(0)), 0.5f);
+  EXPECT_FLOAT_EQ((samples.as<float, fst::byte_view::convert_options::pcm_24_bit>(3)), -0.5f);
+  EXPECT_FLOAT_EQ((samples.as<float, fst::byte_view::convert_options::pcm_24_bit>(9)), -0.25f);
+}
+
+TEST(riff, truncated) {
+  fst::byte_vector bv = make_wave(1, 16, { 0.5f, -0.5f, 0.25f, -0.25f });
+  bv.resize(bv.size() - 2);
+
+  fst::wave_file file((fst::byte_view(bv)));
+  ASSERT_TRUE(file.is_valid());
+  EXPECT_EQ(file.frame_count(), 3);
+}
+} // namespace
@@ -318,4 +318,67 @@ TEST(small_string, transform) {
     EXPECT_EQ(s, "abc12");
   }
 }
+
+TEST(small_string, packed_layout) {
+  static_assert(sizeof(fst::small_string<15>) == 16, "Packed layout");
+  static_assert(sizeof(fst::small_string<255>) == 256, "Packed layout");
+  static_assert(!fst::small_string<256>::is_packed, "Size doesn't fit in the last char");
+
+  {
+    fst::small_string<15> s;
+    EXPECT_TRUE(s.empty());
+    EXPECT_EQ(s.data()[0], 0);
+
+    for (std::size_t i = 0; i < 15; i++) {
+      s.push_back((char)('a' + i));
+      EXPECT_EQ(s.size(), i + 1);
+      EXPECT_EQ(s.data()[i + 1], 0);
+    }
+
+    EXPECT_EQ(s, "abcdefghijklmno");
+    s.pop_back();
+    EXPECT_EQ(s.size(), 14);
+    EXPECT_EQ(s, "abcdefghijklmn");
+  }
+
+  {
+    fst::small_string<255> s(255, 'x');
+    EXPECT_EQ(s.size(), 255);
+    EXPECT_EQ(s.data()[255], 0);
+
+    fst::small_string<255> c = s;
+    EXPECT_EQ(c, s);
+    c.resize(20);
+    fst::small_string<255> d;
+    d = c;
+    EXPECT_EQ(d.size(), 20);
+    EXPECT_EQ(d.to_view(), std::string(20, 'x'));
+
+    fst::small_string<255> m = std::move(d);
+    EXPECT_EQ(m.size(), 20);
+    EXPECT_TRUE(d.empty());
+  }
+
+  {
+    fst::small_string<300> s(300, 'y');
+    EXPECT_EQ(s.size(), 300);
+    s.resize(2);
+    EXPECT_EQ(s, "yy");
+  }
+}
+
+TEST(small_string, compare) {
+  using string_type = fst::small_string<64>;
+  const char* words[] = { "", "a", "ab", "abc", "abcdefgh", "abcdefgi", "abcdefghijklmnop", "abcdefghijklmnoq",
+    "abcdefghijklmnopq", "b", "\xff", "abcdefg\xff" };
+
+  for (const char* a : words) {
+    for (const char* b : words) {
+      const int expected = std::string_view(a).compare(b);
+      EXPECT_EQ(string_type(a) == string_type(b), expected == 0) << a << " " << b;
+      EXPECT_EQ(string_type(a) < string_type(b), expected < 0) << a << " " << b;
+      EXPECT_EQ(string_type(a) > string_type(b), expected > 0) << a << " " << b;
+    }
+  }
+}
 } // namespace
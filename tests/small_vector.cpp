@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include "fst/small_vector.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+using int_vector = fst::small_vector<int, 4>;
+
+TEST(small_vector, trivial) {
+  int_vector a;
+  EXPECT_TRUE(a.is_inline());
+  EXPECT_EQ(a.capacity(), 4);
+
+  for (int i = 0; i < 4; i++) {
+    a.push_back(i);
+  }
+  EXPECT_TRUE(a.is_inline());
+
+  a.push_back(4);
+  EXPECT_FALSE(a.is_inline());
+  EXPECT_EQ(a.size(), 5);
+  EXPECT_EQ(a.capacity(), 8);
+
+  // Pushing a reference to an element while growing.
+  for (int i = 0; i < 100; i++) {
+    a.push_back(a[0]);
+  }
+  EXPECT_EQ(a.size(), 105);
+  EXPECT_EQ(a.back(), 0);
+
+  a.erase(a.begin() + 5, a.end());
+  EXPECT_EQ(a, int_vector({ 0, 1, 2, 3, 4 }));
+
+  a.insert(a.begin() + 1, { 10, 11 });
+  a.insert(a.begin(), 2, a[6]);
+  a.insert(a.end(), 12);
+  EXPECT_EQ(a, int_vector({ 4, 4, 0, 10, 11, 1, 2, 3, 4, 12 }));
+
+  a.resize(3);
+  a.shrink_to_fit();
+  EXPECT_TRUE(a.is_inline());
+  EXPECT_EQ(a, int_vector({ 4, 4, 0 }));
+
+  int_vector b(std::move(a));
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(b.size(), 3);
+
+  b.resize(10, 7);
+  int_vector c;
+  c = b;
+  EXPECT_EQ(c, b);
+  EXPECT_EQ(c[9], 7);
+
+  c = std::move(b);
+  EXPECT_TRUE(b.empty());
+  EXPECT_TRUE(b.is_inline());
+  EXPECT_EQ(c.size(), 10);
+}
+
+TEST(small_vector, non_trivial) {
+  using vector_type = fst::small_vector<std::string, 2>;
+  std::vector<std::string> ref;
+  vector_type a;
+
+  for (int i = 0; i < 20; i++) {
+    const std::string s = "a long string that does not fit in sso " + std::to_string(i);
+    a.push_back(s);
+    ref.push_back(s);
+  }
+  EXPECT_EQ(std::vector<std::string>(a.begin(), a.end()), ref);
+
+  a.insert(a.begin() + 3, a[10]);
+  ref.insert(ref.begin() + 3, ref[10]);
+  a.emplace(a.begin(), "front");
+  ref.emplace(ref.begin(), "front");
+  a.erase(a.begin() + 5, a.begin() + 8);
+  ref.erase(ref.begin() + 5, ref.begin() + 8);
+  const std::vector<std::string> head(ref.begin(), ref.begin() + 3);
+  a.insert(a.begin() + 2, head.begin(), head.end());
+  ref.insert(ref.begin() + 2, head.begin(), head.end());
+  EXPECT_EQ(std::vector<std::string>(a.begin(), a.end()), ref);
+
+  vector_type b = a;
+  vector_type c = std::move(a);
+  EXPECT_EQ(b, c);
+  EXPECT_TRUE(a.empty());
+
+  c.resize(1);
+  c.shrink_to_fit();
+  EXPECT_TRUE(c.is_inline());
+  EXPECT_EQ(c[0], "front");
+
+  vector_type d(std::move(c));
+  EXPECT_EQ(d.size(), 1);
+  EXPECT_EQ(d[0], "front");
+}
+
+TEST(small_vector, move_only) {
+  fst::small_vector<std::unique_ptr<int>, 2> a;
+  for (int i = 0; i < 10; i++) {
+    a.emplace_back(std::make_unique<int>(i));
+  }
+
+  a.erase(a.begin());
+  EXPECT_EQ(a.size(), 9);
+  EXPECT_EQ(*a.front(), 1);
+  EXPECT_EQ(*a.back(), 9);
+
+  a.pop_back();
+  EXPECT_EQ(*a.back(), 8);
+}
+} // namespace
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include "fst/soa_vector.h"
+
+#include <cstdint>
+
+namespace {
+TEST(soa_vector, constructor) {
+  fst::soa_vector<float, double, int> v;
+  EXPECT_TRUE(v.empty());
+
+  for (int i = 0; i < 100; i++) {
+    v.push_back((float)i, i * 2.0, i * 3);
+  }
+  EXPECT_EQ(v.size(), 100);
+
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(v.data<0>()) % decltype(v)::column_alignment, 0);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(v.data<1>()) % decltype(v)::column_alignment, 0);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(v.data<2>()) % decltype(v)::column_alignment, 0);
+
+  auto [x, y, z] = v[10];
+  EXPECT_EQ(x, 10.0f);
+  EXPECT_EQ(y, 20.0);
+  EXPECT_EQ(z, 30);
+
+  // Rows are references into the columns.
+  z = 5;
+  EXPECT_EQ(v.get<2>(10), 5);
+
+  for (float& f : v.column<0>()) {
+    f *= 2.0f;
+  }
+  EXPECT_EQ(v.get<0>(99), 198.0f);
+
+  // Pushing a reference to a row while growing.
+  v.resize(128);
+  EXPECT_EQ(v.get<1>(127), 0.0);
+  v.push_back(v.get<0>(1), v.get<1>(1), v.get<2>(1));
+  EXPECT_EQ(v.back(), std::make_tuple(2.0f, 2.0, 3));
+}
+
+TEST(soa_vector, erase) {
+  fst::soa_vector<int, char> v;
+  for (int i = 0; i < 10; i++) {
+    v.push_back(std::make_tuple(i, (char)('a' + i)));
+  }
+
+  v.erase(0);
+  EXPECT_EQ(v.size(), 9);
+  EXPECT_EQ(v.front(), std::make_tuple(1, 'b'));
+
+  v.swap_erase(0);
+  EXPECT_EQ(v.size(), 8);
+  EXPECT_EQ(v.front(), std::make_tuple(9, 'j'));
+  EXPECT_EQ(v.back(), std::make_tuple(8, 'i'));
+
+  fst::soa_vector<int, char> c = v;
+  fst::soa_vector<int, char> m = std::move(v);
+  EXPECT_TRUE(v.empty());
+  EXPECT_EQ(c.size(), m.size());
+  for (std::size_t i = 0; i < c.size(); i++) {
+    EXPECT_EQ(c[i], m[i]);
+  }
+
+  v = c;
+  EXPECT_EQ(v.size(), 8);
+  v.pop_back();
+  EXPECT_EQ(v.back(), std::make_tuple(7, 'h'));
+}
+} // namespace
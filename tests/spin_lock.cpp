@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+
+#include "fst/spin_lock.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+// Gives the waiters of a held mutex time to run out of spin budget and park.
+void wait_for_park(const fst::spin_lock_mutex& mutex) {
+#if FST_SPIN_LOCK_STATS
+  const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (mutex.stats().parks == 0 && std::chrono::steady_clock::now() < end) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+#else
+  (void)mutex;
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+#endif
+}
+
+TEST(spin_lock, try_lock) {
+  fst::spin_lock_mutex mutex;
+  EXPECT_TRUE(mutex.try_lock());
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock();
+
+  {
+    fst::scoped_spin_lock lock(mutex);
+    EXPECT_FALSE(mutex.try_lock());
+  }
+
+  EXPECT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST(spin_lock, contention) {
+  constexpr std::size_t thread_count = 8;
+  constexpr std::size_t iterations = 20000;
+
+  fst::spin_lock_mutex mutex;
+  std::size_t counter = 0;
+
+  // Held while the threads start so that they spin even on a single core.
+  mutex.lock();
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < thread_count; i++) {
+    threads.emplace_back([&]() {
+      for (std::size_t j = 0; j < iterations; j++) {
+        std::lock_guard<fst::spin_lock_mutex> lock(mutex);
+        counter++;
+      }
+    });
+  }
+
+  wait_for_park(mutex);
+  mutex.unlock();
+
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, thread_count * iterations);
+
+#if FST_SPIN_LOCK_STATS
+  EXPECT_EQ(mutex.stats().acquisitions, thread_count * iterations + 1);
+  EXPECT_GT(mutex.stats().spins, 0);
+#else
+  EXPECT_EQ(mutex.stats().acquisitions, 0);
+#endif
+}
+
+TEST(spin_lock, long_hold) {
+  // Waiters run out of spin budget and park.
+  fst::spin_lock_mutex mutex;
+  std::atomic<int> value = 0;
+  mutex.lock();
+
+  std::thread t([&]() {
+    fst::scoped_spin_lock lock(mutex);
+    value = 2;
+  });
+
+  wait_for_park(mutex);
+  value = 1;
+  mutex.unlock();
+  t.join();
+  EXPECT_EQ(value, 2);
+
+#if FST_SPIN_LOCK_STATS
+  EXPECT_GT(mutex.stats().parks, 0);
+  EXPECT_GE(mutex.stats().spins, fst::spin_lock_detail::backoff::spin_budget);
+#endif
+}
+
+TEST(spin_lock, ticket) {
+  // A fair lock hands over to one given thread, keeps this short on loaded machines.
+  constexpr std::size_t thread_count = 4;
+  constexpr std::size_t iterations = 5000;
+
+  fst::ticket_spin_lock mutex;
+  EXPECT_TRUE(mutex.try_lock());
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock();
+
+  std::size_t counter = 0;
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < thread_count; i++) {
+    threads.emplace_back([&]() {
+      for (std::size_t j = 0; j < iterations; j++) {
+        std::lock_guard<fst::ticket_spin_lock> lock(mutex);
+        counter++;
+      }
+    });
+  }
+
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, thread_count * iterations);
+}
+
+TEST(spin_lock, rw_try_lock) {
+  fst::rw_spin_lock mutex;
+  EXPECT_TRUE(mutex.try_lock_shared());
+  EXPECT_TRUE(mutex.try_lock_shared());
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock_shared();
+  mutex.unlock_shared();
+
+  {
+    fst::scoped_unique_spin_lock lock(mutex);
+    EXPECT_FALSE(mutex.try_lock_shared());
+    EXPECT_FALSE(mutex.try_lock());
+  }
+
+  {
+    fst::scoped_shared_spin_lock lock(mutex);
+    EXPECT_TRUE(mutex.try_lock_shared());
+    mutex.unlock_shared();
+  }
+
+  EXPECT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST(spin_lock, rw_writer_priority) {
+  fst::rw_spin_lock mutex;
+  mutex.lock_shared();
+
+  std::atomic<bool> is_written = false;
+  std::thread writer([&]() {
+    fst::scoped_unique_spin_lock lock(mutex);
+    is_written = true;
+  });
+
+  // Once the writer waits, new readers are turned away.
+  while (mutex.try_lock_shared()) {
+    mutex.unlock_shared();
+    std::this_thread::yield();
+  }
+
+  EXPECT_FALSE(is_written);
+  mutex.unlock_shared();
+  writer.join();
+  EXPECT_TRUE(is_written);
+}
+
+TEST(spin_lock, rw_contention) {
+  constexpr std::size_t iterations = 20000;
+
+  fst::rw_spin_lock mutex;
+  std::size_t a = 0;
+  std::size_t b = 0;
+  std::atomic<bool> is_consistent = true;
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < 2; i++) {
+    threads.emplace_back([&]() {
+      for (std::size_t j = 0; j < iterations; j++) {
+        fst::scoped_unique_spin_lock lock(mutex);
+        a++;
+        b++;
+      }
+    });
+  }
+
+  for (std::size_t i = 0; i < 4; i++) {
+    threads.emplace_back([&]() {
+      for (std::size_t j = 0; j < iterations; j++) {
+        fst::scoped_shared_spin_lock lock(mutex);
+        if (a != b) {
+          is_consistent = false;
+        }
+      }
+    });
+  }
+
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  EXPECT_TRUE(is_consistent);
+  EXPECT_EQ(a, 2 * iterations);
+}
+} // namespace
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include "fst/spsc_ring_buffer.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace {
+TEST(spsc_ring_buffer, push_pop) {
+  fst::spsc_ring_buffer<int, 8> ring;
+  EXPECT_EQ(ring.capacity(), 8);
+  EXPECT_EQ(ring.write_available(), 8);
+  EXPECT_EQ(ring.read_available(), 0);
+
+  for (int i = 0; i < 8; i++) {
+    EXPECT_TRUE(ring.push(i));
+  }
+
+  EXPECT_FALSE(ring.push(8));
+  EXPECT_EQ(ring.read_available(), 8);
+
+  int value;
+  for (int i = 0; i < 8; i++) {
+    EXPECT_TRUE(ring.pop(value));
+    EXPECT_EQ(value, i);
+  }
+
+  EXPECT_FALSE(ring.pop(value));
+}
+
+TEST(spsc_ring_buffer, batch) {
+  fst::spsc_ring_buffer<float, 8> ring;
+  const std::vector<float> input = { 0, 1, 2, 3, 4, 5 };
+  std::vector<float> output(6);
+
+  EXPECT_EQ(ring.push(fst::span<const float>(input.data(), 6)), 6);
+  EXPECT_EQ(ring.pop(fst::span<float>(output.data(), 4)), 4);
+
+  // Wraps around and only takes what fits.
+  EXPECT_EQ(ring.push(fst::span<const float>(input.data(), 6)), 6);
+  EXPECT_EQ(ring.push(fst::span<const float>(input.data(), 6)), 0);
+
+  EXPECT_EQ(ring.pop(fst::span<float>(output.data(), 6)), 6);
+  EXPECT_EQ(output, std::vector<float>({ 4, 5, 0, 1, 2, 3 }));
+  EXPECT_EQ(ring.read_available(), 2);
+}
+
+TEST(spsc_ring_buffer, regions) {
+  fst::spsc_ring_buffer<int, 8> ring;
+
+  auto w = ring.write_region(6);
+  EXPECT_EQ(w.first.size(), 6);
+  EXPECT_TRUE(w.second.empty());
+  for (int i = 0; i < 6; i++) {
+    w.first[i] = i;
+  }
+  ring.commit_write(6);
+
+  auto r = ring.read_region(5);
+  EXPECT_EQ(r.size(), 5);
+  EXPECT_EQ(r.first[4], 4);
+  ring.commit_read(5);
+
+  // 2 slots at the end and 5 at the beginning.
+  w = ring.write_region(10);
+  EXPECT_EQ(w.first.size(), 2);
+  EXPECT_EQ(w.second.size(), 5);
+  w.first[0] = 6;
+  w.first[1] = 7;
+  w.second[0] = 8;
+  ring.commit_write(3);
+
+  r = ring.read_region(10);
+  EXPECT_EQ(r.first.size(), 3);
+  EXPECT_EQ(r.second.size(), 1);
+  EXPECT_EQ(r.first[0], 5);
+  EXPECT_EQ(r.second[0], 8);
+  ring.commit_read(r.size());
+  EXPECT_EQ(ring.read_available(), 0);
+}
+
+TEST(spsc_ring_buffer, threads) {
+  constexpr int count = 100000;
+  fst::spsc_ring_buffer<int, 64> ring;
+
+  std::thread producer([&]() {
+    int block[16];
+    for (int i = 0; i < count;) {
+      const int block_size = std::min(16, count - i);
+      for (int j = 0; j < block_size; j++) {
+        block[j] = i + j;
+      }
+
+      const std::size_t pushed = ring.push(fst::span<const int>(block, block_size));
+      i += (int)pushed;
+      if (!pushed) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  bool is_ordered = true;
+  for (int expected = 0; expected < count;) {
+    auto r = ring.read_region(32);
+    if (r.empty()) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    for (int v : r.first) {
+      is_ordered &= v == expected++;
+    }
+    for (int v : r.second) {
+      is_ordered &= v == expected++;
+    }
+    ring.commit_read(r.size());
+  }
+
+  producer.join();
+  EXPECT_TRUE(is_ordered);
+}
+} // namespace
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include "fst/string_pool.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+TEST(string_pool, intern) {
+  fst::string_pool pool;
+  EXPECT_TRUE(pool.empty());
+
+  fst::string_pool::handle a = pool.intern("alpha");
+  fst::string_pool::handle b = pool.intern("beta");
+  fst::string_pool::handle e = pool.intern("");
+  EXPECT_NE(a, b);
+  EXPECT_EQ(a, pool.intern(std::string("alpha")));
+  EXPECT_EQ(e, pool.intern(""));
+  EXPECT_EQ(pool.size(), 3);
+
+  EXPECT_EQ(pool.view(a), "alpha");
+  EXPECT_EQ(pool.view(b), "beta");
+  EXPECT_EQ(pool.view(e), "");
+  EXPECT_STREQ(pool.c_str(a), "alpha");
+
+  EXPECT_EQ(pool.find("beta"), b);
+  EXPECT_EQ(pool.find("gamma"), fst::string_pool::invalid_handle);
+  EXPECT_FALSE(pool.contains("gamma"));
+
+  // Larger than a page.
+  std::string big(fst::string_pool::page_size * 2, 'x');
+  fst::string_pool::handle h = pool.intern(big);
+  EXPECT_EQ(pool.view(h), big);
+  EXPECT_EQ(pool.view(pool.intern("after_big")), "after_big");
+  EXPECT_EQ(pool.view(a), "alpha");
+}
+
+TEST(string_pool, memory) {
+  // Small pools stay small, the pages start small and the page table grows as needed.
+  fst::string_pool pool;
+  EXPECT_LT(sizeof(fst::string_pool), 8 * 1024);
+
+  for (int i = 0; i < 16; i++) {
+    pool.intern("token" + std::to_string(i));
+  }
+  EXPECT_LE(pool.memory_size(), fst::string_pool::shard_count * fst::string_pool::minimum_page_size);
+
+  // Pages double up to page_size, with enough strings to need a second page table block.
+  std::vector<fst::string_pool::handle> handles;
+  for (int i = 0; i < 100000; i++) {
+    handles.push_back(pool.intern(std::string(100, 'a') + std::to_string(i)));
+  }
+
+  for (int i = 0; i < 100000; i += 997) {
+    EXPECT_EQ(pool.view(handles[i]), std::string(100, 'a') + std::to_string(i));
+  }
+}
+
+TEST(string_pool, lines) {
+  fst::string_pool pool;
+  std::vector<fst::string_pool::handle> handles = pool.intern_lines("a\nb\r\na\n\nc");
+  ASSERT_EQ(handles.size(), 5);
+  EXPECT_EQ(pool.view(handles[0]), "a");
+  EXPECT_EQ(pool.view(handles[1]), "b");
+  EXPECT_EQ(handles[2], handles[0]);
+  EXPECT_EQ(pool.view(handles[3]), "");
+  EXPECT_EQ(pool.view(handles[4]), "c");
+  EXPECT_EQ(pool.size(), 4);
+
+  std::string text;
+  for (int i = 0; i < 10000; i++) {
+    text += "token_" + std::to_string(i % 1000) + "\n";
+  }
+
+  handles.clear();
+  pool.intern_lines(text, handles);
+  ASSERT_EQ(handles.size(), 10000);
+  for (int i = 0; i < 10000; i++) {
+    EXPECT_EQ(handles[i], handles[i % 1000]);
+    EXPECT_EQ(pool.view(handles[i]), "token_" + std::to_string(i % 1000));
+  }
+  EXPECT_EQ(pool.size(), 1004);
+}
+
+TEST(string_pool, threads) {
+  fst::string_pool pool;
+  constexpr int thread_count = 4;
+  constexpr int count = 20000;
+  std::vector<std::vector<fst::string_pool::handle>> results(thread_count);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count; t++) {
+    threads.emplace_back([&pool, &results, t]() {
+      for (int i = 0; i < count; i++) {
+        results[t].push_back(pool.intern("key_" + std::to_string(i)));
+      }
+    });
+  }
+
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(pool.size(), count);
+  for (int t = 1; t < thread_count; t++) {
+    EXPECT_EQ(results[t], results[0]);
+  }
+
+  for (int i = 0; i < count; i++) {
+    EXPECT_EQ(pool.view(results[0][i]), "key_" + std::to_string(i));
+  }
+}
+} // namespace
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include "fst/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+TEST(thread_pool, push) {
+  std::atomic<int> count = 0;
+  {
+    fst::thread_pool pool(3);
+    EXPECT_EQ(pool.thread_count(), 3);
+
+    for (int i = 0; i < 1000; i++) {
+      pool.push([&count]() { count++; });
+    }
+  }
+
+  // The queued tasks are run before the threads are joined.
+  EXPECT_EQ(count, 1000);
+}
+
+TEST(thread_pool, nested_push) {
+  // Tasks pushed from a worker go to its own deque and get stolen by the others.
+  std::atomic<int> count = 0;
+  {
+    fst::thread_pool pool(4);
+    for (int i = 0; i < 10; i++) {
+      pool.push([&]() {
+        for (int j = 0; j < 100; j++) {
+          pool.push([&count]() { count++; });
+        }
+      });
+    }
+  }
+
+  EXPECT_EQ(count, 1000);
+}
+
+TEST(thread_pool, work_stealing_deque) {
+  fst::work_stealing_deque<int> deque(2);
+  for (int i = 0; i < 10; i++) {
+    deque.push(i);
+  }
+
+  int value;
+  EXPECT_TRUE(deque.steal(value));
+  EXPECT_EQ(value, 0);
+  EXPECT_TRUE(deque.pop(value));
+  EXPECT_EQ(value, 9);
+
+  int count = 0;
+  while (deque.pop(value)) {
+    count++;
+  }
+  EXPECT_EQ(count, 8);
+  EXPECT_TRUE(deque.empty());
+  EXPECT_FALSE(deque.steal(value));
+}
+
+TEST(thread_pool, parallel_for) {
+  fst::thread_pool pool(3);
+
+  std::vector<int> values(1000);
+  pool.parallel_for(fst::span<int>(values), 64, [](fst::span<int> s) {
+    for (int& v : s) {
+      v++;
+    }
+  });
+  EXPECT_EQ(std::count(values.begin(), values.end(), 1), 1000);
+
+  std::vector<std::atomic<int>> visited(103);
+  pool.parallel_for(fst::range<int>{ 3, 103 }, 10, [&](fst::range<int> r) {
+    EXPECT_LE(r.length(), 10);
+    for (int i = r.min; i < r.max; i++) {
+      visited[i]++;
+    }
+  });
+
+  for (int i = 0; i < 103; i++) {
+    EXPECT_EQ(visited[i], i < 3 ? 0 : 1);
+  }
+
+  // Empty range.
+  pool.parallel_for(fst::range<int>{ 5, 5 }, 10, [](fst::range<int>) { FAIL(); });
+}
+
+TEST(thread_pool, parallel_reduce) {
+  fst::thread_pool pool(3);
+
+  std::vector<std::int64_t> values(10000);
+  std::iota(values.begin(), values.end(), 0);
+
+  const std::int64_t sum = pool.parallel_reduce(
+      fst::span<const std::int64_t>(values), 100, std::int64_t(0),
+      [](fst::span<const std::int64_t> s) { return std::accumulate(s.begin(), s.end(), std::int64_t(0)); },
+      [](std::int64_t a, std::int64_t b) { return a + b; });
+  EXPECT_EQ(sum, 9999 * 10000 / 2);
+
+  // Chunks are reduced in order.
+  const std::vector<int> order = pool.parallel_reduce(
+      fst::range<int>{ 0, 50 }, 7, std::vector<int>(), [](fst::range<int> r) { return std::vector<int>{ r.min }; },
+      [](std::vector<int> a, std::vector<int> b) {
+        a.insert(a.end(), b.begin(), b.end());
+        return a;
+      });
+  EXPECT_EQ(order, std::vector<int>({ 0, 7, 14, 21, 28, 35, 42, 49 }));
+}
+
+TEST(thread_pool, parallel_for_float) {
+  fst::thread_pool pool(3);
+
+  // Fractional grains, the chunks cover the range without gaps.
+  std::vector<fst::range<float>> chunks(4);
+  std::atomic<int> count = 0;
+  pool.parallel_for(fst::range<float>{ 0.0f, 1.0f }, 0.25f, [&](fst::range<float> r) {
+    chunks[(std::size_t)(r.min * 4.0f)] = r;
+    count++;
+  });
+
+  EXPECT_EQ(count, 4);
+  for (std::size_t i = 0; i < 4; i++) {
+    EXPECT_FLOAT_EQ(chunks[i].min, (float)i * 0.25f);
+    EXPECT_FLOAT_EQ(chunks[i].max, (float)(i + 1) * 0.25f);
+  }
+
+  const double length = pool.parallel_reduce(
+      fst::range<double>{ 0.0, 1.0 }, 0.1, 0.0, [](fst::range<double> r) { return r.length(); },
+      [](double a, double b) { return a + b; });
+  EXPECT_DOUBLE_EQ(length, 1.0);
+
+  const int chunk_count = pool.parallel_reduce(
+      fst::range<float>{ 0.0f, 1.0f }, 0.3f, 0, [](fst::range<float>) { return 1; }, [](int a, int b) { return a + b; });
+  EXPECT_EQ(chunk_count, 4);
+}
+
+TEST(thread_pool, parallel_for_exception) {
+  fst::thread_pool pool(3);
+
+  // Thrown on the caller and on the workers, no chunk runs once it's rethrown.
+  std::atomic<int> running = 0;
+  EXPECT_THROW(pool.parallel_for(fst::range<int>{ 0, 64 }, 1,
+                   [&](fst::range<int> r) {
+                     running++;
+                     std::this_thread::sleep_for(std::chrono::microseconds(200));
+                     running--;
+                     if (r.min % 3 == 0) {
+                       throw std::runtime_error("chunk");
+                     }
+                   }),
+      std::runtime_error);
+  EXPECT_EQ(running, 0);
+
+  EXPECT_THROW(pool.parallel_reduce(
+                   fst::range<int>{ 0, 64 }, 4, 0,
+                   [](fst::range<int> r) -> int {
+                     if (r.min == 32) {
+                       throw std::runtime_error("map");
+                     }
+                     return r.length();
+                   },
+                   [](int a, int b) { return a + b; }),
+      std::runtime_error);
+
+  // Still usable.
+  std::atomic<int> count = 0;
+  pool.parallel_for(fst::range<int>{ 0, 100 }, 10, [&](fst::range<int> r) { count += r.length(); });
+  EXPECT_EQ(count, 100);
+}
+
+TEST(thread_pool, nested_parallel_for) {
+  fst::thread_pool pool(2);
+  std::atomic<int> count = 0;
+  pool.parallel_for(fst::range<int>{ 0, 8 }, 1, [&](fst::range<int>) {
+    pool.parallel_for(fst::range<int>{ 0, 100 }, 10, [&](fst::range<int> r) { count += r.length(); });
+  });
+  EXPECT_EQ(count, 800);
+}
+} // namespace
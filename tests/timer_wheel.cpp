@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include "fst/timer_wheel.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+using wheel_type = fst::timer_wheel<int>;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+TEST(timer_wheel, insert_cancel) {
+  const wheel_type::time_point start = wheel_type::clock::now();
+  wheel_type wheel(microseconds(100), start);
+
+  wheel_type::timer_id a = wheel.insert(start + milliseconds(1), 1);
+  wheel_type::timer_id b = wheel.insert(start + milliseconds(2), 2);
+  EXPECT_EQ(wheel.size(), 2);
+  EXPECT_TRUE(wheel.contains(a));
+  EXPECT_EQ(*wheel.find(b), 2);
+  EXPECT_EQ(wheel.next_deadline(), start + milliseconds(1));
+
+  EXPECT_TRUE(wheel.cancel(a));
+  EXPECT_FALSE(wheel.cancel(a));
+  EXPECT_FALSE(wheel.contains(a));
+  EXPECT_EQ(wheel.next_deadline(), start + milliseconds(2));
+
+  std::vector<int> fired;
+  EXPECT_EQ(wheel.advance(start + microseconds(1999), [&](wheel_type::timer_id, int& v) { fired.push_back(v); }), 0);
+  EXPECT_EQ(wheel.advance(start + milliseconds(2), [&](wheel_type::timer_id, int& v) { fired.push_back(v); }), 1);
+  EXPECT_EQ(fired, std::vector<int>({ 2 }));
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_EQ(wheel.next_deadline(), wheel_type::time_point::max());
+
+  // A reused slot doesn't validate an old id.
+  wheel_type::timer_id c = wheel.insert(start + milliseconds(3), 3);
+  EXPECT_NE(c, b);
+  EXPECT_FALSE(wheel.contains(b));
+}
+
+TEST(timer_wheel, reschedule) {
+  const wheel_type::time_point start = wheel_type::clock::now();
+  wheel_type wheel(microseconds(100), start);
+
+  int count = 0;
+  wheel_type::timer_id id = wheel.insert(start + milliseconds(1), 0);
+  for (int i = 1; i <= 10; i++) {
+    wheel.advance(start + milliseconds(i), [&](wheel_type::timer_id tid, int& v) {
+      v++;
+      count++;
+      wheel.reschedule(tid, wheel.deadline(tid) + milliseconds(1));
+    });
+  }
+
+  EXPECT_EQ(count, 10);
+  EXPECT_EQ(*wheel.find(id), 10);
+  EXPECT_EQ(wheel.deadline(id), start + milliseconds(11));
+}
+
+TEST(timer_wheel, random) {
+  const wheel_type::time_point start = wheel_type::clock::now();
+  wheel_type wheel(microseconds(100), start);
+
+  // Deadlines spread over all the levels, up to ~5 hours.
+  std::mt19937 gen(7);
+  std::vector<wheel_type::time_point> deadlines;
+  for (int i = 0; i < 2000; i++) {
+    const std::int64_t us = (std::int64_t)(gen() % 4) == 0 ? (std::int64_t)(gen() % 18000000000ull)
+                                                            : (std::int64_t)(gen() % 100000);
+    deadlines.push_back(start + microseconds(us));
+    wheel.insert(deadlines.back(), i);
+  }
+
+  std::vector<bool> fired(deadlines.size(), false);
+  std::size_t total = 0;
+  wheel_type::time_point now = start;
+  while (!wheel.empty()) {
+    const wheel_type::time_point next = wheel.next_deadline();
+    ASSERT_GT(next, now);
+    now = next;
+    total += wheel.advance(now, [&](wheel_type::timer_id, int& v) {
+      EXPECT_FALSE(fired[v]);
+      EXPECT_LE(deadlines[v], now);
+      fired[v] = true;
+    });
+
+    // Nothing expired is left behind.
+    for (std::size_t i = 0; i < deadlines.size(); i++) {
+      if (deadlines[i] <= now && !fired[i]) {
+        ADD_FAILURE() << "timer " << i << " not fired";
+        return;
+      }
+    }
+  }
+
+  EXPECT_EQ(total, deadlines.size());
+}
+} // namespace
@@ -44,4 +44,61 @@ TEST(unordered_set, constructor) {
   EXPECT_EQ(5, set.maximum_size());
   EXPECT_EQ(0, set.size());
 }
+
+TEST(unordered_set, sparse) {
+  fst::unordered_set<int> set;
+  set.resize(200);
+
+  for (int i = 0; i < 200; i += 3) {
+    set.insert(i);
+  }
+  EXPECT_EQ(set.size(), 67);
+
+  set.erase(0);
+  set.erase(99);
+  set.erase(100);
+  EXPECT_EQ(set.size(), 65);
+  EXPECT_FALSE(set.contains(0));
+  EXPECT_FALSE(set.contains(99));
+  EXPECT_TRUE(set.contains(198));
+
+  int count = 0;
+  for (int v : set) {
+    EXPECT_EQ(v % 3, 0);
+    EXPECT_TRUE(set.contains(v));
+    count++;
+  }
+  EXPECT_EQ(count, 65);
+
+  fst::unordered_set<int> other;
+  other.resize(200);
+  for (int i = 0; i < 200; i += 2) {
+    other.insert(i);
+  }
+
+  EXPECT_EQ(set.intersection_size(other), 33);
+
+  fst::unordered_set<int> inter = set;
+  inter.intersect(other);
+  EXPECT_EQ(inter.size(), 33);
+  for (int v : inter) {
+    EXPECT_EQ(v % 6, 0);
+  }
+
+  fst::unordered_set<int> diff = set;
+  diff.subtract(other);
+  EXPECT_EQ(diff.size(), 32);
+  for (int v : diff) {
+    EXPECT_NE(v % 2, 0);
+  }
+
+  diff.insert(other);
+  EXPECT_EQ(diff.size(), 132);
+
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_FALSE(set.contains(3));
+  set.insert(3);
+  EXPECT_EQ(set[0], 3);
+}
 } // namespace